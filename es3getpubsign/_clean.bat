@@ -3,4 +3,5 @@ del *.bak /S
 rmdir ".vs" /S /Q 
 rmdir "Debug" /S /Q 
 rmdir "Release" /S /Q
+rmdir "Slim" /S /Q
 
@@ -47,11 +47,14 @@
 #include "stdint.h"
 #include "adler32.h"
 #include "tnp.h"
+#include "prof.h"
+#include "keycache.h"
 #include "es3_rpc.h"
 #include "es3_sign.h"
 
 #include "mbedtls/platform.h"
 #include "mbedtls/pk.h"
+#include "mbedtls/memory_arena.h"
 #include "mbedtls/entropy.h"
 #include "mbedtls/ctr_drbg.h"
 
@@ -63,6 +66,8 @@
 
 #define GOTO_END(_a)    { rc = _a; goto end; }
 
+#define ARENA_SIZE      (16*1024)
+
 #define SLOT_NAME_SIZE  (19)
 #define FILE_NAME_SIZE  (_MAX_PATH-1)
 #define IP_NAME_SIZE    (15)
@@ -96,6 +101,11 @@ static char PubFilename[_MAX_PATH];
 
 static cert_slot_sign_t SignKey;
 
+static BYTE ArenaBuf[ARENA_SIZE];
+static mbedtls_memory_arena Arena;
+
+static int  FastStart = 0;
+
 /*=======================================================================*/
 /*  Definition of prototypes                                             */
 /*=======================================================================*/
@@ -133,11 +143,16 @@ static void OutputStartMessage (void)
 /*************************************************************************/
 static void OutputUsage (void)
 {
-  printf("Usage: es3getpub -s slot [-ip a.b.c.d] [-v] [-d]\n");
+  printf("Usage: es3getpub -s slot [-ip a.b.c.d] [-fast] [-cache] [-T] [-v] [-d]\n");
   printf("\n");
   printf("  -s   Slot name e.g. -s firefly\n");
   printf("  -ip  Select IP-Address of the signing server,\n");
   printf("       e.g. -ip 192.168.1.200\n");
+  printf("  -fast Fast start, sign the request with deterministic\n");
+  printf("       ECDSA (RFC 6979) without gathering entropy\n");
+  printf("  -cache Keep an unencrypted binary copy of the private key\n");
+  printf("       next to the key file to skip the PEM parsing\n");
+  printf("  -T   Show the time taken by each startup phase\n");
   printf("  -v   Show version information only\n");
   printf("  -d   Discover, search server only\n");
   
@@ -462,6 +477,8 @@ static int GetPub (char *pSlot, DWORD dAddress)
    mbedtls_pk_context       pk;
    mbedtls_entropy_context  entropy;
    mbedtls_ctr_drbg_context ctr_drbg;
+   int                    (*f_rng)(void *, unsigned char *, size_t);
+   void                    *p_rng;
    size_t                   len;
    size_t                   SigLen;
    uint8_t                  Hash[32];
@@ -474,6 +491,7 @@ static int GetPub (char *pSlot, DWORD dAddress)
    mbedtls_pk_init(&pk);
    mbedtls_ctr_drbg_init(&ctr_drbg);
    mbedtls_entropy_init(&entropy);
+   mbedtls_memory_arena_init(&Arena, ArenaBuf, sizeof(ArenaBuf));
    
    
    /*
@@ -499,21 +517,39 @@ static int GetPub (char *pSlot, DWORD dAddress)
    len = ES3_CALL_GET_PUB_SIZE;
    rc = mbedtls_sha256_ret((uint8_t*)&TxMsg.Data, len, Hash, 0);
    if (rc != 0) GOTO_END(-4); 
+   prof_Mark("Request setup");
 
-   /* Seed the random generator */
-   rc =  mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
-                               (const unsigned char *) "TinyES3sign", 11);
-   if (rc != 0) GOTO_END(-5); 
-
-   /* Read private key */   
-   rc = mbedtls_pk_parse_keyfile(&pk, PrivFilename, NULL);
+   /* Read private key, from the key cache if enabled and up to date */   
+   rc = keycache_Load(&pk, PrivFilename);
    if (rc != 0) GOTO_END(-6);
+   prof_Mark("Key parsing");
    
-   /* Create signature */   
+   if ((1 == FastStart) && mbedtls_pk_can_do(&pk, MBEDTLS_PK_ECDSA))
+   {
+      /* Deterministic ECDSA, no random generator needed */
+      f_rng = NULL;
+      p_rng = NULL;
+   }
+   else
+   {
+      /* Seed the random generator */
+      rc =  mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
+                                  (const unsigned char *) "TinyES3sign", 11);
+      if (rc != 0) GOTO_END(-5); 
+      prof_Mark("Entropy, DRBG seed");
+      
+      f_rng = mbedtls_ctr_drbg_random;
+      p_rng = &ctr_drbg;
+   }
+   
+   /* Create signature, temporary values are taken from the arena */   
    SigLen = ES3_RPC_SIG_SIZE;
+   mbedtls_memory_arena_begin(&Arena);
    rc = mbedtls_pk_sign(&pk, MBEDTLS_MD_SHA256, Hash, 0, TxMsg.Header.Sig, &SigLen,
-                        mbedtls_ctr_drbg_random, &ctr_drbg);
+                        f_rng, p_rng);
+   mbedtls_memory_arena_end(&Arena);
    if (rc != 0) GOTO_END(-7);
+   prof_Mark("Signing");
    
    /* Check signature size */
    if (SigLen > ES3_RPC_SIG_SIZE) GOTO_END(-8);
@@ -521,6 +557,7 @@ static int GetPub (char *pSlot, DWORD dAddress)
    TxMsg.Header.SigLen = (uint8_t)SigLen;
 
    rc = HandleGetPubReq(&TxMsg, &RxMsg, dAddress); 
+   prof_Mark("Network round trip");
    if (0 == rc)
    {
       rc = RxMsg.Header.Result;
@@ -559,6 +596,7 @@ end:
    mbedtls_pk_free(&pk);
    mbedtls_ctr_drbg_free(&ctr_drbg);
    mbedtls_entropy_free(&entropy);
+   mbedtls_memory_arena_free(&Arena);
 
    return(rc);   
 } /* GetPub */
@@ -576,6 +614,8 @@ static int CreateSignature (char *pSlot, DWORD dAddress, uint8_t *pData, size_t
    mbedtls_pk_context       pk;
    mbedtls_entropy_context  entropy;
    mbedtls_ctr_drbg_context ctr_drbg;
+   int                    (*f_rng)(void *, unsigned char *, size_t);
+   void                    *p_rng;
    size_t                   len;
    size_t                   SigLen;
    uint8_t                  Hash[32];
@@ -589,6 +629,7 @@ static int CreateSignature (char *pSlot, DWORD dAddress, uint8_t *pData, size_t
    mbedtls_pk_init(&pk);
    mbedtls_ctr_drbg_init(&ctr_drbg);
    mbedtls_entropy_init(&entropy);
+   mbedtls_memory_arena_init(&Arena, ArenaBuf, sizeof(ArenaBuf));
    
    /*
     * Create sign request
@@ -615,21 +656,39 @@ static int CreateSignature (char *pSlot, DWORD dAddress, uint8_t *pData, size_t
    len = ES3_CALL_SIGN_SIZE;
    rc = mbedtls_sha256_ret((uint8_t*)&TxMsg.Data, len, Hash, 0);
    if (rc != 0) GOTO_END(-4); 
+   prof_Mark("Request setup");
 
-   /* Seed the random generator */
-   rc =  mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
-                               (const unsigned char *) "TinyES3sign", 11);
-   if (rc != 0) GOTO_END(-5); 
-
-   /* Read private key */   
-   rc = mbedtls_pk_parse_keyfile(&pk, PrivFilename, NULL);
+   /* Read private key, from the key cache if enabled and up to date */   
+   rc = keycache_Load(&pk, PrivFilename);
    if (rc != 0) GOTO_END(-6);
+   prof_Mark("Key parsing");
+   
+   if ((1 == FastStart) && mbedtls_pk_can_do(&pk, MBEDTLS_PK_ECDSA))
+   {
+      /* Deterministic ECDSA, no random generator needed */
+      f_rng = NULL;
+      p_rng = NULL;
+   }
+   else
+   {
+      /* Seed the random generator */
+      rc =  mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
+                                  (const unsigned char *) "TinyES3sign", 11);
+      if (rc != 0) GOTO_END(-5); 
+      prof_Mark("Entropy, DRBG seed");
+      
+      f_rng = mbedtls_ctr_drbg_random;
+      p_rng = &ctr_drbg;
+   }
    
-   /* Create signature */   
+   /* Create signature, temporary values are taken from the arena */   
    SigLen = ES3_RPC_SIG_SIZE;
+   mbedtls_memory_arena_begin(&Arena);
    rc = mbedtls_pk_sign(&pk, MBEDTLS_MD_SHA256, Hash, 0, TxMsg.Header.Sig, &SigLen,
-                        mbedtls_ctr_drbg_random, &ctr_drbg);
+                        f_rng, p_rng);
+   mbedtls_memory_arena_end(&Arena);
    if (rc != 0) GOTO_END(-7);
+   prof_Mark("Signing");
    
    /* Check signature size */
    if (SigLen > ES3_RPC_SIG_SIZE) GOTO_END(-8);
@@ -637,6 +696,7 @@ static int CreateSignature (char *pSlot, DWORD dAddress, uint8_t *pData, size_t
    TxMsg.Header.SigLen = (uint8_t)SigLen;
 
    rc = HandleSignReq(&TxMsg, &RxMsg, dAddress); 
+   prof_Mark("Network round trip");
    if (0 == rc)
    {
       rc = RxMsg.Header.Result;
@@ -687,6 +747,7 @@ end:
    mbedtls_pk_free(&pk);
    mbedtls_ctr_drbg_free(&ctr_drbg);
    mbedtls_entropy_free(&entropy);
+   mbedtls_memory_arena_free(&Arena);
 
    return(rc);   
 } /* CreateSignature */
@@ -772,6 +833,21 @@ int main (int argc, char **argv)
          {
             CmdDiscover = 1;
          }
+         /* Check for fast start */
+         else if (0 == strcmp(argv[Index], "-fast"))
+         {
+            FastStart = 1;
+         }
+         /* Check for the key cache */
+         else if (0 == strcmp(argv[Index], "-cache"))
+         {
+            keycache_Enable();
+         }
+         /* Check for phase timing */
+         else if (0 == strcmp(argv[Index], "-T"))
+         {
+            prof_Enable();
+         }
          else
          {
             /* Ups, unknown command */
@@ -835,6 +911,7 @@ int main (int argc, char **argv)
       printf("Error, could not retrieve environment variables.\n");
       GOTO_END(-3);
    }
+   prof_Mark("Environment");
    
    /* 
     * Check if a server should be selected automatically 
@@ -904,6 +981,8 @@ int main (int argc, char **argv)
 end:
    
    tnp_Stop();   
+   
+   prof_Output();
 
    return(rc);
 } /* main */
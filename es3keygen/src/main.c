@@ -249,16 +249,14 @@ static int Fingerprint (uint8_t *pKey)
 
    mbedtls_pk_init(&ctx);
 
-   /* Dummy decode to get size of decode buffer */
-   rc = mbedtls_base64_decode(NULL, 0, &len, pStart, strlen(pStart));   
-   if (rc == MBEDTLS_ERR_BASE64_INVALID_CHARACTER) GOTO_END(-1);
-
-   /* Allocate decode buffer */   
+   /* Allocate decode buffer, large enough to decode in one pass */   
+   len = mbedtls_base64_decode_bound(strlen(pStart));
    buf = mbedtls_calloc(1, len);
    if (NULL == buf) GOTO_END(-2);
 
    /* Decode now */
    rc = mbedtls_base64_decode(buf, len, &len, pStart, strlen(pStart));
+   if (rc == MBEDTLS_ERR_BASE64_INVALID_CHARACTER) GOTO_END(-1);
    if (rc != 0) GOTO_END(-3);
    
    /* 
@@ -46,10 +46,13 @@
 #include <stdio.h>
 #include "stdint.h"
 #include "tnp.h"
+#include "prof.h"
+#include "keycache.h"
 #include "es3_rpc.h"
 
 #include "mbedtls/platform.h"
 #include "mbedtls/pk.h"
+#include "mbedtls/memory_arena.h"
 #include "mbedtls/entropy.h"
 #include "mbedtls/ctr_drbg.h"
 
@@ -61,6 +64,8 @@
 
 #define GOTO_END(_a)    { rc = _a; goto end; }
 
+#define ARENA_SIZE      (16*1024)
+
 #define SLOT_NAME_SIZE  (19)
 #define FILE_NAME_SIZE  (_MAX_PATH-1)
 #define IP_NAME_SIZE    (15)
@@ -78,6 +83,11 @@ static char ES3Folder[_MAX_PATH];
 static char PrivFilename[_MAX_PATH];
 static char PubFilename[_MAX_PATH];
 
+static BYTE ArenaBuf[ARENA_SIZE];
+static mbedtls_memory_arena Arena;
+
+static int  FastStart = 0;
+
 /*=======================================================================*/
 /*  Definition of prototypes                                             */
 /*=======================================================================*/
@@ -115,10 +125,15 @@ static void OutputStartMessage (void)
 /*************************************************************************/
 static void OutputUsage (void)
 {
-  printf("Usage: es3slotlist [-ip a.b.c.d] [-v] [-d]\n");
+  printf("Usage: es3slotlist [-ip a.b.c.d] [-fast] [-cache] [-T] [-v] [-d]\n");
   printf("\n");
   printf("  -ip  Select IP-Address of the signing server,\n");
   printf("       e.g. -ip 192.168.1.200\n");
+  printf("  -fast Fast start, sign the request with deterministic\n");
+  printf("       ECDSA (RFC 6979) without gathering entropy\n");
+  printf("  -cache Keep an unencrypted binary copy of the private key\n");
+  printf("       next to the key file to skip the PEM parsing\n");
+  printf("  -T   Show the time taken by each startup phase\n");
   printf("  -v   Show version information only\n");
   printf("  -d   Discover, search server only\n");
   
@@ -318,6 +333,8 @@ static int SlotList (DWORD dAddress)
    mbedtls_pk_context       pk;
    mbedtls_entropy_context  entropy;
    mbedtls_ctr_drbg_context ctr_drbg;
+   int                    (*f_rng)(void *, unsigned char *, size_t);
+   void                    *p_rng;
    size_t                   len;
    size_t                   SigLen;
    uint8_t                  Hash[32];
@@ -330,6 +347,7 @@ static int SlotList (DWORD dAddress)
    mbedtls_pk_init(&pk);
    mbedtls_ctr_drbg_init(&ctr_drbg);
    mbedtls_entropy_init(&entropy);
+   mbedtls_memory_arena_init(&Arena, ArenaBuf, sizeof(ArenaBuf));
    
 //   psa_crypto_init();
       
@@ -356,22 +374,40 @@ static int SlotList (DWORD dAddress)
    len = ES3_CALL_GET_LIST_SIZE;
    rc = mbedtls_sha256_ret((uint8_t*)&TxMsg.Data, len, Hash, 0);
    if (rc != 0) GOTO_END(-4); 
+   prof_Mark("Request setup");
 
-   /* Seed the random generator */
-   rc =  mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
-                               (const unsigned char *) "TinyES3sign", 11);
-   if (rc != 0) GOTO_END(-5); 
-
-   /* Read private key */   
-   rc = mbedtls_pk_parse_keyfile(&pk, PrivFilename, NULL);
+   /* Read private key, from the key cache if enabled and up to date */   
+   rc = keycache_Load(&pk, PrivFilename);
    if (rc != 0) GOTO_END(-6);
+   prof_Mark("Key parsing");
+   
+   if ((1 == FastStart) && mbedtls_pk_can_do(&pk, MBEDTLS_PK_ECDSA))
+   {
+      /* Deterministic ECDSA, no random generator needed */
+      f_rng = NULL;
+      p_rng = NULL;
+   }
+   else
+   {
+      /* Seed the random generator */
+      rc =  mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
+                                  (const unsigned char *) "TinyES3sign", 11);
+      if (rc != 0) GOTO_END(-5); 
+      prof_Mark("Entropy, DRBG seed");
+      
+      f_rng = mbedtls_ctr_drbg_random;
+      p_rng = &ctr_drbg;
+   }
    
-   /* Create signature */   
+   /* Create signature, temporary values are taken from the arena */   
    SigLen = ES3_RPC_SIG_SIZE;
+   mbedtls_memory_arena_begin(&Arena);
    rc = mbedtls_pk_sign(&pk, MBEDTLS_MD_SHA256, Hash, 0, 
                         TxMsg.Header.Sig, &SigLen,
-                        mbedtls_ctr_drbg_random, &ctr_drbg);
+                        f_rng, p_rng);
+   mbedtls_memory_arena_end(&Arena);
    if (rc != 0) GOTO_END(-7);
+   prof_Mark("Signing");
    
    /* Check signature size */
    if (SigLen > ES3_RPC_SIG_SIZE) GOTO_END(-8);
@@ -379,6 +415,7 @@ static int SlotList (DWORD dAddress)
    TxMsg.Header.SigLen = (uint8_t)SigLen;
 
    rc = HandleGetListReq(&TxMsg, &RxMsg, dAddress); 
+   prof_Mark("Network round trip");
    if (0 == rc)
    {
       rc = RxMsg.Header.Result;
@@ -416,6 +453,7 @@ end:
    mbedtls_pk_free(&pk);
    mbedtls_ctr_drbg_free(&ctr_drbg);
    mbedtls_entropy_free(&entropy);
+   mbedtls_memory_arena_free(&Arena);
 
    return(rc);   
 } /* GetPub */
@@ -477,6 +515,21 @@ int main (int argc, char **argv)
          {
             CmdDiscover = 1;
          }
+         /* Check for fast start */
+         else if (0 == strcmp(argv[Index], "-fast"))
+         {
+            FastStart = 1;
+         }
+         /* Check for the key cache */
+         else if (0 == strcmp(argv[Index], "-cache"))
+         {
+            keycache_Enable();
+         }
+         /* Check for phase timing */
+         else if (0 == strcmp(argv[Index], "-T"))
+         {
+            prof_Enable();
+         }
          else
          {
             /* Ups, unknown command */
@@ -527,6 +580,7 @@ int main (int argc, char **argv)
       printf("Error, could not retrieve environment variables.\n");
       GOTO_END(-3);
    }
+   prof_Mark("Environment");
    
    /* 
     * Check if a server should be selected automatically 
@@ -591,6 +645,8 @@ int main (int argc, char **argv)
 end:
    
    tnp_Stop();   
+   
+   prof_Output();
 
    return(rc);
 } /* main */
@@ -51,6 +51,7 @@
 
 #include "mbedtls/platform.h"
 #include "mbedtls/pk.h"
+#include "mbedtls/memory_arena.h"
 #include "mbedtls/sha256.h"
 
 /*=======================================================================*/
@@ -61,6 +62,8 @@
 
 #define GOTO_END(_a)    { rc = _a; goto end; }
 
+#define ARENA_SIZE      (16*1024)
+
 #define MAX_IMAGE_SIZE  (4*1024*1024)
 
 #define FILE_NAME_SIZE  (_MAX_PATH-1)
@@ -74,6 +77,9 @@ static char FileName[FILE_NAME_SIZE+1];
 
 static BYTE InImage[MAX_IMAGE_SIZE];
 
+static BYTE ArenaBuf[ARENA_SIZE];
+static mbedtls_memory_arena Arena;
+
 /*=======================================================================*/
 /*  Definition of prototypes                                             */
 /*=======================================================================*/
@@ -139,6 +145,7 @@ static int VerifySignature (void)
     * Prepare key generation
     */
    mbedtls_pk_init(&pk);
+   mbedtls_memory_arena_init(&Arena, ArenaBuf, sizeof(ArenaBuf));
 
    /* Read public key */   
    rc = mbedtls_pk_parse_public_keyfile(&pk, KeyName);
@@ -193,8 +200,10 @@ static int VerifySignature (void)
          pData = &InImage[sizeof(ES3_SIGN_HEAD)];
          mbedtls_sha256_ret(pData, pHeader->dDataSize, Hash, 0);
          
-         /* Check signature */
+         /* Check signature, temporary values are taken from the arena */
+         mbedtls_memory_arena_begin(&Arena);
          rc = mbedtls_pk_verify(&pk, MBEDTLS_MD_SHA256, Hash, 0, pHeader->Signature, pHeader->bSigLen);
+         mbedtls_memory_arena_end(&Arena);
          if (0 == rc)
          {
             printf("The signature of the input file is valid.\n");
@@ -220,6 +229,7 @@ static int VerifySignature (void)
 end:
 
    mbedtls_pk_free(&pk);
+   mbedtls_memory_arena_free(&Arena);
 
    return(rc);
 } /* VerifySignature */
@@ -0,0 +1,90 @@
+/**************************************************************************
+*  Copyright (c) 2021-2024 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without 
+*  modification, are permitted provided that the following conditions 
+*  are met:
+*  
+*  1. Redistributions of source code must retain the above copyright 
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the 
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may 
+*     be used to endorse or promote products derived from this software 
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL 
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS 
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF 
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+*  SUCH DAMAGE.
+*
+**************************************************************************/
+#if !defined(__KEYCACHE_H__)
+#define __KEYCACHE_H__
+
+/**************************************************************************
+*  Includes
+**************************************************************************/
+#include "stdint.h"
+#include "mbedtls/pk.h"
+
+/**************************************************************************
+*  Global Definitions
+**************************************************************************/
+
+#define KEYCACHE_MAGIC        0x4B335345  /* "ES3K" */
+#define KEYCACHE_VERSION      2
+
+#define KEYCACHE_EXT          ".cache"
+
+#define KEYCACHE_PRIV_SIZE    32          /* P-256 private value d      */
+#define KEYCACHE_PUB_SIZE     65          /* Uncompressed point Q       */
+#define KEYCACHE_HASH_SIZE    32          /* SHA-256                    */
+
+/*
+ * Cache file layout. bSrcHash is the SHA-256 of the key file the cache
+ * was made from. bHash is taken over all fields before it, to
+ * detect a damaged file. It is not keyed, so it does not detect a
+ * modified file: the cache holds the private key in plain, and must be
+ * protected like the key file itself.
+ */
+#pragma pack(1)
+typedef struct _key_cache_
+{
+  uint32_t dMagic;
+  uint16_t wVersion;
+  uint16_t wGroup;
+  uint8_t  bSrcHash[KEYCACHE_HASH_SIZE];
+  uint8_t  bPriv[KEYCACHE_PRIV_SIZE];
+  uint8_t  bPub[KEYCACHE_PUB_SIZE];
+  uint8_t  bReserve[7];
+  uint8_t  bHash[KEYCACHE_HASH_SIZE];
+} KEY_CACHE;
+#pragma pack()
+
+/**************************************************************************
+*  Macro Definitions
+**************************************************************************/
+
+/**************************************************************************
+*  Funtions Definitions
+**************************************************************************/
+
+void keycache_Enable (void);
+int  keycache_Load (mbedtls_pk_context *pPK, const char *pKeyFilename);
+
+#endif /* !__KEYCACHE_H__ */
+
+/*** EOF ***/
@@ -200,7 +200,7 @@
  *
  * Enable this layer to allow use of alternative memory allocators.
  */
-//#define MBEDTLS_PLATFORM_MEMORY
+#define MBEDTLS_PLATFORM_MEMORY
 
 /**
  * \def MBEDTLS_PLATFORM_NO_STD_FUNCTIONS
@@ -962,7 +962,7 @@
  *
  * Uncomment this macro to enable restartable ECC computations.
  */
-//#define MBEDTLS_ECP_RESTARTABLE
+#define MBEDTLS_ECP_RESTARTABLE
 
 /**
  * \def MBEDTLS_ECDH_LEGACY_CONTEXT
@@ -2248,8 +2248,12 @@
  * Requires: MBEDTLS_THREADING_C
  *
  * Uncomment this to enable pthread mutexes.
+ *
+ * The tools use it wherever pthreads are available, i.e. not with MSVC.
  */
-//#define MBEDTLS_THREADING_PTHREAD
+#if !defined(_WIN32)
+#define MBEDTLS_THREADING_PTHREAD
+#endif
 
 /**
  * \def MBEDTLS_USE_PSA_CRYPTO
@@ -2833,6 +2837,22 @@
  */
 #define MBEDTLS_CTR_DRBG_C
 
+/**
+ * \def MBEDTLS_CTR_DRBG_POOL_C
+ *
+ * Enable per-thread CTR_DRBG contexts fed from one shared entropy source.
+ * Every thread draws from its own mbedtls_ctr_drbg_thread context, so
+ * threads never contend for a DRBG; a reseed of all of them is scheduled
+ * with mbedtls_ctr_drbg_pool_schedule_reseed() without taking any lock.
+ *
+ * Module:  library/ctr_drbg_pool.c
+ *
+ * Requires: MBEDTLS_CTR_DRBG_C
+ *
+ * This module provides per-thread CTR_DRBG random number generators.
+ */
+#define MBEDTLS_CTR_DRBG_POOL_C
+
 /**
  * \def MBEDTLS_DEBUG_C
  *
@@ -2930,6 +2950,22 @@
  */
 #define MBEDTLS_ECDSA_C
 
+/**
+ * \def MBEDTLS_ECDSA_SCHED_C
+ *
+ * Enable the cooperative ECDSA scheduler. It runs queued signatures and
+ * verifications round-robin in slices of a bounded number of ECC
+ * operations, so that one event loop can interleave many of them with
+ * other work.
+ *
+ * Module:  library/ecdsa_sched.c
+ *
+ * Requires: MBEDTLS_ECDSA_C, MBEDTLS_ECP_RESTARTABLE
+ *
+ * This module provides scheduling of restartable ECDSA operations.
+ */
+#define MBEDTLS_ECDSA_SCHED_C
+
 /**
  * \def MBEDTLS_ECJPAKE_C
  *
@@ -3152,6 +3188,28 @@
  */
 //#define MBEDTLS_MEMORY_BUFFER_ALLOC_C
 
+/**
+ * \def MBEDTLS_MEMORY_ARENA_C
+ *
+ * Enable the per-thread arena allocator. Between
+ * mbedtls_memory_arena_begin() and mbedtls_memory_arena_end() the
+ * allocations of a thread are carved out of a caller provided buffer
+ * instead of going through calloc() and free(). Outside of these calls the
+ * allocator passes everything on to MBEDTLS_PLATFORM_STD_CALLOC and
+ * MBEDTLS_PLATFORM_STD_FREE.
+ *
+ * Module:  library/memory_arena.c
+ *
+ * Requires: MBEDTLS_PLATFORM_C
+ *           MBEDTLS_PLATFORM_MEMORY (without MBEDTLS_PLATFORM_CALLOC_MACRO)
+ *
+ * Cannot be used with MBEDTLS_MEMORY_BUFFER_ALLOC_C: both install their own
+ * calloc() and free() through mbedtls_platform_set_calloc_free().
+ *
+ * Enable this module to enable the arena allocator.
+ */
+#define MBEDTLS_MEMORY_ARENA_C
+
 /**
  * \def MBEDTLS_NET_C
  *
@@ -3402,8 +3460,8 @@
  * Module:  library/psa_crypto_storage.c
  *
  * Requires: MBEDTLS_PSA_CRYPTO_C,
- *           either MBEDTLS_PSA_ITS_FILE_C or a native implementation of
- *           the PSA ITS interface
+ *           either MBEDTLS_PSA_ITS_FILE_C, MBEDTLS_PSA_ITS_LOG_C or a
+ *           native implementation of the PSA ITS interface
  */
 //#define MBEDTLS_PSA_CRYPTO_STORAGE_C
 
@@ -3419,6 +3477,29 @@
  */
 //#define MBEDTLS_PSA_ITS_FILE_C
 
+/**
+ * \def MBEDTLS_PSA_ITS_LOG_C
+ *
+ * Enable the emulation of the Platform Security Architecture
+ * Internal Trusted Storage (PSA ITS) over a single append-only log file.
+ *
+ * Each write appends a record to the log, and an index in memory gives
+ * the position of the data of each uid, so the cost of an access doesn't
+ * grow with the number of stored keys as with one file per uid. The log
+ * is compacted when most of it holds overwritten or removed data.
+ *
+ * The log is named PSA_ITS_STORAGE_PREFIX "psa_its.log". It does not
+ * share its format with MBEDTLS_PSA_ITS_FILE_C, so switching between the
+ * two loses the stored keys.
+ *
+ * Module:  library/psa_its_log.c
+ *
+ * Requires: MBEDTLS_FS_IO
+ *
+ * This module cannot be enabled together with MBEDTLS_PSA_ITS_FILE_C.
+ */
+//#define MBEDTLS_PSA_ITS_LOG_C
+
 /**
  * \def MBEDTLS_RIPEMD160_C
  *
@@ -3602,7 +3683,9 @@
  *
  * Enable this layer to allow use of mutexes within Mbed TLS
  */
-//#define MBEDTLS_THREADING_C
+#if !defined(_WIN32)
+#define MBEDTLS_THREADING_C
+#endif
 
 /**
  * \def MBEDTLS_TIMING_C
@@ -3689,6 +3772,22 @@
  */
 #define MBEDTLS_X509_CRL_PARSE_C
 
+/**
+ * \def MBEDTLS_X509_TRUST_STORE_C
+ *
+ * Enable precompiled trust stores: CA certificates serialized with a hash
+ * index on their subject, loaded by mapping the file into memory and parsed
+ * only when they are looked up by mbedtls_x509_trust_store_ca_cb().
+ *
+ * Module:  library/x509_trust_store.c
+ *
+ * Requires: MBEDTLS_X509_CRT_PARSE_C
+ *
+ * This module is used with MBEDTLS_X509_TRUSTED_CERTIFICATE_CALLBACK to
+ * verify certificates against large CA bundles.
+ */
+//#define MBEDTLS_X509_TRUST_STORE_C
+
 /**
  * \def MBEDTLS_X509_CSR_PARSE_C
  *
@@ -4014,6 +4113,10 @@
  * volatile key, or a persistent key which is loaded temporarily by the
  * library as part of a crypto operation in flight.
  *
+ * Key slots are allocated on demand, 16 at a time, so a large value only
+ * costs memory once that many keys are loaded. Keys are found by their
+ * identifier through a hash index, whatever the number of slots.
+ *
  * If this option is unset, the library will fall back to a default value of
  * 32 keys.
  */
@@ -4022,6 +4125,7 @@
 /* SSL Cache options */
 //#define MBEDTLS_SSL_CACHE_DEFAULT_TIMEOUT       86400 /**< 1 day  */
 //#define MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES      50 /**< Maximum entries in cache */
+//#define MBEDTLS_SSL_CACHE_SHARDS                    8 /**< Independently locked parts of the cache (default 1 without MBEDTLS_THREADING_C) */
 
 /* SSL options */
 
@@ -0,0 +1,75 @@
+/**
+ * \file mbedtls_conf_slim.h
+ *
+ * \brief Minimal configuration for the ES3 tools
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+/*
+ * Minimal configuration for the ES3 tools
+ *
+ * The tools only parse and write P-256 keys in PEM, hash with SHA-256 and
+ * MD5, decode base64, and sign and verify with ECDSA from a CTR_DRBG. This
+ * configuration enables exactly that, instead of the TLS, X.509, RSA,
+ * PKCS#12, CCM and P-384/P-521 support of mbedtls_conf.h.
+ *
+ * Distinguishing features:
+ * - P-256 only, no RSA
+ * - no TLS, no X.509
+ * - deterministic ECDSA kept, so signatures do not change with the config
+ *
+ * To use it, define MBEDTLS_CONFIG_FILE="mbedtls_conf_slim.h" with the inc
+ * directory in the include path. See configs/README.txt of Mbed TLS.
+ */
+
+#ifndef MBEDTLS_CONFIG_H
+#define MBEDTLS_CONFIG_H
+
+#if defined(_MSC_VER) && !defined(_CRT_SECURE_NO_DEPRECATE)
+#define _CRT_SECURE_NO_DEPRECATE 1
+#endif
+
+/* System support */
+#define MBEDTLS_HAVE_ASM
+#define MBEDTLS_PLATFORM_MEMORY
+
+/* Mbed TLS feature support */
+#define MBEDTLS_ECP_DP_SECP256R1_ENABLED
+#define MBEDTLS_ECP_NIST_OPTIM
+#define MBEDTLS_ECDSA_DETERMINISTIC
+#define MBEDTLS_FS_IO
+
+/* Mbed TLS modules */
+#define MBEDTLS_AESNI_C
+#define MBEDTLS_AES_C
+#define MBEDTLS_ASN1_PARSE_C
+#define MBEDTLS_ASN1_WRITE_C
+#define MBEDTLS_BASE64_C
+#define MBEDTLS_BIGNUM_C
+#define MBEDTLS_CTR_DRBG_C
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_ECP_C
+#define MBEDTLS_ENTROPY_C
+#define MBEDTLS_HMAC_DRBG_C
+#define MBEDTLS_MD_C
+#define MBEDTLS_MD5_C
+#define MBEDTLS_MEMORY_ARENA_C
+#define MBEDTLS_OID_C
+#define MBEDTLS_PEM_PARSE_C
+#define MBEDTLS_PEM_WRITE_C
+#define MBEDTLS_PK_C
+#define MBEDTLS_PK_PARSE_C
+#define MBEDTLS_PK_WRITE_C
+#define MBEDTLS_PLATFORM_C
+#define MBEDTLS_SHA256_C
+
+/* Target and application specific configurations */
+#if defined(MBEDTLS_USER_CONFIG_FILE)
+#include MBEDTLS_USER_CONFIG_FILE
+#endif
+
+#include "mbedtls/check_config.h"
+
+#endif /* MBEDTLS_CONFIG_H */
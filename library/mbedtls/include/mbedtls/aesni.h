@@ -111,6 +111,28 @@ int mbedtls_aesni_crypt_ecb(mbedtls_aes_context *ctx,
                             const unsigned char input[16],
                             unsigned char output[16]);
 
+/**
+ * \brief          Internal AES-NI AES-ECB en(de)cryption of 8 blocks
+ *
+ *                 The rounds of the 8 blocks are interleaved, which keeps
+ *                 the AES unit busy on CPUs that can start an AESENC or
+ *                 AESDEC every cycle or half cycle. This is used for bulk
+ *                 CTR encryption and CBC decryption, and to generate
+ *                 several CTR blocks at once in CTR_DRBG and GCM.
+ *
+ * \note           This function is only for internal use by other library
+ *                 functions; you must not call it directly.
+ *
+ * \param ctx      AES context
+ * \param mode     MBEDTLS_AES_ENCRYPT or MBEDTLS_AES_DECRYPT
+ * \param input    8 consecutive 16-byte input blocks
+ * \param output   8 consecutive 16-byte output blocks
+ */
+void mbedtls_aesni_crypt_ecb8(mbedtls_aes_context *ctx,
+                              int mode,
+                              const unsigned char input[128],
+                              unsigned char output[128]);
+
 /**
  * \brief          Internal GCM multiplication: c = a * b in GF(2^128)
  *
@@ -128,6 +150,38 @@ void mbedtls_aesni_gcm_mult(unsigned char c[16],
                             const unsigned char a[16],
                             const unsigned char b[16]);
 
+/**
+ * \brief          Internal AES-GCM en(de)cryption of groups of 4 blocks
+ *
+ *                 Each group encrypts the next 4 counter blocks and hashes
+ *                 4 blocks of ciphertext, with the AES rounds and the
+ *                 carry-less multiplications interleaved. The 4 blocks are
+ *                 multiplied by H^4, H^3, H^2 and H respectively, and the
+ *                 sum of the products is reduced once per group.
+ *
+ * \note           This function is only for internal use by other library
+ *                 functions; you must not call it directly.
+ *
+ * \param ctx      AES context, set up for encryption
+ * \param htable   H^4, H^3, H^2 and H, each with its 16 bytes reversed
+ * \param y        The counter block, advanced by 4 per group
+ * \param x        The GHASH value, updated with the hashed blocks
+ * \param groups   Number of groups of 4 blocks (may be 0)
+ * \param input    Input data, 64 bytes per group
+ * \param output   Output data, 64 bytes per group
+ * \param hashed   Ciphertext to hash, 64 bytes per group: \p input when
+ *                 decrypting. When encrypting, this can be the output of
+ *                 the previous group, which is ready by then.
+ */
+void mbedtls_aesni_gcm_crypt4(mbedtls_aes_context *ctx,
+                              const unsigned char htable[64],
+                              unsigned char y[16],
+                              unsigned char x[16],
+                              size_t groups,
+                              const unsigned char *input,
+                              unsigned char *output,
+                              const unsigned char *hashed);
+
 /**
  * \brief           Internal round key inversion. This function computes
  *                  decryption round keys from the encryption round keys.
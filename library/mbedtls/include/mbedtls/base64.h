@@ -65,10 +65,31 @@ int mbedtls_base64_encode(unsigned char *dst, size_t dlen, size_t *olen,
  *
  * \note           Call this function with *dst = NULL or dlen = 0 to obtain
  *                 the required buffer size in *olen
+ *
+ * \note           If \p dlen is at least mbedtls_base64_decode_bound(\p slen),
+ *                 the input is checked and decoded in a single pass. On
+ *                 MBEDTLS_ERR_BASE64_INVALID_CHARACTER the part of \p dst
+ *                 written so far is zeroized again.
  */
 int mbedtls_base64_decode(unsigned char *dst, size_t dlen, size_t *olen,
                           const unsigned char *src, size_t slen);
 
+/**
+ * \brief          Upper bound of the decoded size of a base64-formatted
+ *                 buffer
+ *
+ *                 Unlike a call to mbedtls_base64_decode() with \p dst =
+ *                 NULL, this does not read the buffer: the bound only
+ *                 depends on its length. A destination buffer of this size
+ *                 lets mbedtls_base64_decode() work in a single pass.
+ *
+ * \param slen     amount of data to be decoded
+ *
+ * \return         the largest number of bytes that decoding \p slen
+ *                 bytes can produce
+ */
+size_t mbedtls_base64_decode_bound(size_t slen);
+
 #if defined(MBEDTLS_SELF_TEST)
 /**
  * \brief          Checkup routine
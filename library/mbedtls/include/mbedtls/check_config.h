@@ -61,6 +61,10 @@
 #error "MBEDTLS_CTR_DRBG_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_CTR_DRBG_POOL_C) && !defined(MBEDTLS_CTR_DRBG_C)
+#error "MBEDTLS_CTR_DRBG_POOL_C defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_DHM_C) && !defined(MBEDTLS_BIGNUM_C)
 #error "MBEDTLS_DHM_C defined, but not all prerequisites"
 #endif
@@ -101,6 +105,11 @@
 #error "MBEDTLS_ECDSA_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_ECDSA_SCHED_C) &&                                     \
+    ( !defined(MBEDTLS_ECDSA_C) || !defined(MBEDTLS_ECP_RESTARTABLE) )
+#error "MBEDTLS_ECDSA_SCHED_C defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_ECJPAKE_C) &&           \
     ( !defined(MBEDTLS_ECP_C) || !defined(MBEDTLS_MD_C) )
 #error "MBEDTLS_ECJPAKE_C defined, but not all prerequisites"
@@ -352,6 +361,16 @@
 #error "MBEDTLS_MEMORY_BUFFER_ALLOC_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_MEMORY_ARENA_C) &&                                 \
+    ( !defined(MBEDTLS_PLATFORM_C) || !defined(MBEDTLS_PLATFORM_MEMORY) || \
+      defined(MBEDTLS_PLATFORM_CALLOC_MACRO) )
+#error "MBEDTLS_MEMORY_ARENA_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_MEMORY_ARENA_C) && defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
+#error "MBEDTLS_MEMORY_ARENA_C and MBEDTLS_MEMORY_BUFFER_ALLOC_C cannot be defined simultaneously"
+#endif
+
 #if defined(MBEDTLS_MEMORY_BACKTRACE) && !defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
 #error "MBEDTLS_MEMORY_BACKTRACE defined, but not all prerequisites"
 #endif
@@ -643,6 +662,15 @@
 #error "MBEDTLS_PSA_ITS_FILE_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_PSA_ITS_LOG_C) && \
+    !defined(MBEDTLS_FS_IO)
+#error "MBEDTLS_PSA_ITS_LOG_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_PSA_ITS_FILE_C) && defined(MBEDTLS_PSA_ITS_LOG_C)
+#error "MBEDTLS_PSA_ITS_FILE_C and MBEDTLS_PSA_ITS_LOG_C cannot be defined simultaneously"
+#endif
+
 #if defined(MBEDTLS_PSA_CRYPTO_KEY_ID_ENCODES_OWNER) && \
     defined(MBEDTLS_USE_PSA_CRYPTO)
 #error "MBEDTLS_PSA_CRYPTO_KEY_ID_ENCODES_OWNER defined, but it cannot coexist with MBEDTLS_USE_PSA_CRYPTO."
@@ -881,6 +909,10 @@
 #error "MBEDTLS_X509_CRL_PARSE_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_X509_TRUST_STORE_C) && !defined(MBEDTLS_X509_CRT_PARSE_C)
+#error "MBEDTLS_X509_TRUST_STORE_C defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_X509_CSR_PARSE_C) && ( !defined(MBEDTLS_X509_USE_C) )
 #error "MBEDTLS_X509_CSR_PARSE_C defined, but not all prerequisites"
 #endif
@@ -0,0 +1,175 @@
+/**
+ * \file ctr_drbg_pool.h
+ *
+ * \brief Per-thread CTR_DRBG contexts seeded from one entropy source
+ *
+ * A CTR_DRBG context shared by several threads serializes them on its
+ * mutex for every random request. With this module each thread owns an
+ * mbedtls_ctr_drbg_thread context instead, and all of them are seeded from
+ * the entropy source of one mbedtls_ctr_drbg_pool. The entropy source is
+ * only used, under the mutex of the pool, when a context is seeded or
+ * reseeded, so the only shared state on the path of other random requests
+ * is an epoch counter which is read without any lock. Bumping the epoch with mbedtls_ctr_drbg_pool_schedule_reseed()
+ * makes every context reseed before its next request.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+#ifndef MBEDTLS_CTR_DRBG_POOL_H
+#define MBEDTLS_CTR_DRBG_POOL_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/ctr_drbg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          The shared part of a pool: entropy source and epoch
+ */
+typedef struct mbedtls_ctr_drbg_pool {
+    int (*f_entropy)(void *, unsigned char *, size_t);
+    /*!< The entropy callback function. It is called by the threads
+         that seed or reseed a context, one at a time. */
+
+    void *p_entropy;            /*!< The context for the entropy function. */
+
+    int epoch;                  /*!< The reseed epoch. Only accessed
+                                     atomically. */
+    int next_id;                /*!< Number of contexts seeded so far.
+                                     Only accessed atomically. */
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;    /*!< Serializes the calls to the
+                                             entropy callback. */
+#endif
+}
+mbedtls_ctr_drbg_pool;
+
+/**
+ * \brief          A per-thread CTR_DRBG context of a pool
+ */
+typedef struct mbedtls_ctr_drbg_thread {
+    mbedtls_ctr_drbg_context drbg;      /*!< The CTR_DRBG context. */
+    mbedtls_ctr_drbg_pool *pool;        /*!< The pool it was seeded from. */
+    int epoch;                          /*!< The epoch of the pool at the
+                                             last (re)seeding. */
+}
+mbedtls_ctr_drbg_thread;
+
+/**
+ * \brief               This function sets up a pool on an entropy source.
+ *
+ * \param pool          The pool to set up.
+ * \param f_entropy     The entropy callback, taking as arguments the
+ *                      \p p_entropy context, the buffer to fill, and the
+ *                      length of the buffer. The pool never calls it from
+ *                      two threads at once, but it must not be used
+ *                      concurrently outside the pool either: with
+ *                      #MBEDTLS_ENTROPY_NV_SEED, mbedtls_entropy_func()
+ *                      updates the seed file on its first call without
+ *                      holding the mutex of the entropy context.
+ * \param p_entropy     The entropy context to pass to \p f_entropy.
+ */
+void mbedtls_ctr_drbg_pool_init(mbedtls_ctr_drbg_pool *pool,
+                                int (*f_entropy)(void *, unsigned char *,
+                                                 size_t),
+                                void *p_entropy);
+
+/**
+ * \brief               This function clears a pool. All contexts seeded
+ *                      from it must have been freed.
+ *
+ * \param pool          The pool to clear. This may be \c NULL.
+ */
+void mbedtls_ctr_drbg_pool_free(mbedtls_ctr_drbg_pool *pool);
+
+/**
+ * \brief               This function makes every context of the pool
+ *                      reseed from the entropy source before its next
+ *                      random request.
+ *
+ *                      It only increments the epoch of the pool and may be
+ *                      called from any thread at any time.
+ *
+ * \param pool          The pool.
+ */
+void mbedtls_ctr_drbg_pool_schedule_reseed(mbedtls_ctr_drbg_pool *pool);
+
+/**
+ * \brief               This function initializes a per-thread context.
+ *
+ * \param ctx           The context to initialize.
+ */
+void mbedtls_ctr_drbg_thread_init(mbedtls_ctr_drbg_thread *ctx);
+
+/**
+ * \brief               This function seeds a per-thread context from the
+ *                      entropy source of a pool.
+ *
+ *                      The personalization string is prefixed with a number
+ *                      unique within the pool, so that contexts seeded with
+ *                      the same \p custom data still differ even if the
+ *                      entropy source were to repeat itself.
+ *
+ * \param ctx           The context to seed, owned by the calling thread.
+ * \param pool          The pool to seed from.
+ * \param custom        The personalization string. This can be \c NULL,
+ *                      in which case \p len must be 0.
+ * \param len           The length of the personalization string. This
+ *                      must be at least 4 bytes shorter than the maximum
+ *                      mbedtls_ctr_drbg_seed() accepts.
+ *
+ * \return              \c 0 on success.
+ * \return              An \c MBEDTLS_ERR_CTR_DRBG_XXX error code
+ *                      on failure.
+ */
+int mbedtls_ctr_drbg_thread_seed(mbedtls_ctr_drbg_thread *ctx,
+                                 mbedtls_ctr_drbg_pool *pool,
+                                 const unsigned char *custom,
+                                 size_t len);
+
+/**
+ * \brief               This function clears a per-thread context.
+ *
+ * \param ctx           The context to clear. This may be \c NULL.
+ */
+void mbedtls_ctr_drbg_thread_free(mbedtls_ctr_drbg_thread *ctx);
+
+/**
+ * \brief               This function generates random data with the
+ *                      per-thread context of the calling thread.
+ *
+ *                      If a reseed was scheduled on the pool since the
+ *                      context was last (re)seeded, it reseeds first.
+ *                      It takes the mutex of the pool only when it may
+ *                      call the entropy source: on such a reseed, when the
+ *                      reseed interval is reached, or with prediction
+ *                      resistance. Otherwise it takes no lock: the context
+ *                      is owned by the calling thread.
+ *
+ * \param p_rng         The per-thread context, of type
+ *                      mbedtls_ctr_drbg_thread. It must not be used by
+ *                      any other thread.
+ * \param output        The buffer to fill.
+ * \param output_len    The length of the buffer in bytes.
+ *
+ * \return              \c 0 on success.
+ * \return              An \c MBEDTLS_ERR_CTR_DRBG_XXX error code
+ *                      on failure.
+ */
+int mbedtls_ctr_drbg_thread_random(void *p_rng,
+                                   unsigned char *output, size_t output_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ctr_drbg_pool.h */
@@ -27,6 +27,10 @@
 #include "mbedtls/ecp.h"
 #include "mbedtls/md.h"
 
+#if defined(MBEDTLS_THREADING_C)
+#include "mbedtls/threading.h"
+#endif
+
 /**
  * \brief           Maximum ECDSA signature size for a given curve bit size
  *
@@ -110,6 +114,73 @@ typedef void mbedtls_ecdsa_restart_ctx;
 
 #endif /* MBEDTLS_ECP_RESTARTABLE */
 
+/**
+ * \brief           One signature of a batch verified by
+ *                  mbedtls_ecdsa_verify_batch().
+ *
+ *                  The caller fills in all fields but \c ret, which holds the
+ *                  result for this signature on return.
+ */
+typedef struct mbedtls_ecdsa_batch_entry {
+    const unsigned char *buf;       /*!< The hashed content that was signed. */
+    size_t blen;                    /*!< The length of \c buf in Bytes. */
+    const mbedtls_ecp_point *Q;     /*!< The public key to use. */
+    const mbedtls_mpi *r;           /*!< The first integer of the signature. */
+    const mbedtls_mpi *s;           /*!< The second integer of the signature. */
+    int ret;                        /*!< The result: \c 0 if the signature is
+                                         valid, as mbedtls_ecdsa_verify()
+                                         otherwise. */
+} mbedtls_ecdsa_batch_entry;
+
+#if !defined(MBEDTLS_ECDSA_SIGN_ALT)
+/**
+ * \brief           A precomputed ECDSA nonce: the part of a signature that
+ *                  does not depend on the key or the message.
+ */
+typedef struct mbedtls_ecdsa_nonce {
+    mbedtls_mpi k_inv;              /*!< The inverse of the nonce k mod n. */
+    mbedtls_mpi r;                  /*!< The x coordinate of k*G mod n. */
+} mbedtls_ecdsa_nonce;
+
+/**
+ * \brief           A pool of precomputed ECDSA nonces.
+ *
+ *                  A signature spends most of its time computing k*G for a
+ *                  fresh random nonce k. The pool computes nonces ahead of
+ *                  time, for instance from an idle loop or a background
+ *                  thread, so that mbedtls_ecdsa_sign_pooled() only has the
+ *                  modular arithmetic left to do.
+ *
+ *                  The nonces are as secret as the key: the pool must be
+ *                  kept in memory that only the signer can read. Each nonce
+ *                  is taken out of the pool and wiped when it is used, so
+ *                  it is never used twice.
+ *
+ * \warning         A nonce used for two signatures reveals the key. After
+ *                  fork(), parent and child hold the same nonces: the child
+ *                  must free the pool with mbedtls_ecdsa_nonce_pool_free()
+ *                  (and set up a new one if it needs it) before it signs.
+ *                  For the same reason, a pool must never be copied,
+ *                  serialized, or saved in a memory or VM snapshot.
+ */
+typedef struct mbedtls_ecdsa_nonce_pool {
+    mbedtls_ecp_group grp;          /*!< The group of the nonces. The pool
+                                         has its own copy, so that it can be
+                                         filled while another thread signs
+                                         with the same curve. */
+    mbedtls_ecdsa_nonce *nonces;    /*!< The nonces, used last in, first out. */
+    size_t size;                    /*!< The capacity of the pool. */
+    size_t count;                   /*!< The number of nonces ready. */
+    int (*f_rng)(void *, unsigned char *, size_t);  /*!< The RNG of the
+                                                         nonces. */
+    void *p_rng;                    /*!< The context of the RNG. */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;    /*!< Protects \c nonces and
+                                             \c count. */
+#endif
+} mbedtls_ecdsa_nonce_pool;
+#endif /* !MBEDTLS_ECDSA_SIGN_ALT */
+
 /**
  * \brief          This function checks whether a given group can be used
  *                 for ECDSA.
@@ -305,6 +376,52 @@ int mbedtls_ecdsa_verify(mbedtls_ecp_group *grp,
                          const mbedtls_ecp_point *Q, const mbedtls_mpi *r,
                          const mbedtls_mpi *s);
 
+/**
+ * \brief           This function verifies several ECDSA signatures of
+ *                  previously-hashed messages at once.
+ *
+ *                  Signatures are checked in groups of up to
+ *                  #MBEDTLS_ECP_LINCOMB_MAX_SIGNS with a single random linear
+ *                  combination of the verification equations, computed by
+ *                  mbedtls_ecp_check_lincomb_signs(). Signatures by the same
+ *                  key share a term. If a group does not verify, each of its
+ *                  signatures is checked with mbedtls_ecdsa_verify() so that
+ *                  the result of every entry is exact.
+ *
+ * \note            The speed-up over separate calls to mbedtls_ecdsa_verify()
+ *                  is moderate (typically 1.5 to 2 times): an ECDSA signature
+ *                  only carries the x-coordinate of its point, so every sign
+ *                  combination has to be tried, and each point must be
+ *                  recovered with a modular square root. Batching is only
+ *                  used on curves where p = 3 mod 4, other curves fall back
+ *                  to single verification.
+ *
+ * \see             mbedtls_ecdsa_verify()
+ *
+ * \param grp       The ECP group to use.
+ *                  This must be initialized and have group parameters
+ *                  set, for example through mbedtls_ecp_group_load().
+ * \param entries   The array of \p count signatures to verify. The \c ret
+ *                  field of each entry is set on return.
+ * \param count     The number of signatures.
+ * \param f_rng     The RNG function used to draw the random coefficients of
+ *                  the linear combination. This must not be \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng.
+ *
+ * \return          \c 0 if all signatures are valid.
+ * \return          #MBEDTLS_ERR_ECP_VERIFY_FAILED if at least one entry
+ *                  failed: see the \c ret field of each entry.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if an argument is invalid.
+ * \return          Another \c MBEDTLS_ERR_ECP_XXX or \c MBEDTLS_MPI_XXX
+ *                  error code on failure, such as an RNG or allocation
+ *                  failure, in which case the \c ret fields are undefined.
+ */
+int mbedtls_ecdsa_verify_batch(mbedtls_ecp_group *grp,
+                               mbedtls_ecdsa_batch_entry *entries,
+                               size_t count,
+                               int (*f_rng)(void *, unsigned char *, size_t),
+                               void *p_rng);
+
 /**
  * \brief           This function computes the ECDSA signature and writes it
  *                  to a buffer, serialized as defined in <em>RFC-4492:
@@ -465,6 +582,145 @@ int mbedtls_ecdsa_write_signature_det(mbedtls_ecdsa_context *ctx,
 #endif /* MBEDTLS_DEPRECATED_REMOVED */
 #endif /* MBEDTLS_ECDSA_DETERMINISTIC */
 
+#if !defined(MBEDTLS_ECDSA_SIGN_ALT)
+/**
+ * \brief           This function initializes a nonce pool.
+ *
+ * \param pool      The pool to initialize.
+ */
+void mbedtls_ecdsa_nonce_pool_init(mbedtls_ecdsa_nonce_pool *pool);
+
+/**
+ * \brief           This function sets up an empty nonce pool for a curve.
+ *
+ * \param pool      The pool, initialized with
+ *                  mbedtls_ecdsa_nonce_pool_init().
+ * \param gid       The curve of the keys that will use the pool.
+ * \param size      The maximum number of nonces in the pool.
+ * \param f_rng     The RNG function that mbedtls_ecdsa_nonce_pool_fill()
+ *                  uses. If the pool is filled from a thread other than the
+ *                  signer's, the RNG must be thread-safe. This must not be
+ *                  \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if \p gid cannot be used
+ *                  for ECDSA, \p size is \c 0 or \p pool is already set
+ *                  up.
+ * \return          #MBEDTLS_ERR_ECP_ALLOC_FAILED on allocation failure.
+ * \return          Another \c MBEDTLS_ERR_ECP_XXX error code on failure.
+ */
+int mbedtls_ecdsa_nonce_pool_setup(mbedtls_ecdsa_nonce_pool *pool,
+                                   mbedtls_ecp_group_id gid, size_t size,
+                                   int (*f_rng)(void *, unsigned char *, size_t),
+                                   void *p_rng);
+
+/**
+ * \brief           This function computes nonces until the pool is full,
+ *                  or until it has computed \p max of them.
+ *
+ *                  Each nonce costs about as much as a signature. The pool
+ *                  lock is only held to store a nonce once it is computed,
+ *                  so a signer in another thread is not held up.
+ *
+ * \note            Only one thread may fill a given pool at a time.
+ *
+ * \param pool      The pool.
+ * \param max       The maximum number of nonces to compute.
+ *
+ * \return          \c 0 on success.
+ * \return          An \c MBEDTLS_ERR_ECP_XXX or \c MBEDTLS_MPI_XXX
+ *                  error code on failure.
+ */
+int mbedtls_ecdsa_nonce_pool_fill(mbedtls_ecdsa_nonce_pool *pool, size_t max);
+
+/**
+ * \brief           This function returns the number of nonces ready in a
+ *                  pool.
+ *
+ * \param pool      The pool.
+ *
+ * \return          The number of nonces that signatures can use.
+ */
+size_t mbedtls_ecdsa_nonce_pool_count(mbedtls_ecdsa_nonce_pool *pool);
+
+/**
+ * \brief           This function wipes the nonces of a pool and frees it.
+ *
+ * \param pool      The pool to free. This may be \c NULL.
+ */
+void mbedtls_ecdsa_nonce_pool_free(mbedtls_ecdsa_nonce_pool *pool);
+
+/**
+ * \brief           This function computes the ECDSA signature of a
+ *                  previously-hashed message with a nonce from a pool.
+ *
+ *                  If the pool is empty, the signature is computed as by
+ *                  mbedtls_ecdsa_sign(), with a fresh nonce from \p f_rng.
+ *
+ * \note            The signature is randomized, not deterministic, even
+ *                  if #MBEDTLS_ECDSA_DETERMINISTIC is defined.
+ *
+ * \param grp       The group of the key. It must be the curve of \p pool.
+ * \param r         The MPI context in which to store the first part
+ *                  the signature. This must be initialized.
+ * \param s         The MPI context in which to store the second part
+ *                  the signature. This must be initialized.
+ * \param d         The private signing key. This must be initialized.
+ * \param buf       The hashed content to be signed. This must be a
+ *                  readable buffer of length \p blen Bytes.
+ * \param blen      The length of \p buf in Bytes.
+ * \param pool      The pool to take the nonce from.
+ * \param f_rng     The RNG function used if the pool is empty. This must
+ *                  not be \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if the curve of \p grp
+ *                  is not the curve of \p pool.
+ * \return          Another \c MBEDTLS_ERR_ECP_XXX or \c MBEDTLS_MPI_XXX
+ *                  error code on failure.
+ */
+int mbedtls_ecdsa_sign_pooled(mbedtls_ecp_group *grp, mbedtls_mpi *r,
+                              mbedtls_mpi *s, const mbedtls_mpi *d,
+                              const unsigned char *buf, size_t blen,
+                              mbedtls_ecdsa_nonce_pool *pool,
+                              int (*f_rng)(void *, unsigned char *, size_t),
+                              void *p_rng);
+
+/**
+ * \brief           This function computes the ECDSA signature of a
+ *                  previously-hashed message with a nonce from a pool, and
+ *                  writes it to a buffer as mbedtls_ecdsa_write_signature()
+ *                  does.
+ *
+ * \param ctx       The ECDSA context, with a group and a private key.
+ * \param hash      The message hash to be signed. This must be a readable
+ *                  buffer of length \p hlen Bytes.
+ * \param hlen      The length of the hash \p hash in Bytes.
+ * \param sig       The buffer to which to write the signature, of at least
+ *                  #MBEDTLS_ECDSA_MAX_SIG_LEN(curve bits) Bytes.
+ * \param slen      The address at which to store the actual length of
+ *                  the signature written. Must not be \c NULL.
+ * \param pool      The pool to take the nonce from, as for
+ *                  mbedtls_ecdsa_sign_pooled().
+ * \param f_rng     The RNG function used if the pool is empty. This must
+ *                  not be \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng.
+ *
+ * \return          \c 0 on success.
+ * \return          An \c MBEDTLS_ERR_ECP_XXX, \c MBEDTLS_ERR_MPI_XXX or
+ *                  \c MBEDTLS_ERR_ASN1_XXX error code on failure.
+ */
+int mbedtls_ecdsa_write_signature_pooled(mbedtls_ecdsa_context *ctx,
+                                         const unsigned char *hash, size_t hlen,
+                                         unsigned char *sig, size_t *slen,
+                                         mbedtls_ecdsa_nonce_pool *pool,
+                                         int (*f_rng)(void *, unsigned char *,
+                                                      size_t),
+                                         void *p_rng);
+#endif /* !MBEDTLS_ECDSA_SIGN_ALT */
+
 /**
  * \brief           This function reads and verifies an ECDSA signature.
  *
@@ -0,0 +1,225 @@
+/**
+ * \file ecdsa_sched.h
+ *
+ * \brief Cooperative scheduling of restartable ECDSA operations
+ *
+ * mbedtls_ecdsa_write_signature() and mbedtls_ecdsa_read_signature() run
+ * to completion, so a server that handles its requests on one event loop
+ * cannot do anything else while it computes a signature, and a request
+ * queued behind several signatures waits until all of them are done.
+ *
+ * This module queues signature and verification operations on a
+ * mbedtls_ecdsa_sched and runs them round-robin with the restartable ECDSA
+ * functions. Each call to mbedtls_ecdsa_sched_step() runs the operation at
+ * the head of the queue for a bounded number of basic ECC operations (see
+ * mbedtls_ecp_set_max_ops()), then moves it to the tail of the queue if it
+ * is not finished. The event loop can serve other work between two steps,
+ * and a new operation starts after at most one slice of each operation
+ * queued in front of it instead of after all of them have finished.
+ *
+ * The budget of a slice is set with the global mbedtls_ecp_set_max_ops()
+ * for the duration of the slice, so no other thread may run restartable
+ * ECC operations while a scheduler is stepped.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+#ifndef MBEDTLS_ECDSA_SCHED_H
+#define MBEDTLS_ECDSA_SCHED_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/md.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          A queued ECDSA operation
+ *
+ *                 The memory of an operation belongs to the caller. It
+ *                 must stay valid from the moment the operation is queued
+ *                 until its completion callback is called or it is
+ *                 cancelled. It may be queued again from the callback,
+ *                 for instance to verify the signature it computed with
+ *                 \c op->hash and \c op->sig as inputs.
+ */
+typedef struct mbedtls_ecdsa_sched_op {
+    struct mbedtls_ecdsa_sched_op *next;    /*!< The next operation in the
+                                                 queue. */
+    int verify;                 /*!< 1 for a verification, 0 for a
+                                     signature. */
+    mbedtls_ecdsa_context *ctx; /*!< The key. Several operations may use
+                                     the same key. */
+    mbedtls_md_type_t md_alg;   /*!< The hash algorithm of a signature. */
+    unsigned char hash[MBEDTLS_MD_MAX_SIZE];    /*!< The hash to sign or
+                                                     to verify. */
+    size_t hlen;                /*!< The length of the hash. */
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];   /*!< The signature: the
+                                                     output of a signature,
+                                                     the input of a
+                                                     verification. */
+    size_t sig_len;             /*!< The length of the signature. */
+    int (*f_rng)(void *, unsigned char *, size_t);  /*!< The RNG of a
+                                                         signature. */
+    void *p_rng;                /*!< The context of the RNG. */
+    void (*f_done)(void *, struct mbedtls_ecdsa_sched_op *, int);
+    /*!< The completion callback. It is called with \c p_done, the
+         operation and the result of mbedtls_ecdsa_write_signature() or
+         mbedtls_ecdsa_read_signature(). */
+    void *p_done;               /*!< The context of the callback. */
+    unsigned slices;            /*!< The number of slices run so far. */
+    mbedtls_ecdsa_restart_ctx rs;   /*!< The restart context. */
+}
+mbedtls_ecdsa_sched_op;
+
+/**
+ * \brief          The scheduler: a round-robin queue of operations
+ */
+typedef struct mbedtls_ecdsa_sched {
+    mbedtls_ecdsa_sched_op *head;   /*!< The operation to run next. */
+    mbedtls_ecdsa_sched_op *tail;   /*!< The operation queued last. */
+    size_t pending;                 /*!< The number of queued operations. */
+    unsigned max_ops;               /*!< The budget of one slice. */
+}
+mbedtls_ecdsa_sched;
+
+/**
+ * \brief               This function initializes a scheduler.
+ *
+ * \param sched         The scheduler to initialize.
+ * \param max_ops       The number of basic ECC operations of a slice, as
+ *                      for mbedtls_ecp_set_max_ops(). A P-256 signature is
+ *                      about 3300 of them. \c 0 runs every operation to
+ *                      completion in one slice, in the order they were
+ *                      queued.
+ */
+void mbedtls_ecdsa_sched_init(mbedtls_ecdsa_sched *sched, unsigned max_ops);
+
+/**
+ * \brief               This function clears a scheduler. Operations still
+ *                      queued are dropped without calling their callbacks.
+ *
+ * \param sched         The scheduler to clear. This may be \c NULL.
+ */
+void mbedtls_ecdsa_sched_free(mbedtls_ecdsa_sched *sched);
+
+/**
+ * \brief               This function queues the computation of an ECDSA
+ *                      signature, as by mbedtls_ecdsa_write_signature().
+ *
+ *                      When it completes, the DER signature is in
+ *                      \c op->sig and its length in \c op->sig_len.
+ *
+ * \param sched         The scheduler.
+ * \param op            The operation to queue. It must not be queued
+ *                      already.
+ * \param ctx           The ECDSA context, with a group and a private key.
+ * \param md_alg        The hash algorithm that was used to hash the message.
+ * \param hash          The hash to sign. It is copied into \p op.
+ * \param hlen          The length of the hash, at most
+ *                      #MBEDTLS_MD_MAX_SIZE bytes.
+ * \param f_rng         The RNG function, as for
+ *                      mbedtls_ecdsa_write_signature().
+ * \param p_rng         The RNG context.
+ * \param f_done        The function to call with \p p_done, \p op and the
+ *                      result once the signature is done. This may be
+ *                      \c NULL.
+ * \param p_done        The context of \p f_done.
+ *
+ * \return              \c 0 on success.
+ * \return              #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if \p hlen is too
+ *                      long.
+ */
+int mbedtls_ecdsa_sched_sign(mbedtls_ecdsa_sched *sched,
+                             mbedtls_ecdsa_sched_op *op,
+                             mbedtls_ecdsa_context *ctx,
+                             mbedtls_md_type_t md_alg,
+                             const unsigned char *hash, size_t hlen,
+                             int (*f_rng)(void *, unsigned char *, size_t),
+                             void *p_rng,
+                             void (*f_done)(void *, mbedtls_ecdsa_sched_op *,
+                                            int),
+                             void *p_done);
+
+/**
+ * \brief               This function queues the verification of an ECDSA
+ *                      signature, as by mbedtls_ecdsa_read_signature().
+ *
+ * \param sched         The scheduler.
+ * \param op            The operation to queue. It must not be queued
+ *                      already.
+ * \param ctx           The ECDSA context, with a group and a public key.
+ * \param hash          The hash that was signed. It is copied into \p op.
+ * \param hlen          The length of the hash, at most
+ *                      #MBEDTLS_MD_MAX_SIZE bytes.
+ * \param sig           The DER signature. It is copied into \p op.
+ * \param slen          The length of the signature, at most
+ *                      #MBEDTLS_ECDSA_MAX_LEN bytes.
+ * \param f_done        The function to call with \p p_done, \p op and the
+ *                      result once the verification is done. This may be
+ *                      \c NULL.
+ * \param p_done        The context of \p f_done.
+ *
+ * \return              \c 0 on success.
+ * \return              #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if \p hlen or
+ *                      \p slen is too long.
+ */
+int mbedtls_ecdsa_sched_verify(mbedtls_ecdsa_sched *sched,
+                               mbedtls_ecdsa_sched_op *op,
+                               mbedtls_ecdsa_context *ctx,
+                               const unsigned char *hash, size_t hlen,
+                               const unsigned char *sig, size_t slen,
+                               void (*f_done)(void *, mbedtls_ecdsa_sched_op *,
+                                              int),
+                               void *p_done);
+
+/**
+ * \brief               This function removes an operation from the queue
+ *                      without calling its callback.
+ *
+ * \param sched         The scheduler.
+ * \param op            The operation to cancel.
+ *
+ * \return              \c 0 on success.
+ * \return              #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if \p op is not
+ *                      queued on \p sched.
+ */
+int mbedtls_ecdsa_sched_cancel(mbedtls_ecdsa_sched *sched,
+                               mbedtls_ecdsa_sched_op *op);
+
+/**
+ * \brief               This function runs one slice of the operation at
+ *                      the head of the queue.
+ *
+ *                      If the operation is not finished after the slice,
+ *                      it goes to the tail of the queue. Otherwise it is
+ *                      removed from the queue and its callback is called.
+ *
+ * \param sched         The scheduler.
+ *
+ * \return              The number of operations still queued, including
+ *                      any queued by the callback.
+ */
+size_t mbedtls_ecdsa_sched_step(mbedtls_ecdsa_sched *sched);
+
+/**
+ * \brief               This function steps the scheduler until its queue
+ *                      is empty.
+ *
+ * \param sched         The scheduler.
+ */
+void mbedtls_ecdsa_sched_run(mbedtls_ecdsa_sched *sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ecdsa_sched.h */
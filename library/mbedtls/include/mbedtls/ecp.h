@@ -357,6 +357,9 @@ mbedtls_ecp_group;
  * ECDSA verification and ECDHE) by a factor roughly 3 to 4.
  *
  * The cost is increasing EC peak memory usage by a factor roughly 2.
+ * For secp256r1, secp384r1 and secp521r1, the table for the generator is
+ * instead a constant generated by scripts/ecp_comb_table.py: it uses no
+ * RAM and no precomputation, but about 1, 3 and 4.5 KB of read-only data.
  *
  * Change this value to 0 to reduce peak memory usage.
  */
@@ -1110,6 +1113,107 @@ int mbedtls_ecp_muladd_restartable(
     const mbedtls_mpi *m, const mbedtls_ecp_point *P,
     const mbedtls_mpi *n, const mbedtls_ecp_point *Q,
     mbedtls_ecp_restart_ctx *rs_ctx);
+
+/** The maximum number of signed terms of mbedtls_ecp_check_lincomb_signs(). */
+#define MBEDTLS_ECP_LINCOMB_MAX_SIGNS   8
+
+/**
+ * \brief           This function computes a linear combination of several
+ *                  points: \p R = \p m[0] * \p P[0] + ... +
+ *                  \p m[count-1] * \p P[count-1].
+ *
+ *                  It shares a single chain of doublings between all terms
+ *                  (interleaved multiplication on the wNAF of each scalar),
+ *                  which is much faster than separate multiplications.
+ *
+ * \warning         This function is NOT constant-time: its timing and memory
+ *                  access pattern depend on the scalars and points. It must
+ *                  only be used with public values, such as in signature
+ *                  verification.
+ *
+ * \note            This function is only defined for short Weierstrass curves.
+ *                  It may not be included in builds without any short
+ *                  Weierstrass curve.
+ *
+ * \param grp       The ECP group to use.
+ *                  This must be initialized and have group parameters
+ *                  set, for example through mbedtls_ecp_group_load().
+ * \param R         The point in which to store the result of the calculation.
+ *                  This must be initialized.
+ * \param m         The array of \p count integers by which to multiply the
+ *                  points. Each must be in the range 0 .. N-1.
+ * \param P         The array of \p count points to multiply. Each must be a
+ *                  valid public key on \p grp.
+ * \param count     The number of terms. This must be at least \c 1.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if \p count is \c 0 or a
+ *                  scalar is out of range.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if a point is not a valid
+ *                  public key.
+ * \return          #MBEDTLS_ERR_ECP_ALLOC_FAILED on memory-allocation failure.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \p grp does not
+ *                  designate a short Weierstrass curve.
+ * \return          Another negative error code on other kinds of failure.
+ */
+int mbedtls_ecp_muladd_multi(mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+                             size_t count);
+
+/**
+ * \brief           This function checks whether, for some choice of signs,
+ *                  \p m[0] * \p P[0] + ... + \p m[count-1] * \p P[count-1]
+ *                  +/- \p z[0] * \p S[0] +/- ... +/- \p z[s_count-1] *
+ *                  \p S[s_count-1] is the point at infinity.
+ *
+ *                  This is the core of batch verification of signature
+ *                  schemes that only carry the x-coordinate of a point,
+ *                  such as ECDSA: the signed terms are the points recovered
+ *                  from the signatures, whose y-coordinate is only known up
+ *                  to its sign. All \c 2^s_count combinations cost one
+ *                  point addition each on top of a single interleaved
+ *                  multiplication.
+ *
+ * \warning         This function is NOT constant-time, see
+ *                  mbedtls_ecp_muladd_multi().
+ *
+ * \note            This function is only defined for short Weierstrass curves.
+ *                  It may not be included in builds without any short
+ *                  Weierstrass curve.
+ *
+ * \param grp       The ECP group to use.
+ *                  This must be initialized and have group parameters
+ *                  set, for example through mbedtls_ecp_group_load().
+ * \param m         The array of \p count integers by which to multiply the
+ *                  points \p P. Each must be in the range 0 .. N-1.
+ * \param P         The array of \p count points of the unsigned terms.
+ *                  Each must be a valid public key on \p grp.
+ * \param count     The number of unsigned terms.
+ * \param z         The array of \p s_count integers by which to multiply the
+ *                  points \p S. Each must be in the range 1 .. N-1.
+ * \param S         The array of \p s_count points of the signed terms.
+ *                  Each must be a valid public key on \p grp.
+ * \param s_count   The number of signed terms. This must be at most
+ *                  #MBEDTLS_ECP_LINCOMB_MAX_SIGNS.
+ *
+ * \return          \c 0 if the combination is zero for some choice of signs.
+ * \return          #MBEDTLS_ERR_ECP_VERIFY_FAILED if it is zero for none.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if there are no terms,
+ *                  too many signed terms, or a scalar is out of range.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if a point is not a valid
+ *                  public key.
+ * \return          #MBEDTLS_ERR_ECP_ALLOC_FAILED on memory-allocation failure.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \p grp does not
+ *                  designate a short Weierstrass curve.
+ * \return          Another negative error code on other kinds of failure.
+ */
+int mbedtls_ecp_check_lincomb_signs(mbedtls_ecp_group *grp,
+                                    const mbedtls_mpi *m,
+                                    const mbedtls_ecp_point *P,
+                                    size_t count,
+                                    const mbedtls_mpi *z,
+                                    const mbedtls_ecp_point *S,
+                                    size_t s_count);
 #endif /* MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED */
 
 /**
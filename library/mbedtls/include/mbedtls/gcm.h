@@ -63,6 +63,10 @@ typedef struct mbedtls_gcm_context {
     int mode;                             /*!< The operation to perform:
                                            #MBEDTLS_GCM_ENCRYPT or
                                            #MBEDTLS_GCM_DECRYPT. */
+#if defined(MBEDTLS_AESNI_C)
+    unsigned char HP[64];                 /*!< H^4 to H, byte-reversed, for
+                                           the AES-NI kernel. */
+#endif
 }
 mbedtls_gcm_context;
 
@@ -0,0 +1,151 @@
+/**
+ * \file memory_arena.h
+ *
+ * \brief Per-thread arena allocator for short-lived crypto operations
+ *
+ * A single ECDSA sign or verify allocates and frees a few thousand small
+ * blocks as the mbedtls_mpi values inside bignum.c and ecp.c grow and
+ * shrink. Between mbedtls_memory_arena_begin() and
+ * mbedtls_memory_arena_end() those blocks are carved out of a caller
+ * provided buffer instead of going through the system heap: freed blocks
+ * go to a free list per size and are handed out again, new ones are cut
+ * from the end of the buffer. Requests the buffer cannot hold fall back to
+ * the heap, so its size bounds the footprint of the arena.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+#ifndef MBEDTLS_MEMORY_ARENA_H
+#define MBEDTLS_MEMORY_ARENA_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include <stddef.h>
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#if !defined(MBEDTLS_MEMORY_ARENA_ALIGN)
+#define MBEDTLS_MEMORY_ARENA_ALIGN          16 /**< Alignment of arena blocks, power of 2, >= 8 */
+#endif
+
+#if !defined(MBEDTLS_MEMORY_ARENA_MAX_BLOCK)
+#define MBEDTLS_MEMORY_ARENA_MAX_BLOCK    1024 /**< Largest request served by the arena */
+#endif
+
+/** \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief   Allocation counters of an arena
+ */
+typedef struct mbedtls_memory_arena_stats {
+    size_t ops;             /*!< operations completed so far                */
+    size_t op_allocs;       /*!< allocations in the last operation          */
+    size_t op_fallbacks;    /*!< of these, served by the heap because the
+                                 buffer was full or the block too large     */
+    size_t op_peak;         /*!< peak bytes cut from the buffer in the
+                                 last operation                             */
+    size_t max_peak;        /*!< maximum of op_peak over all operations     */
+    size_t total_allocs;    /*!< allocations over all operations            */
+    size_t total_fallbacks; /*!< heap fallbacks over all operations         */
+}
+mbedtls_memory_arena_stats;
+
+/**
+ * \brief   Arena context
+ */
+typedef struct mbedtls_memory_arena {
+    unsigned char *buf;     /*!< arena buffer                           */
+    size_t len;             /*!< size of the buffer                     */
+    size_t used;            /*!< bytes cut from the buffer so far       */
+    size_t live;            /*!< blocks not yet freed                   */
+    void *free_list[MBEDTLS_MEMORY_ARENA_MAX_BLOCK /
+                    MBEDTLS_MEMORY_ARENA_ALIGN];    /*!< freed blocks by size */
+    int depth;              /*!< nesting of begin/end                   */
+    mbedtls_memory_arena_stats stats;   /*!< allocation counters        */
+}
+mbedtls_memory_arena;
+
+/**
+ * \brief   Set up an arena on a buffer and bind it to the calling thread.
+ *
+ *          The first call also installs the arena allocator through
+ *          mbedtls_platform_set_calloc_free(). Outside of an operation,
+ *          and on threads without an arena, the allocator passes every
+ *          request on to MBEDTLS_PLATFORM_STD_CALLOC and
+ *          MBEDTLS_PLATFORM_STD_FREE.
+ *
+ * \note    A thread has at most one arena. Blocks carved out of it must
+ *          be freed on the same thread, and before
+ *          mbedtls_memory_arena_free() is called.
+ *
+ * \note    The allocator replaces any calloc() and free() set before, so
+ *          MBEDTLS_MEMORY_BUFFER_ALLOC_C cannot be enabled with it.
+ *
+ * \param arena The arena context to set up.
+ * \param buf   The buffer to carve blocks from. It must stay valid until
+ *              mbedtls_memory_arena_free().
+ * \param len   The size of \p buf in bytes.
+ */
+void mbedtls_memory_arena_init(mbedtls_memory_arena *arena,
+                               unsigned char *buf, size_t len);
+
+/**
+ * \brief   Unbind an arena from the calling thread.
+ *
+ * \param arena The arena context to clear. This may be \c NULL.
+ */
+void mbedtls_memory_arena_free(mbedtls_memory_arena *arena);
+
+/**
+ * \brief   Start an operation: from now on allocations of the calling
+ *          thread are served by the arena.
+ *
+ *          Calls may be nested; only the outermost pair counts as an
+ *          operation in the statistics.
+ *
+ * \param arena The arena bound to the calling thread.
+ */
+void mbedtls_memory_arena_begin(mbedtls_memory_arena *arena);
+
+/**
+ * \brief   End an operation started with mbedtls_memory_arena_begin().
+ *
+ *          Blocks that are still in use, such as the output values of
+ *          the operation, stay valid and may be freed later. The buffer is
+ *          rewound once all blocks are freed.
+ *
+ * \param arena The arena bound to the calling thread.
+ *
+ * \return  The number of blocks of the arena still in use.
+ */
+size_t mbedtls_memory_arena_end(mbedtls_memory_arena *arena);
+
+/**
+ * \brief   Get the allocation counters of an arena.
+ *
+ * \param arena The arena context.
+ * \param stats The structure to fill.
+ */
+void mbedtls_memory_arena_get_stats(const mbedtls_memory_arena *arena,
+                                    mbedtls_memory_arena_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* memory_arena.h */
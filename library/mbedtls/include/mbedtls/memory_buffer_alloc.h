@@ -51,8 +51,10 @@ extern "C" {
  *          (Provided mbedtls_calloc() and mbedtls_free() are thread-safe if
  *           MBEDTLS_THREADING_C is defined)
  *
- * \note    This code is not optimized and provides a straight-forward
- *          implementation of a stack-based memory allocator.
+ * \note    Free blocks are kept in segregated lists by size class, so
+ *          mbedtls_calloc() and mbedtls_free() do not depend on the number
+ *          of free blocks, except when the only free blocks that are large
+ *          enough are in the size class of the request.
  *
  * \param buf   buffer to use as heap
  * \param len   size of the buffer
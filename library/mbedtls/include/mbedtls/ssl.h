@@ -4110,6 +4110,42 @@ int mbedtls_ssl_renegotiate(mbedtls_ssl_context *ssl);
  */
 int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len);
 
+/**
+ * \brief          A buffer of a scatter or gather list, see
+ *                 mbedtls_ssl_readv() and mbedtls_ssl_writev()
+ */
+typedef struct mbedtls_ssl_iovec {
+    unsigned char *buf;         /*!< start of the buffer                */
+    size_t len;                 /*!< length of the buffer in bytes      */
+}
+mbedtls_ssl_iovec;
+
+/**
+ * \brief          Read application data into several buffers
+ *
+ *                 This is mbedtls_ssl_read() on each buffer of \p iov in
+ *                 turn, for as long as the current record has data left:
+ *                 only the first of these reads may read from the
+ *                 underlying transport, and a record can be read into
+ *                 non-contiguous buffers without copying it first.
+ *
+ * \param ssl      SSL context
+ * \param iov      the buffers to fill in order; they may be empty
+ * \param iovcnt   the number of buffers
+ *
+ * \return         The (positive) number of bytes read, spread over the
+ *                 buffers of \p iov from the first one.
+ * \return         \c 0 if the total length of \p iov is 0, or for EOF as
+ *                 with mbedtls_ssl_read().
+ * \return         A negative error code of mbedtls_ssl_read() if no data
+ *                 was read. It must be handled as for mbedtls_ssl_read(),
+ *                 calling this function again with the same arguments
+ *                 when it is #MBEDTLS_ERR_SSL_WANT_READ or
+ *                 #MBEDTLS_ERR_SSL_WANT_WRITE.
+ */
+int mbedtls_ssl_readv(mbedtls_ssl_context *ssl,
+                      const mbedtls_ssl_iovec *iov, size_t iovcnt);
+
 /**
  * \brief          Try to write exactly 'len' application data bytes
  *
@@ -4172,6 +4208,50 @@ int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len);
  */
 int mbedtls_ssl_write(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len);
 
+/**
+ * \brief          Write application data from several buffers
+ *
+ *                 The data of the buffers of \p iov, taken in order, is
+ *                 copied directly into records. With TLS, one call fills
+ *                 as many records of the maximum fragment length as the
+ *                 output buffer can hold (see MBEDTLS_SSL_OUT_CONTENT_LEN)
+ *                 and sends them with a single call of the send callback
+ *                 where possible, rather than one record per call. This
+ *                 only batches records when a maximum fragment length
+ *                 smaller than MBEDTLS_SSL_OUT_CONTENT_LEN is in use.
+ *
+ * \note           With #MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH, the output
+ *                 buffer only holds one record after the handshake. The
+ *                 first call that needs more grows it back to its full
+ *                 size, for the rest of the connection.
+ *
+ * \warning        As with mbedtls_ssl_write(), this function may write
+ *                 less data than requested. If the return value is
+ *                 non-negative but less than the total length of \p iov,
+ *                 it must be called again for the rest of the data.
+ *
+ * \param ssl      SSL context
+ * \param iov      the buffers holding the data; they may be empty, and
+ *                 are not modified
+ * \param iovcnt   the number of buffers
+ *
+ * \return         The (non-negative) number of bytes written, from the
+ *                 start of the data of \p iov.
+ * \return         The error codes of mbedtls_ssl_write(), which must be
+ *                 handled in the same way: when it is
+ *                 #MBEDTLS_ERR_SSL_WANT_WRITE, call this function again
+ *                 with the *same* arguments.
+ *
+ * \note           With DTLS, the data is sent in one record, and
+ *                 #MBEDTLS_ERR_SSL_BAD_INPUT_DATA is returned if it does
+ *                 not fit in one.
+ *
+ * \note           If the total length of \p iov is 0, an empty
+ *                 application record is sent.
+ */
+int mbedtls_ssl_writev(mbedtls_ssl_context *ssl,
+                       const mbedtls_ssl_iovec *iov, size_t iovcnt);
+
 /**
  * \brief           Send an alert message
  *
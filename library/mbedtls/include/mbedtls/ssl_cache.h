@@ -38,6 +38,18 @@
 #define MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES      50   /*!< Maximum entries in cache */
 #endif
 
+#if !defined(MBEDTLS_SSL_CACHE_SHARDS)
+#if defined(MBEDTLS_THREADING_C)
+#define MBEDTLS_SSL_CACHE_SHARDS                    8   /*!< Independently locked parts of the cache */
+#else
+#define MBEDTLS_SSL_CACHE_SHARDS                    1
+#endif
+#endif
+
+#if MBEDTLS_SSL_CACHE_SHARDS < 1
+#error "MBEDTLS_SSL_CACHE_SHARDS must be at least 1"
+#endif
+
 /** \} name SECTION: Module settings */
 
 #ifdef __cplusplus
@@ -59,19 +71,35 @@ struct mbedtls_ssl_cache_entry {
     defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
     mbedtls_x509_buf peer_cert;         /*!< entry peer_cert    */
 #endif
-    mbedtls_ssl_cache_entry *next;      /*!< chain pointer      */
+    uint32_t hash;                      /*!< hash of the session ID */
+    mbedtls_ssl_cache_entry *next;      /*!< next entry in the bucket   */
+    mbedtls_ssl_cache_entry *newer;     /*!< more recently used entry   */
+    mbedtls_ssl_cache_entry *older;     /*!< less recently used entry   */
 };
 
+/**
+ * \brief   A part of the cache, holding the sessions whose ID hashes
+ *          to it in a hash table and in a list in order of use
+ */
+typedef struct mbedtls_ssl_cache_shard {
+    mbedtls_ssl_cache_entry **buckets;  /*!< hash table by session ID   */
+    size_t bucket_count;        /*!< size of the table, a power of 2    */
+    size_t entries;             /*!< number of entries in the shard     */
+    mbedtls_ssl_cache_entry *newest;    /*!< most recently used entry   */
+    mbedtls_ssl_cache_entry *oldest;    /*!< least recently used entry  */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;    /*!< mutex                  */
+#endif
+}
+mbedtls_ssl_cache_shard;
+
 /**
  * \brief Cache context
  */
 struct mbedtls_ssl_cache_context {
-    mbedtls_ssl_cache_entry *chain;     /*!< start of the chain     */
+    mbedtls_ssl_cache_shard shards[MBEDTLS_SSL_CACHE_SHARDS]; /*!< shards */
     int timeout;                /*!< cache entry timeout    */
     int max_entries;            /*!< maximum entries        */
-#if defined(MBEDTLS_THREADING_C)
-    mbedtls_threading_mutex_t mutex;    /*!< mutex                  */
-#endif
 };
 
 /**
@@ -124,6 +152,15 @@ void mbedtls_ssl_cache_set_timeout(mbedtls_ssl_cache_context *cache, int timeout
  * \brief          Set the maximum number of cache entries
  *                 (Default: MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES (50))
  *
+ *                 The entries are shared out evenly among the
+ *                 MBEDTLS_SSL_CACHE_SHARDS shards of the cache, or among
+ *                 the first \p max shards if \p max is smaller, so the
+ *                 cache never holds more than \p max sessions. A shard
+ *                 evicts its least recently used entry when it is full,
+ *                 so the cache may start evicting before it holds \p max
+ *                 sessions. Set it before the cache is in use: sessions
+ *                 stored before a change may no longer be found.
+ *
  * \param cache    SSL cache context
  * \param max      cache entry maximum
  */
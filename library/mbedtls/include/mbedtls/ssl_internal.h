@@ -1296,6 +1296,9 @@ void mbedtls_ssl_reset_in_out_pointers(mbedtls_ssl_context *ssl);
 void mbedtls_ssl_update_out_pointers(mbedtls_ssl_context *ssl,
                                      mbedtls_ssl_transform *transform);
 void mbedtls_ssl_update_in_pointers(mbedtls_ssl_context *ssl);
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+void mbedtls_ssl_grow_out_buf(mbedtls_ssl_context *ssl, size_t len);
+#endif
 
 MBEDTLS_CHECK_RETURN_CRITICAL
 int mbedtls_ssl_session_reset_int(mbedtls_ssl_context *ssl, int partial);
@@ -67,6 +67,8 @@ typedef struct mbedtls_x509_crl {
     mbedtls_x509_time next_update;
 
     mbedtls_x509_crl_entry entry;   /**< The CRL entries containing the certificate revocation times for this CA. */
+    mbedtls_x509_crl_entry *entries;    /**< All entries in one array sorted by serial number, or NULL if there are less than two. \c entry is then a copy of the first one in CRL order, and the \c next pointers run through the array in CRL order. */
+    size_t entry_count;                 /**< The number of elements of \c entries. */
 
     mbedtls_x509_buf crl_ext;
 
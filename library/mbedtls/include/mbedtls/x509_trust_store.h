@@ -0,0 +1,164 @@
+/**
+ * \file x509_trust_store.h
+ *
+ * \brief Precompiled trust stores with an issuer index
+ *
+ * mbedtls_x509_crt_parse_file() and mbedtls_x509_crt_parse_path() parse
+ * every certificate of a CA bundle in full, and chain verification scans
+ * the resulting list for the issuer of each certificate. A trust store
+ * holds the DER certificates of a bundle after one such parse, with a hash
+ * table on their subject names. It is loaded by mapping the file into
+ * memory, and mbedtls_x509_trust_store_ca_cb() parses only the
+ * certificates whose subject matches the issuer looked for.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+#ifndef MBEDTLS_X509_TRUST_STORE_H
+#define MBEDTLS_X509_TRUST_STORE_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/x509_crt.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          A loaded trust store
+ *
+ *                 The certificates returned by
+ *                 mbedtls_x509_trust_store_ca_cb() point into the data of
+ *                 the store, which must therefore outlive them.
+ */
+typedef struct mbedtls_x509_trust_store {
+    const unsigned char *buf;   /*!< The serialized store.               */
+    size_t len;                 /*!< Its length in bytes.                */
+    uint32_t count;             /*!< Number of certificates.             */
+    uint32_t buckets;           /*!< Number of hash buckets, a power of 2. */
+    int mapped;                 /*!< 1 if \c buf is a mapping of a file
+                                     made by the loader, 0 if it belongs
+                                     to the caller.                      */
+}
+mbedtls_x509_trust_store;
+
+/**
+ * \brief          Initialize a trust store.
+ *
+ * \param store    The trust store to initialize.
+ */
+void mbedtls_x509_trust_store_init(mbedtls_x509_trust_store *store);
+
+/**
+ * \brief          Serialize a list of parsed certificates into a trust
+ *                 store.
+ *
+ *                 Certificates that occur more than once in \p chain are
+ *                 only stored once.
+ *
+ * \param chain    The certificates, for example the result of
+ *                 mbedtls_x509_crt_parse_file() on a CA bundle.
+ * \param buf      The buffer to write the store to. This may be \c NULL
+ *                 if \p size is 0.
+ * \param size     The size of \p buf in bytes.
+ * \param olen     The length of the store in bytes.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_X509_BUFFER_TOO_SMALL if \p buf is too
+ *                 small, in which case \c *olen is the size it needs.
+ * \return         #MBEDTLS_ERR_X509_BAD_INPUT_DATA if \p chain is empty or
+ *                 the store would not fit in 4 GiB.
+ * \return         #MBEDTLS_ERR_X509_ALLOC_FAILED on allocation failure.
+ */
+int mbedtls_x509_trust_store_write(const mbedtls_x509_crt *chain,
+                                   unsigned char *buf, size_t size,
+                                   size_t *olen);
+
+/**
+ * \brief          Load a trust store from a buffer, without copying it.
+ *
+ *                 The header and the index are checked, the certificates
+ *                 are only parsed when looked up.
+ *
+ * \param store    The trust store to load into. It must be initialized.
+ * \param buf      The serialized store. It must stay valid and unchanged
+ *                 until mbedtls_x509_trust_store_free() is called and all
+ *                 certificates returned by mbedtls_x509_trust_store_ca_cb()
+ *                 are freed.
+ * \param len      The length of \p buf in bytes.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_X509_INVALID_FORMAT if \p buf is not a
+ *                 trust store of this version.
+ */
+int mbedtls_x509_trust_store_load(mbedtls_x509_trust_store *store,
+                                  const unsigned char *buf, size_t len);
+
+#if defined(MBEDTLS_FS_IO)
+/**
+ * \brief          Load a trust store from a file.
+ *
+ *                 The file is mapped into memory where the platform
+ *                 supports it (POSIX mmap(), Windows MapViewOfFile()), so
+ *                 only the pages that are looked up are read.
+ *
+ * \param store    The trust store to load into. It must be initialized.
+ * \param path     The name of the file.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_X509_FILE_IO_ERROR if the file cannot be
+ *                 opened or mapped.
+ * \return         #MBEDTLS_ERR_X509_INVALID_FORMAT if it is not a trust
+ *                 store of this version.
+ */
+int mbedtls_x509_trust_store_load_file(mbedtls_x509_trust_store *store,
+                                       const char *path);
+#endif /* MBEDTLS_FS_IO */
+
+/**
+ * \brief          Free a trust store, unmapping its file if it was loaded
+ *                 with mbedtls_x509_trust_store_load_file().
+ *
+ * \param store    The trust store to free. This may be \c NULL.
+ */
+void mbedtls_x509_trust_store_free(mbedtls_x509_trust_store *store);
+
+/**
+ * \brief          Trusted certificate callback on a trust store, for use
+ *                 with mbedtls_x509_crt_verify_with_ca_cb() and
+ *                 mbedtls_ssl_conf_ca_cb().
+ *
+ *                 It returns the certificates of the store whose subject
+ *                 has the hash of the issuer of \p child. This is a
+ *                 superset of the certificates whose subject matches the
+ *                 issuer; verification checks the names and signatures of
+ *                 all candidates.
+ *
+ * \param p_ctx    The trust store, of type ::mbedtls_x509_trust_store.
+ * \param child    The certificate whose issuer is looked for.
+ * \param candidate_cas The address at which to store the list of
+ *                 candidates, or \c NULL if there is none. See
+ *                 ::mbedtls_x509_crt_ca_cb_t.
+ *
+ * \return         \c 0 on success, even without candidates.
+ * \return         An \c MBEDTLS_ERR_X509_XXX error code if a certificate
+ *                 of the store cannot be parsed or on allocation failure.
+ */
+int mbedtls_x509_trust_store_ca_cb(void *p_ctx,
+                                   mbedtls_x509_crt const *child,
+                                   mbedtls_x509_crt **candidate_cas);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* x509_trust_store.h */
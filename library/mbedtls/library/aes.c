@@ -32,6 +32,12 @@
 
 #if !defined(MBEDTLS_AES_ALT)
 
+#if defined(MBEDTLS_AESNI_HAVE_CODE)
+/* Bytes en(de)crypted at once by mbedtls_aesni_crypt_ecb8() in the CBC and
+ * CTR modes */
+#define AES_AESNI_BULK_LEN  128
+#endif
+
 /* Parameter validation macros based on platform_util.h */
 #define AES_VALIDATE_RET(cond)    \
     MBEDTLS_INTERNAL_VALIDATE_RET(cond, MBEDTLS_ERR_AES_BAD_INPUT_DATA)
@@ -1115,6 +1121,35 @@ int mbedtls_aes_crypt_cbc(mbedtls_aes_context *ctx,
     }
 #endif
 
+#if defined(MBEDTLS_AESNI_HAVE_CODE)
+    if (mode == MBEDTLS_AES_DECRYPT && length >= AES_AESNI_BULK_LEN &&
+        mbedtls_aesni_has_support(MBEDTLS_AESNI_AES)) {
+        /* The blocks are independent when decrypting: decrypt 8 at once.
+         * The input is copied first, as output may overlap it. */
+        unsigned char in[AES_AESNI_BULK_LEN], out[AES_AESNI_BULK_LEN];
+
+        while (length >= AES_AESNI_BULK_LEN) {
+            memcpy(in, input, AES_AESNI_BULK_LEN);
+            mbedtls_aesni_crypt_ecb8(ctx, mode, in, out);
+
+            for (i = 0; i < 16; i++) {
+                output[i] = (unsigned char) (out[i] ^ iv[i]);
+            }
+            for (i = 16; i < AES_AESNI_BULK_LEN; i++) {
+                output[i] = (unsigned char) (out[i] ^ in[i - 16]);
+            }
+
+            memcpy(iv, in + AES_AESNI_BULK_LEN - 16, 16);
+
+            input  += AES_AESNI_BULK_LEN;
+            output += AES_AESNI_BULK_LEN;
+            length -= AES_AESNI_BULK_LEN;
+        }
+
+        mbedtls_platform_zeroize(out, sizeof(out));
+    }
+#endif /* MBEDTLS_AESNI_HAVE_CODE */
+
     if (mode == MBEDTLS_AES_DECRYPT) {
         while (length > 0) {
             memcpy(temp, input, 16);
@@ -1486,6 +1521,40 @@ int mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx,
         return MBEDTLS_ERR_AES_BAD_INPUT_DATA;
     }
 
+#if defined(MBEDTLS_AESNI_HAVE_CODE)
+    if (n == 0 && length >= AES_AESNI_BULK_LEN &&
+        mbedtls_aesni_has_support(MBEDTLS_AESNI_AES)) {
+        /* Whole blocks, 8 counter blocks at once */
+        unsigned char counters[AES_AESNI_BULK_LEN], stream[AES_AESNI_BULK_LEN];
+        size_t j;
+
+        while (length >= AES_AESNI_BULK_LEN) {
+            for (j = 0; j < AES_AESNI_BULK_LEN; j += 16) {
+                memcpy(counters + j, nonce_counter, 16);
+                for (i = 16; i > 0; i--) {
+                    if (++nonce_counter[i - 1] != 0) {
+                        break;
+                    }
+                }
+            }
+
+            mbedtls_aesni_crypt_ecb8(ctx, MBEDTLS_AES_ENCRYPT, counters, stream);
+
+            for (j = 0; j < AES_AESNI_BULK_LEN; j++) {
+                output[j] = (unsigned char) (input[j] ^ stream[j]);
+            }
+
+            input  += AES_AESNI_BULK_LEN;
+            output += AES_AESNI_BULK_LEN;
+            length -= AES_AESNI_BULK_LEN;
+        }
+
+        /* As if the last block had gone through the loop below */
+        memcpy(stream_block, stream + AES_AESNI_BULK_LEN - 16, 16);
+        mbedtls_platform_zeroize(stream, sizeof(stream));
+    }
+#endif /* MBEDTLS_AESNI_HAVE_CODE */
+
     while (length--) {
         if (n == 0) {
             ret = mbedtls_aes_crypt_ecb(ctx, MBEDTLS_AES_ENCRYPT, nonce_counter, stream_block);
@@ -105,6 +105,64 @@ int mbedtls_aesni_crypt_ecb(mbedtls_aes_context *ctx,
     return 0;
 }
 
+/*
+ * AES-NI AES-ECB en(de)cryption of 8 blocks, rounds interleaved
+ *
+ * The round keys are loaded unaligned: callers outside aes.c do not
+ * realign the context.
+ */
+void mbedtls_aesni_crypt_ecb8(mbedtls_aes_context *ctx,
+                              int mode,
+                              const unsigned char input[128],
+                              unsigned char output[128])
+{
+    const unsigned char *rk = (const unsigned char *) ctx->rk;
+    unsigned nr = ctx->nr; // Number of remaining rounds
+    __m128i key, s[8];
+    int i;
+
+    // Round 0
+    key = _mm_loadu_si128((const __m128i *) rk);
+    for (i = 0; i < 8; i++) {
+        s[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (input + 16 * i)),
+                             key);
+    }
+    rk += 16;
+    --nr;
+
+    if (mode == 0) {
+        while (nr != 0) {
+            key = _mm_loadu_si128((const __m128i *) rk);
+            for (i = 0; i < 8; i++) {
+                s[i] = _mm_aesdec_si128(s[i], key);
+            }
+            rk += 16;
+            --nr;
+        }
+        key = _mm_loadu_si128((const __m128i *) rk);
+        for (i = 0; i < 8; i++) {
+            s[i] = _mm_aesdeclast_si128(s[i], key);
+        }
+    } else {
+        while (nr != 0) {
+            key = _mm_loadu_si128((const __m128i *) rk);
+            for (i = 0; i < 8; i++) {
+                s[i] = _mm_aesenc_si128(s[i], key);
+            }
+            rk += 16;
+            --nr;
+        }
+        key = _mm_loadu_si128((const __m128i *) rk);
+        for (i = 0; i < 8; i++) {
+            s[i] = _mm_aesenclast_si128(s[i], key);
+        }
+    }
+
+    for (i = 0; i < 8; i++) {
+        _mm_storeu_si128((__m128i *) (output + 16 * i), s[i]);
+    }
+}
+
 /*
  * GCM multiplication: c = a times b in GF(2^128)
  * Based on [CLMUL-WP] algorithms 1 (with equation 27) and 5.
@@ -206,6 +264,105 @@ void mbedtls_aesni_gcm_mult(unsigned char c[16],
     return;
 }
 
+/*
+ * Reverse the 16 bytes of a block. PSHUFB would do it in one instruction,
+ * but it needs SSSE3, which is not implied by the AES-NI target flags.
+ */
+static __m128i gcm_bswap(__m128i xx)
+{
+    xx = _mm_shuffle_epi32(xx, 0x1B);             // reverse the 32-bit words
+    xx = _mm_shufflelo_epi16(xx, 0xB1);           // the 16-bit halves of each
+    xx = _mm_shufflehi_epi16(xx, 0xB1);
+    return _mm_or_si128(_mm_slli_epi16(xx, 8),    // and the bytes of each half
+                        _mm_srli_epi16(xx, 8));
+}
+
+/*
+ * AES-GCM en(de)cryption of groups of 4 blocks: rounds 1 to 4 each come
+ * with the multiplication of one hashed block by its power of H, and the
+ * sum of the 4 products is reduced once.
+ */
+void mbedtls_aesni_gcm_crypt4(mbedtls_aes_context *ctx,
+                              const unsigned char htable[64],
+                              unsigned char y[16],
+                              unsigned char x[16],
+                              size_t groups,
+                              const unsigned char *input,
+                              unsigned char *output,
+                              const unsigned char *hashed)
+{
+    const __m128i one = _mm_set_epi32(0, 0, 0, 1);
+    __m128i ctr, acc;
+
+    /* Byte-reversed, the 32-bit counter of y is the low word */
+    ctr = gcm_bswap(_mm_loadu_si128((const __m128i *) y));
+    acc = gcm_bswap(_mm_loadu_si128((const __m128i *) x));
+
+    for (; groups != 0; groups--) {
+        const unsigned char *rk = (const unsigned char *) ctx->rk;
+        unsigned nr = ctx->nr; // Number of remaining rounds
+        __m128i key, s[4], cc, dd, lo, hi;
+        int i, j;
+
+        // Round 0 of the next 4 counter blocks
+        key = _mm_loadu_si128((const __m128i *) rk);
+        for (i = 0; i < 4; i++) {
+            ctr = _mm_add_epi32(ctr, one);
+            s[i] = _mm_xor_si128(gcm_bswap(ctr), key);
+        }
+        rk += 16;
+        --nr;
+
+        // Rounds 1 to 4, stitched with the GHASH of the 4 hashed blocks
+        lo = _mm_setzero_si128();
+        hi = _mm_setzero_si128();
+        for (j = 0; j < 4; j++) {
+            key = _mm_loadu_si128((const __m128i *) rk);
+            for (i = 0; i < 4; i++) {
+                s[i] = _mm_aesenc_si128(s[i], key);
+            }
+            rk += 16;
+            --nr;
+
+            cc = gcm_bswap(_mm_loadu_si128((const __m128i *) (hashed + 16 * j)));
+            if (j == 0) {
+                cc = _mm_xor_si128(cc, acc);
+            }
+            gcm_clmul(cc, _mm_loadu_si128((const __m128i *) (htable + 16 * j)),
+                      &cc, &dd);
+            lo = _mm_xor_si128(lo, cc);
+            hi = _mm_xor_si128(hi, dd);
+        }
+
+        // One reduction for the sum of the 4 products
+        gcm_shift(&lo, &hi);
+        acc = _mm_xor_si128(gcm_mix(gcm_reduce(lo)), hi);
+
+        while (nr != 0) {
+            key = _mm_loadu_si128((const __m128i *) rk);
+            for (i = 0; i < 4; i++) {
+                s[i] = _mm_aesenc_si128(s[i], key);
+            }
+            rk += 16;
+            --nr;
+        }
+
+        key = _mm_loadu_si128((const __m128i *) rk);
+        for (i = 0; i < 4; i++) {
+            cc = _mm_loadu_si128((const __m128i *) (input + 16 * i));
+            cc = _mm_xor_si128(_mm_aesenclast_si128(s[i], key), cc);
+            _mm_storeu_si128((__m128i *) (output + 16 * i), cc);
+        }
+
+        input += 64;
+        output += 64;
+        hashed += 64;
+    }
+
+    _mm_storeu_si128((__m128i *) y, gcm_bswap(ctr));
+    _mm_storeu_si128((__m128i *) x, gcm_bswap(acc));
+}
+
 /*
  * Compute decryption round keys from encryption round keys
  */
@@ -418,6 +575,30 @@ static void aesni_setkey_enc_256(unsigned char *rk_bytes,
 #define xmm0_xmm4   "0xE0"
 #define xmm1_xmm0   "0xC1"
 #define xmm1_xmm2   "0xD1"
+#define xmm4_xmm0   "0xC4"
+#define xmm4_xmm1   "0xCC"
+#define xmm4_xmm2   "0xD4"
+#define xmm4_xmm3   "0xDC"
+#define xmm6_xmm5   "0xEE"
+#define xmm6_xmm7   "0xFE"
+
+/*
+ * The same instructions with xmm8 as the source operand, which takes a
+ * REX.B prefix (0x41) before the opcode. The destination stays below xmm8.
+ */
+#define AESDEC_X8(regs)      ".byte 0x66,0x41,0x0F,0x38,0xDE," regs "\n\t"
+#define AESDECLAST_X8(regs)  ".byte 0x66,0x41,0x0F,0x38,0xDF," regs "\n\t"
+#define AESENC_X8(regs)      ".byte 0x66,0x41,0x0F,0x38,0xDC," regs "\n\t"
+#define AESENCLAST_X8(regs)  ".byte 0x66,0x41,0x0F,0x38,0xDD," regs "\n\t"
+
+#define xmm8_xmm0   "0xC0"
+#define xmm8_xmm1   "0xC8"
+#define xmm8_xmm2   "0xD0"
+#define xmm8_xmm3   "0xD8"
+#define xmm8_xmm4   "0xE0"
+#define xmm8_xmm5   "0xE8"
+#define xmm8_xmm6   "0xF0"
+#define xmm8_xmm7   "0xF8"
 
 /*
  * AES-NI AES-ECB block en(de)cryption
@@ -464,6 +645,101 @@ int mbedtls_aesni_crypt_ecb(mbedtls_aes_context *ctx,
     return 0;
 }
 
+/*
+ * AES-NI AES-ECB en(de)cryption of 8 blocks, rounds interleaved
+ */
+void mbedtls_aesni_crypt_ecb8(mbedtls_aes_context *ctx,
+                              int mode,
+                              const unsigned char input[128],
+                              unsigned char output[128])
+{
+    unsigned nr = ctx->nr;
+    const uint32_t *rk = ctx->rk;
+
+    asm volatile ("movdqu    (%1), %%xmm8    \n\t" // load round key 0
+                  "movdqu    0(%3), %%xmm0   \n\t" // load input
+                  "movdqu    16(%3), %%xmm1  \n\t"
+                  "movdqu    32(%3), %%xmm2  \n\t"
+                  "movdqu    48(%3), %%xmm3  \n\t"
+                  "movdqu    64(%3), %%xmm4  \n\t"
+                  "movdqu    80(%3), %%xmm5  \n\t"
+                  "movdqu    96(%3), %%xmm6  \n\t"
+                  "movdqu    112(%3), %%xmm7 \n\t"
+                  "pxor      %%xmm8, %%xmm0  \n\t" // round 0
+                  "pxor      %%xmm8, %%xmm1  \n\t"
+                  "pxor      %%xmm8, %%xmm2  \n\t"
+                  "pxor      %%xmm8, %%xmm3  \n\t"
+                  "pxor      %%xmm8, %%xmm4  \n\t"
+                  "pxor      %%xmm8, %%xmm5  \n\t"
+                  "pxor      %%xmm8, %%xmm6  \n\t"
+                  "pxor      %%xmm8, %%xmm7  \n\t"
+                  "add       $16, %1         \n\t" // point to next round key
+                  "subl      $1, %0          \n\t" // normal rounds = nr - 1
+                  "test      %2, %2          \n\t" // mode?
+                  "jz        2f              \n\t" // 0 = decrypt
+
+                  "1:                        \n\t" // encryption loop
+                  "movdqu    (%1), %%xmm8    \n\t" // load round key
+                  AESENC_X8(xmm8_xmm0)             // do round on all blocks
+                  AESENC_X8(xmm8_xmm1)
+                  AESENC_X8(xmm8_xmm2)
+                  AESENC_X8(xmm8_xmm3)
+                  AESENC_X8(xmm8_xmm4)
+                  AESENC_X8(xmm8_xmm5)
+                  AESENC_X8(xmm8_xmm6)
+                  AESENC_X8(xmm8_xmm7)
+                  "add       $16, %1         \n\t" // point to next round key
+                  "subl      $1, %0          \n\t" // loop
+                  "jnz       1b              \n\t"
+                  "movdqu    (%1), %%xmm8    \n\t" // load round key
+                  AESENCLAST_X8(xmm8_xmm0)         // last round
+                  AESENCLAST_X8(xmm8_xmm1)
+                  AESENCLAST_X8(xmm8_xmm2)
+                  AESENCLAST_X8(xmm8_xmm3)
+                  AESENCLAST_X8(xmm8_xmm4)
+                  AESENCLAST_X8(xmm8_xmm5)
+                  AESENCLAST_X8(xmm8_xmm6)
+                  AESENCLAST_X8(xmm8_xmm7)
+                  "jmp       3f              \n\t"
+
+                  "2:                        \n\t" // decryption loop
+                  "movdqu    (%1), %%xmm8    \n\t"
+                  AESDEC_X8(xmm8_xmm0)
+                  AESDEC_X8(xmm8_xmm1)
+                  AESDEC_X8(xmm8_xmm2)
+                  AESDEC_X8(xmm8_xmm3)
+                  AESDEC_X8(xmm8_xmm4)
+                  AESDEC_X8(xmm8_xmm5)
+                  AESDEC_X8(xmm8_xmm6)
+                  AESDEC_X8(xmm8_xmm7)
+                  "add       $16, %1         \n\t"
+                  "subl      $1, %0          \n\t"
+                  "jnz       2b              \n\t"
+                  "movdqu    (%1), %%xmm8    \n\t" // load round key
+                  AESDECLAST_X8(xmm8_xmm0)         // last round
+                  AESDECLAST_X8(xmm8_xmm1)
+                  AESDECLAST_X8(xmm8_xmm2)
+                  AESDECLAST_X8(xmm8_xmm3)
+                  AESDECLAST_X8(xmm8_xmm4)
+                  AESDECLAST_X8(xmm8_xmm5)
+                  AESDECLAST_X8(xmm8_xmm6)
+                  AESDECLAST_X8(xmm8_xmm7)
+
+                  "3:                        \n\t"
+                  "movdqu    %%xmm0, 0(%4)   \n\t" // export output
+                  "movdqu    %%xmm1, 16(%4)  \n\t"
+                  "movdqu    %%xmm2, 32(%4)  \n\t"
+                  "movdqu    %%xmm3, 48(%4)  \n\t"
+                  "movdqu    %%xmm4, 64(%4)  \n\t"
+                  "movdqu    %%xmm5, 80(%4)  \n\t"
+                  "movdqu    %%xmm6, 96(%4)  \n\t"
+                  "movdqu    %%xmm7, 112(%4) \n\t"
+                  : "+r" (nr), "+r" (rk)
+                  : "r" (mode), "r" (input), "r" (output)
+                  : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+                  "xmm5", "xmm6", "xmm7", "xmm8");
+}
+
 /*
  * GCM multiplication: c = a times b in GF(2^128)
  * Based on [CLMUL-WP] algorithms 1 (with equation 27) and 5.
@@ -576,6 +852,225 @@ void mbedtls_aesni_gcm_mult(unsigned char c[16],
     return;
 }
 
+/*
+ * One AES round on the 4 blocks of xmm0 to xmm3, with the round key at %4
+ */
+#define GCM4_ROUND                                                         \
+    "movdqu    (%4), %%xmm4         \n\t" /* load round key */            \
+    AESENC(xmm4_xmm0)                                                      \
+    AESENC(xmm4_xmm1)                                                      \
+    AESENC(xmm4_xmm2)                                                      \
+    AESENC(xmm4_xmm3)                                                      \
+    "add       $16, %4              \n\t" /* point to next round key */
+
+/*
+ * Load hashed block number n into xmm5, byte-reversed, and the matching
+ * power of H into xmm6
+ */
+#define GCM4_LOAD(n)                                                       \
+    "movdqu    " #n "*16(%3), %%xmm5 \n\t"                                 \
+    "pshufb    %%xmm14, %%xmm5      \n\t"                                 \
+    "movdqu    " #n "*16(%10), %%xmm6 \n\t"
+
+/*
+ * Add the product xmm5 * xmm6 to xmm10:xmm9, leaving the middle terms in
+ * xmm11 ([CLMUL-WP] algorithm 1 without its last steps)
+ */
+#define GCM4_MUL                                                           \
+    "movdqa    %%xmm5, %%xmm7       \n\t"                                 \
+    PCLMULQDQ(xmm6_xmm7, "0x00")          /* a0*b0 = c1:c0 */             \
+    "pxor      %%xmm7, %%xmm9       \n\t"                                 \
+    "movdqa    %%xmm5, %%xmm7       \n\t"                                 \
+    PCLMULQDQ(xmm6_xmm7, "0x11")          /* a1*b1 = d1:d0 */             \
+    "pxor      %%xmm7, %%xmm10      \n\t"                                 \
+    "movdqa    %%xmm5, %%xmm7       \n\t"                                 \
+    PCLMULQDQ(xmm6_xmm7, "0x10")          /* a0*b1 = e1:e0 */             \
+    PCLMULQDQ(xmm6_xmm5, "0x01")          /* a1*b0 = f1:f0 */             \
+    "pxor      %%xmm7, %%xmm11      \n\t"                                 \
+    "pxor      %%xmm5, %%xmm11      \n\t"
+
+/*
+ * AES-GCM en(de)cryption of groups of 4 blocks: rounds 1 to 4 each come
+ * with the multiplication of one hashed block by its power of H, and the
+ * sum of the 4 products is reduced once.
+ *
+ * Only the AES-NI and PCLMULQDQ instructions are byte-encoded; the others
+ * are known to gas even where they need a REX prefix for xmm8 to xmm15.
+ * Registers: xmm0-3 blocks, xmm4 round key, xmm5-8 scratch, xmm11:xmm10:xmm9
+ * product sum, xmm12 counter, xmm13 counter increment, xmm14 byte reversal
+ * mask, xmm15 GHASH value.
+ */
+void mbedtls_aesni_gcm_crypt4(mbedtls_aes_context *ctx,
+                              const unsigned char htable[64],
+                              unsigned char y[16],
+                              unsigned char x[16],
+                              size_t groups,
+                              const unsigned char *input,
+                              unsigned char *output,
+                              const unsigned char *hashed)
+{
+    static const unsigned char bswap_mask[16] = {
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+    };
+    static const unsigned char one[16] = { 1 };
+    const uint32_t *rk;
+    size_t rounds;
+
+    if (groups == 0) {
+        return;
+    }
+
+    asm volatile ("movdqu    %8, %%xmm14     \n\t" // byte reversal mask
+                  "movdqu    %9, %%xmm13     \n\t" // 1 in the low word
+                  "movdqu    %6, %%xmm12     \n\t" // counter block
+                  "pshufb    %%xmm14, %%xmm12 \n\t" // counter in the low word
+                  "movdqu    %7, %%xmm15     \n\t" // GHASH value
+                  "pshufb    %%xmm14, %%xmm15 \n\t"
+
+                  "1:                        \n\t" // loop on groups
+                  "mov       %11, %4         \n\t" // round key 0
+                  "mov       %12, %5         \n\t" // rounds after round 4
+                  "paddd     %%xmm13, %%xmm12 \n\t" // next 4 counter blocks
+                  "movdqa    %%xmm12, %%xmm0 \n\t"
+                  "pshufb    %%xmm14, %%xmm0 \n\t"
+                  "paddd     %%xmm13, %%xmm12 \n\t"
+                  "movdqa    %%xmm12, %%xmm1 \n\t"
+                  "pshufb    %%xmm14, %%xmm1 \n\t"
+                  "paddd     %%xmm13, %%xmm12 \n\t"
+                  "movdqa    %%xmm12, %%xmm2 \n\t"
+                  "pshufb    %%xmm14, %%xmm2 \n\t"
+                  "paddd     %%xmm13, %%xmm12 \n\t"
+                  "movdqa    %%xmm12, %%xmm3 \n\t"
+                  "pshufb    %%xmm14, %%xmm3 \n\t"
+                  "movdqu    (%4), %%xmm4    \n\t" // round 0
+                  "pxor      %%xmm4, %%xmm0  \n\t"
+                  "pxor      %%xmm4, %%xmm1  \n\t"
+                  "pxor      %%xmm4, %%xmm2  \n\t"
+                  "pxor      %%xmm4, %%xmm3  \n\t"
+                  "add       $16, %4         \n\t"
+                  "pxor      %%xmm9, %%xmm9  \n\t" // clear the product sum
+                  "pxor      %%xmm10, %%xmm10 \n\t"
+                  "pxor      %%xmm11, %%xmm11 \n\t"
+
+                  GCM4_ROUND                       // round 1
+                  GCM4_LOAD(0)                     // (x + block 0) * H^4
+                  "pxor      %%xmm15, %%xmm5 \n\t"
+                  GCM4_MUL
+                  GCM4_ROUND                       // round 2
+                  GCM4_LOAD(1)                     // block 1 * H^3
+                  GCM4_MUL
+                  GCM4_ROUND                       // round 3
+                  GCM4_LOAD(2)                     // block 2 * H^2
+                  GCM4_MUL
+                  GCM4_ROUND                       // round 4
+                  GCM4_LOAD(3)                     // block 3 * H
+                  GCM4_MUL
+
+                  /*
+                   * Fold the middle terms into xmm10:xmm9, shift it one bit
+                   * to the left and reduce it into xmm15, as in
+                   * mbedtls_aesni_gcm_mult()
+                   */
+                  "movdqa    %%xmm11, %%xmm7 \n\t" // e1+f1:e0+f0
+                  "psrldq    $8, %%xmm11     \n\t" // 0:e1+f1
+                  "pslldq    $8, %%xmm7      \n\t" // e0+f0:0
+                  "pxor      %%xmm11, %%xmm10 \n\t" // d1:d0+e1+f1
+                  "pxor      %%xmm7, %%xmm9  \n\t" // c1+e0+f0:c0
+
+                  "movdqa    %%xmm9, %%xmm5  \n\t" // r1:r0
+                  "movdqa    %%xmm10, %%xmm6 \n\t" // r3:r2
+                  "psllq     $1, %%xmm9      \n\t" // r1<<1:r0<<1
+                  "psllq     $1, %%xmm10     \n\t" // r3<<1:r2<<1
+                  "psrlq     $63, %%xmm5     \n\t" // r1>>63:r0>>63
+                  "psrlq     $63, %%xmm6     \n\t" // r3>>63:r2>>63
+                  "movdqa    %%xmm5, %%xmm7  \n\t" // r1>>63:r0>>63
+                  "pslldq    $8, %%xmm5      \n\t" // r0>>63:0
+                  "pslldq    $8, %%xmm6      \n\t" // r2>>63:0
+                  "psrldq    $8, %%xmm7      \n\t" // 0:r1>>63
+                  "por       %%xmm5, %%xmm9  \n\t" // r1<<1|r0>>63:r0<<1
+                  "por       %%xmm6, %%xmm10 \n\t" // r3<<1|r2>>62:r2<<1
+                  "por       %%xmm7, %%xmm10 \n\t" // r3<<1|r2>>62:r2<<1|r1>>63
+
+                  "movdqa    %%xmm9, %%xmm5  \n\t" // x1:x0
+                  "movdqa    %%xmm9, %%xmm6  \n\t" // same
+                  "movdqa    %%xmm9, %%xmm7  \n\t" // same
+                  "psllq     $63, %%xmm5     \n\t" // x1<<63:x0<<63 = stuff:a
+                  "psllq     $62, %%xmm6     \n\t" // x1<<62:x0<<62 = stuff:b
+                  "psllq     $57, %%xmm7     \n\t" // x1<<57:x0<<57 = stuff:c
+                  "pxor      %%xmm6, %%xmm5  \n\t" // stuff:a+b
+                  "pxor      %%xmm7, %%xmm5  \n\t" // stuff:a+b+c
+                  "pslldq    $8, %%xmm5      \n\t" // a+b+c:0
+                  "pxor      %%xmm5, %%xmm9  \n\t" // x1+a+b+c:x0 = d:x0
+
+                  "movdqa    %%xmm9, %%xmm15 \n\t" // d:x0
+                  "movdqa    %%xmm9, %%xmm6  \n\t" // same
+                  "movdqa    %%xmm9, %%xmm7  \n\t" // same
+                  "psrlq     $1, %%xmm15     \n\t" // e1:x0>>1 = e1:e0'
+                  "psrlq     $2, %%xmm6      \n\t" // f1:x0>>2 = f1:f0'
+                  "psrlq     $7, %%xmm7      \n\t" // g1:x0>>7 = g1:g0'
+                  "pxor      %%xmm6, %%xmm15 \n\t" // e1+f1:e0'+f0'
+                  "pxor      %%xmm7, %%xmm15 \n\t" // e1+f1+g1:e0'+f0'+g0'
+                  "movdqa    %%xmm9, %%xmm5  \n\t" // d:x0
+                  "movdqa    %%xmm9, %%xmm6  \n\t" // same
+                  "movdqa    %%xmm9, %%xmm7  \n\t" // same
+                  "psllq     $63, %%xmm5     \n\t" // d<<63:stuff
+                  "psllq     $62, %%xmm6     \n\t" // d<<62:stuff
+                  "psllq     $57, %%xmm7     \n\t" // d<<57:stuff
+                  "pxor      %%xmm6, %%xmm5  \n\t" // d<<63+d<<62:stuff
+                  "pxor      %%xmm7, %%xmm5  \n\t" // missing bits of d:stuff
+                  "psrldq    $8, %%xmm5      \n\t" // 0:missing bits of d
+                  "pxor      %%xmm5, %%xmm15 \n\t" // e1+f1+g1:e0+f0+g0
+                  "pxor      %%xmm9, %%xmm15 \n\t" // h1:h0
+                  "pxor      %%xmm10, %%xmm15 \n\t" // x3+h1:x2+h0
+
+                  "2:                        \n\t" // remaining rounds
+                  GCM4_ROUND
+                  "sub       $1, %5          \n\t"
+                  "jnz       2b              \n\t"
+                  "movdqu    (%4), %%xmm4    \n\t" // last round
+                  AESENCLAST(xmm4_xmm0)
+                  AESENCLAST(xmm4_xmm1)
+                  AESENCLAST(xmm4_xmm2)
+                  AESENCLAST(xmm4_xmm3)
+
+                  "movdqu    0(%1), %%xmm5   \n\t" // output = input + key stream
+                  "movdqu    16(%1), %%xmm6  \n\t"
+                  "movdqu    32(%1), %%xmm7  \n\t"
+                  "movdqu    48(%1), %%xmm8  \n\t"
+                  "pxor      %%xmm5, %%xmm0  \n\t"
+                  "pxor      %%xmm6, %%xmm1  \n\t"
+                  "pxor      %%xmm7, %%xmm2  \n\t"
+                  "pxor      %%xmm8, %%xmm3  \n\t"
+                  "movdqu    %%xmm0, 0(%2)   \n\t"
+                  "movdqu    %%xmm1, 16(%2)  \n\t"
+                  "movdqu    %%xmm2, 32(%2)  \n\t"
+                  "movdqu    %%xmm3, 48(%2)  \n\t"
+
+                  "add       $64, %1         \n\t" // next group
+                  "add       $64, %2         \n\t"
+                  "add       $64, %3         \n\t"
+                  "sub       $1, %0          \n\t"
+                  "jnz       1b              \n\t"
+
+                  "pshufb    %%xmm14, %%xmm12 \n\t" // export counter block
+                  "movdqu    %%xmm12, %6     \n\t"
+                  "pshufb    %%xmm14, %%xmm15 \n\t" // export GHASH value
+                  "movdqu    %%xmm15, %7     \n\t"
+                  : "+r" (groups), "+r" (input), "+r" (output), "+r" (hashed),
+                  "=&r" (rk), "=&r" (rounds),
+                  "+m" (*(unsigned char (*)[16]) y),
+                  "+m" (*(unsigned char (*)[16]) x)
+                  : "m" (bswap_mask), "m" (one), "r" (htable), "r" (ctx->rk),
+                  "r" ((size_t) ctx->nr - 5)
+                  : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+                  "xmm5", "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11",
+                  "xmm12", "xmm13", "xmm14", "xmm15");
+}
+
+#undef GCM4_ROUND
+#undef GCM4_LOAD
+#undef GCM4_MUL
+
 /*
  * Compute decryption round keys from encryption round keys
  */
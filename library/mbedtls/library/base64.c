@@ -10,17 +10,337 @@
 #if defined(MBEDTLS_BASE64_C)
 
 #include "mbedtls/base64.h"
+#include "mbedtls/platform_util.h"
 #include "constant_time_internal.h"
 
 #include <stdint.h>
+#include <string.h>
 
 #if defined(MBEDTLS_SELF_TEST)
-#include <string.h>
 #include "mbedtls/platform.h"
 #endif /* MBEDTLS_SELF_TEST */
 
 #define BASE64_SIZE_T_MAX   ((size_t) -1)   /* SIZE_T_MAX is not standard */
 
+/*
+ * On x86 and x86-64, whole blocks of 12 bytes / 16 digits (SSSE3) or
+ * 24 bytes / 32 digits (AVX2) are converted with vector instructions,
+ * following W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding
+ * using AVX2 Instructions". Like mbedtls_ct_base64_enc_char() and
+ * mbedtls_ct_base64_dec_value(), the block code uses no secret-dependent
+ * memory accesses or branches: the only branch is on whether a block
+ * consists of digits only. Everything else, including the end of the
+ * data, line breaks and padding, goes through the byte-wise code.
+ *
+ * GCC-like compilers build the block code with target attributes, so the
+ * library needs no -mssse3 or -mavx2; the instruction set is picked at
+ * runtime with CPUID.
+ */
+#if defined(__GNUC__) && (defined(__clang__) || __GNUC__ >= 5) && \
+    (defined(__amd64__) || defined(__x86_64__) || defined(__i386__))
+#define BASE64_HAVE_SIMD
+#define BASE64_TARGET(isa) __attribute__((target(isa)))
+#include <cpuid.h>
+#include <immintrin.h>
+/* *INDENT-OFF* */
+#ifndef asm
+#define asm __asm
+#endif
+/* *INDENT-ON* */
+#elif defined(_MSC_VER) && \
+    (defined(_M_X64) || defined(_M_IX86)) && !defined(_M_ARM64EC)
+#define BASE64_HAVE_SIMD
+#define BASE64_TARGET(isa)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#if defined(BASE64_HAVE_SIMD)
+
+#define BASE64_SIMD_SSSE3   1
+#define BASE64_SIMD_AVX2    2
+
+static void base64_cpuid(unsigned int info[4], unsigned int leaf)
+{
+#if defined(_MSC_VER)
+    __cpuidex((int *) info, (int) leaf, 0);
+#else
+    __cpuid_count(leaf, 0, info[0], info[1], info[2], info[3]);
+#endif
+}
+
+/*
+ * SSSE3/AVX2 support detection routine (CPUID leaf 1: ECX bit 9 is SSSE3,
+ * bits 27 and 28 OSXSAVE and AVX; leaf 7: EBX bit 5 is AVX2; XCR0 bits 1
+ * and 2 tell whether the OS saves the YMM registers)
+ */
+static int base64_simd_level(void)
+{
+    static int done = 0;
+    static int level = 0;
+
+    if (!done) {
+        unsigned int info[4] = { 0, 0, 0, 0 };
+        unsigned int max_leaf, xcr0;
+
+        base64_cpuid(info, 0);
+        max_leaf = info[0];
+
+        base64_cpuid(info, 1);
+        if (info[2] & (1U << 9)) {
+            level = BASE64_SIMD_SSSE3;
+        }
+
+        if (max_leaf >= 7 &&
+            (info[2] & (1U << 27)) != 0 && (info[2] & (1U << 28)) != 0) {
+#if defined(_MSC_VER)
+            xcr0 = (unsigned int) _xgetbv(0);
+#else
+            unsigned int edx;
+            asm volatile (".byte 0x0f, 0x01, 0xd0"     /* xgetbv */
+                          : "=a" (xcr0), "=d" (edx) : "c" (0));
+            (void) edx;
+#endif
+            base64_cpuid(info, 7);
+            if ((xcr0 & 6) == 6 && (info[1] & (1U << 5)) != 0) {
+                level = BASE64_SIMD_AVX2;
+            }
+        }
+        done = 1;
+    }
+
+    return level;
+}
+
+/*
+ * Map 16 6-bit values to digits: compute an index into a table of offsets
+ * (0 for 'a'..'z', 1..10 for '0'..'9', 11 for '+', 12 for '/', 13 for
+ * 'A'..'Z') and add the offset to the value.
+ */
+#define BASE64_ENC_LUT                                                  \
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,         \
+    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,         \
+    '/' - 63, 'A', 0, 0
+
+/* Bytes 3k..3k+2 of a block to 32-bit lane k, as 16-bit pairs (b1 b0 b2 b1) */
+#define BASE64_ENC_SHUF                                                 \
+    1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+
+/* Validity of a character from its low (LO) and high (HI) nibble: a
+ * character is a digit if and only if LO[low] & HI[high] is 0. ROLL, indexed
+ * by the high nibble, less 1 for '/', is the offset from digit to value. */
+#define BASE64_DEC_LO                                                   \
+    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,                     \
+    0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+#define BASE64_DEC_HI                                                   \
+    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,                     \
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+#define BASE64_DEC_ROLL                                                 \
+    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+
+/* The 3 bytes of 32-bit lane k of a decoded block to bytes 3k..3k+2 */
+#define BASE64_DEC_SHUF                                                 \
+    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+
+/*
+ * Encode 12-byte blocks while 16 bytes of input can be loaded.
+ * Returns the number of bytes encoded, a multiple of 12.
+ */
+BASE64_TARGET("ssse3")
+static size_t base64_encode_ssse3(unsigned char *dst,
+                                  const unsigned char *src, size_t slen)
+{
+    const __m128i shuf = _mm_setr_epi8(BASE64_ENC_SHUF);
+    const __m128i lut = _mm_setr_epi8(BASE64_ENC_LUT);
+    size_t i;
+
+    for (i = 0; slen - i >= 16; i += 12, dst += 16) {
+        __m128i in, t0, t1, idx, res;
+
+        in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (src + i)),
+                              shuf);
+
+        /* Split each 24-bit group into four 6-bit values, one per byte */
+        t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+                             _mm_set1_epi32(0x04000040));
+        t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+                             _mm_set1_epi32(0x01000010));
+        idx = _mm_or_si128(t0, t1);
+
+        res = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+        res = _mm_or_si128(res,
+                           _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx),
+                                         _mm_set1_epi8(13)));
+        res = _mm_add_epi8(_mm_shuffle_epi8(lut, res), idx);
+
+        _mm_storeu_si128((__m128i *) dst, res);
+    }
+
+    return i;
+}
+
+/*
+ * Encode 24-byte blocks while 28 bytes of input can be loaded.
+ * Returns the number of bytes encoded, a multiple of 24.
+ */
+BASE64_TARGET("avx2")
+static size_t base64_encode_avx2(unsigned char *dst,
+                                 const unsigned char *src, size_t slen)
+{
+    const __m256i shuf = _mm256_setr_epi8(BASE64_ENC_SHUF, BASE64_ENC_SHUF);
+    const __m256i lut = _mm256_setr_epi8(BASE64_ENC_LUT, BASE64_ENC_LUT);
+    size_t i;
+
+    for (i = 0; slen - i >= 28; i += 24, dst += 32) {
+        __m256i in, t0, t1, idx, res;
+
+        in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) (src + i))),
+            _mm_loadu_si128((const __m128i *) (src + i + 12)), 1);
+        in = _mm256_shuffle_epi8(in, shuf);
+
+        t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+                                _mm256_set1_epi32(0x04000040));
+        t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+                                _mm256_set1_epi32(0x01000010));
+        idx = _mm256_or_si256(t0, t1);
+
+        res = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+        res = _mm256_or_si256(res,
+                              _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx),
+                                               _mm256_set1_epi8(13)));
+        res = _mm256_add_epi8(_mm256_shuffle_epi8(lut, res), idx);
+
+        _mm256_storeu_si256((__m256i *) dst, res);
+    }
+
+    return i;
+}
+
+/*
+ * Decode 16-digit blocks, up to the first block that holds anything else
+ * than digits. Returns the number of digits decoded, a multiple of 16.
+ */
+BASE64_TARGET("ssse3")
+static size_t base64_decode_ssse3(unsigned char *dst,
+                                  const unsigned char *src, size_t slen)
+{
+    const __m128i lut_lo = _mm_setr_epi8(BASE64_DEC_LO);
+    const __m128i lut_hi = _mm_setr_epi8(BASE64_DEC_HI);
+    const __m128i lut_roll = _mm_setr_epi8(BASE64_DEC_ROLL);
+    const __m128i shuf = _mm_setr_epi8(BASE64_DEC_SHUF);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    size_t i;
+
+    for (i = 0; slen - i >= 16; i += 16, dst += 12) {
+        __m128i in, hi, lo, bad;
+        uint32_t last;
+
+        in = _mm_loadu_si128((const __m128i *) (src + i));
+        hi = _mm_and_si128(_mm_srli_epi32(in, 4), nibble);
+        lo = _mm_and_si128(in, nibble);
+        bad = _mm_and_si128(_mm_shuffle_epi8(lut_lo, lo),
+                            _mm_shuffle_epi8(lut_hi, hi));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(bad, _mm_setzero_si128())) != 0xFFFF) {
+            break;
+        }
+
+        hi = _mm_add_epi8(hi, _mm_cmpeq_epi8(in, _mm_set1_epi8('/')));
+        in = _mm_add_epi8(in, _mm_shuffle_epi8(lut_roll, hi));
+
+        /* Pack four 6-bit values into 24 bits per 32-bit lane */
+        in = _mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140));
+        in = _mm_madd_epi16(in, _mm_set1_epi32(0x00011000));
+        in = _mm_shuffle_epi8(in, shuf);
+
+        _mm_storel_epi64((__m128i *) dst, in);
+        last = (uint32_t) _mm_cvtsi128_si32(_mm_srli_si128(in, 8));
+        memcpy(dst + 8, &last, 4);
+    }
+
+    return i;
+}
+
+/*
+ * Decode 32-digit blocks, up to the first block that holds anything else
+ * than digits. Returns the number of digits decoded, a multiple of 32.
+ */
+BASE64_TARGET("avx2")
+static size_t base64_decode_avx2(unsigned char *dst,
+                                 const unsigned char *src, size_t slen)
+{
+    const __m256i lut_lo = _mm256_setr_epi8(BASE64_DEC_LO, BASE64_DEC_LO);
+    const __m256i lut_hi = _mm256_setr_epi8(BASE64_DEC_HI, BASE64_DEC_HI);
+    const __m256i lut_roll = _mm256_setr_epi8(BASE64_DEC_ROLL, BASE64_DEC_ROLL);
+    const __m256i shuf = _mm256_setr_epi8(BASE64_DEC_SHUF, BASE64_DEC_SHUF);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    size_t i;
+
+    for (i = 0; slen - i >= 32; i += 32, dst += 24) {
+        __m256i in, hi, lo, bad;
+
+        in = _mm256_loadu_si256((const __m256i *) (src + i));
+        hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), nibble);
+        lo = _mm256_and_si256(in, nibble);
+        bad = _mm256_and_si256(_mm256_shuffle_epi8(lut_lo, lo),
+                               _mm256_shuffle_epi8(lut_hi, hi));
+        if (!_mm256_testz_si256(bad, bad)) {
+            break;
+        }
+
+        hi = _mm256_add_epi8(hi, _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/')));
+        in = _mm256_add_epi8(in, _mm256_shuffle_epi8(lut_roll, hi));
+
+        in = _mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140));
+        in = _mm256_madd_epi16(in, _mm256_set1_epi32(0x00011000));
+        in = _mm256_shuffle_epi8(in, shuf);
+
+        /* The 12 bytes of each 128-bit half next to each other */
+        in = _mm256_permutevar8x32_epi32(in, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+        _mm_storeu_si128((__m128i *) dst, _mm256_castsi256_si128(in));
+        _mm_storel_epi64((__m128i *) (dst + 16), _mm256_extracti128_si256(in, 1));
+    }
+
+    return i;
+}
+
+/* Encode whole blocks from src, returns the number of bytes encoded */
+static size_t base64_encode_simd(unsigned char *dst,
+                                 const unsigned char *src, size_t slen)
+{
+    int level = base64_simd_level();
+    size_t i = 0;
+
+    if (level >= BASE64_SIMD_AVX2) {
+        i = base64_encode_avx2(dst, src, slen);
+    }
+    if (level >= BASE64_SIMD_SSSE3) {
+        i += base64_encode_ssse3(dst + i / 3 * 4, src + i, slen - i);
+    }
+
+    return i;
+}
+
+/* Decode whole blocks of digits, returns the number of digits decoded */
+static size_t base64_decode_simd(unsigned char *dst,
+                                 const unsigned char *src, size_t slen)
+{
+    int level = base64_simd_level();
+    size_t i = 0;
+
+    if (level >= BASE64_SIMD_AVX2) {
+        i = base64_decode_avx2(dst, src, slen);
+    }
+    if (level >= BASE64_SIMD_SSSE3) {
+        i += base64_decode_ssse3(dst + i / 4 * 3, src + i, slen - i);
+    }
+
+    return i;
+}
+
+#endif /* BASE64_HAVE_SIMD */
+
 /*
  * Encode a buffer into base64 format
  */
@@ -52,7 +372,16 @@ int mbedtls_base64_encode(unsigned char *dst, size_t dlen, size_t *olen,
 
     n = (slen / 3) * 3;
 
-    for (i = 0, p = dst; i < n; i += 3) {
+#if defined(BASE64_HAVE_SIMD)
+    i = base64_encode_simd(dst, src, slen);
+    src += i;
+    p = dst + i / 3 * 4;
+#else
+    i = 0;
+    p = dst;
+#endif
+
+    for (; i < n; i += 3) {
         C1 = *src++;
         C2 = *src++;
         C3 = *src++;
@@ -89,20 +418,29 @@ int mbedtls_base64_encode(unsigned char *dst, size_t dlen, size_t *olen,
 }
 
 /*
- * Decode a base64-formatted buffer
+ * Output size for n digits or trailing =, without risk of integer overflow:
+ *     ( ( n * 6 ) + 7 ) >> 3
  */
-int mbedtls_base64_decode(unsigned char *dst, size_t dlen, size_t *olen,
-                          const unsigned char *src, size_t slen)
+static size_t base64_decoded_len(size_t n)
+{
+    return (6 * (n >> 3)) + ((6 * (n & 0x7) + 7) >> 3);
+}
+
+size_t mbedtls_base64_decode_bound(size_t slen)
+{
+    return base64_decoded_len(slen);
+}
+
+/*
+ * Check a base64-formatted buffer and get its decoded length
+ */
+static int base64_check(const unsigned char *src, size_t slen, size_t *olen)
 {
     size_t i; /* index in source */
     size_t n; /* number of digits or trailing = in source */
-    uint32_t x; /* value accumulator */
-    unsigned accumulated_digits = 0;
     unsigned equals = 0;
     int spaces_present = 0;
-    unsigned char *p;
 
-    /* First pass: check for validity and get output length */
     for (i = n = 0; i < slen; i++) {
         /* Skip spaces before checking for EOL */
         spaces_present = 0;
@@ -149,36 +487,81 @@ int mbedtls_base64_decode(unsigned char *dst, size_t dlen, size_t *olen,
         n++;
     }
 
-    if (n == 0) {
-        *olen = 0;
-        return 0;
-    }
+    *olen = n == 0 ? 0 : base64_decoded_len(n) - equals;
 
-    /* The following expression is to calculate the following formula without
-     * risk of integer overflow in n:
-     *     n = ( ( n * 6 ) + 7 ) >> 3;
-     */
-    n = (6 * (n >> 3)) + ((6 * (n & 0x7) + 7) >> 3);
-    n -= equals;
+    return 0;
+}
 
-    if (dst == NULL || dlen < n) {
-        *olen = n;
-        return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
-    }
+/*
+ * Decode a base64-formatted buffer into dst, which is large enough for
+ * any output, checking it on the way
+ */
+static int base64_decode_checked(unsigned char *dst, size_t *olen,
+                                 const unsigned char *src, size_t slen)
+{
+    size_t i; /* index in source */
+    uint32_t x = 0; /* value accumulator */
+    unsigned accumulated_digits = 0;
+    unsigned equals = 0;
+    signed char value;
+    unsigned char *p = dst;
+
+    for (i = 0; i < slen; i++) {
+#if defined(BASE64_HAVE_SIMD)
+        /* Whole blocks of digits at once, e.g. the bulk of a PEM line */
+        if (accumulated_digits == 0 && equals == 0) {
+            size_t k = base64_decode_simd(p, src + i, slen - i);
+
+            p += k / 4 * 3;
+            i += k;
+            if (i == slen) {
+                break;
+            }
+        }
+#endif /* BASE64_HAVE_SIMD */
+
+        /* Spaces are only allowed at the end of a line or of the buffer */
+        if (src[i] == ' ') {
+            while (i < slen && src[i] == ' ') {
+                ++i;
+            }
+
+            if (i == slen) {
+                break;
+            }
+
+            if (src[i] != '\n' &&
+                !((slen - i) >= 2 && src[i] == '\r' && src[i + 1] == '\n')) {
+                goto invalid;
+            }
+        }
 
-    equals = 0;
-    for (x = 0, p = dst; i > 0; i--, src++) {
-        if (*src == '\r' || *src == '\n' || *src == ' ') {
+        if (src[i] == '\n') {
             continue;
         }
 
-        x = x << 6;
-        if (*src == '=') {
-            ++equals;
+        if (src[i] == '\r') {
+            if ((slen - i) >= 2 && src[i + 1] == '\n') {
+                ++i;
+                continue;
+            }
+            goto invalid;
+        }
+
+        if (src[i] == '=') {
+            if (++equals > 2) {
+                goto invalid;
+            }
+            value = 0;
         } else {
-            x |= mbedtls_ct_base64_dec_value(*src);
+            value = mbedtls_ct_base64_dec_value(src[i]);
+            if (equals != 0 || value < 0) {
+                goto invalid;
+            }
         }
 
+        x = (x << 6) | (uint32_t) value;
+
         if (++accumulated_digits == 4) {
             accumulated_digits = 0;
             *p++ = MBEDTLS_BYTE_2(x);
@@ -194,6 +577,40 @@ int mbedtls_base64_decode(unsigned char *dst, size_t dlen, size_t *olen,
     *olen = p - dst;
 
     return 0;
+
+invalid:
+    mbedtls_platform_zeroize(dst, p - dst);
+    return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+}
+
+/*
+ * Decode a base64-formatted buffer
+ */
+int mbedtls_base64_decode(unsigned char *dst, size_t dlen, size_t *olen,
+                          const unsigned char *src, size_t slen)
+{
+    int ret;
+    size_t n;
+
+    /* With room for the largest possible output, decode in a single pass.
+     * Otherwise check the input and its length first. */
+    if (dst == NULL || dlen < mbedtls_base64_decode_bound(slen)) {
+        if ((ret = base64_check(src, slen, &n)) != 0) {
+            return ret;
+        }
+
+        if (n == 0) {
+            *olen = 0;
+            return 0;
+        }
+
+        if (dst == NULL || dlen < n) {
+            *olen = n;
+            return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+        }
+    }
+
+    return base64_decode_checked(dst, olen, src, slen);
 }
 
 #if defined(MBEDTLS_SELF_TEST)
@@ -1386,6 +1386,103 @@ int mbedtls_mpi_sub_int(mbedtls_mpi *X, const mbedtls_mpi *A, mbedtls_mpi_sint b
     return mbedtls_mpi_sub_mpi(X, A, &B);
 }
 
+#if defined(MBEDTLS_HAVE_ASM) && defined(MBEDTLS_HAVE_INT64) && \
+    defined(__GNUC__) && (defined(__amd64__) || defined(__x86_64__))
+/*
+ * On x86-64 CPUs with BMI2 and ADX, mpi_mul_hlp() uses MULX, which doesn't
+ * touch the flags, and two independent carry chains: ADCX (carry flag)
+ * adds the low halves of the products, ADOX (overflow flag) the high halves
+ * of the previous products. Loop control only uses LEA, MOV and JRCXZ so
+ * that both chains survive across iterations.
+ */
+#define MPI_HAVE_MULX_ADX
+
+/*
+ * MULX/ADX support detection routine (CPUID leaf 7: EBX bit 8 is BMI2,
+ * bit 19 is ADX)
+ */
+static int mpi_mulx_adx_has_support(void)
+{
+    static int done = 0;
+    static int supported = 0;
+
+    if (!done) {
+        unsigned int eax, ebx, ecx, edx;
+
+        asm ("cpuid"
+             : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+             : "a" (0), "c" (0));
+        if (eax >= 7) {
+            asm ("cpuid"
+                 : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+                 : "a" (7), "c" (0));
+            supported = (ebx & (1U << 8)) != 0 && (ebx & (1U << 19)) != 0;
+        }
+        done = 1;
+    }
+
+    return supported;
+}
+
+/* One limb: d[j] += lo(b * s[j]) + hi(b * s[j-1]), r8 holds the previous hi */
+#define MULX_ADX_STEP(off)                          \
+    "mulxq  " #off "(%%rsi), %%rax, %%r9  \n\t"     \
+    "movq   " #off "(%%rdi), %%r10        \n\t"     \
+    "adcxq  %%rax, %%r10                  \n\t"     \
+    "adoxq  %%r8, %%r10                   \n\t"     \
+    "movq   %%r10, " #off "(%%rdi)        \n\t"     \
+    "movq   %%r9, %%r8                    \n\t"
+
+/*
+ * d[0..i-1] += s[0..i-1] * b, returns the carry out of d[i-1]
+ */
+static mbedtls_mpi_uint mpi_mul_hlp_mulx_adx(size_t i,
+                                             const mbedtls_mpi_uint *s,
+                                             mbedtls_mpi_uint *d,
+                                             mbedtls_mpi_uint b)
+{
+    mbedtls_mpi_uint c;
+    size_t n4 = i / 4, n1 = i % 4;
+
+    asm volatile (
+        "xorl   %%r8d, %%r8d        \n\t"   /* hi = 0, CF = OF = 0 */
+        "jmp    2f                  \n\t"
+        "1:                         \n\t"   /* 4 limbs at a time */
+        MULX_ADX_STEP(0)
+        MULX_ADX_STEP(8)
+        MULX_ADX_STEP(16)
+        MULX_ADX_STEP(24)
+        "leaq   32(%%rsi), %%rsi    \n\t"
+        "leaq   32(%%rdi), %%rdi    \n\t"
+        "leaq   -1(%%rcx), %%rcx    \n\t"
+        "2:                         \n\t"   /* JRCXZ only has a */
+        "jrcxz  3f                  \n\t"   /* short range, so it */
+        "jmp    1b                  \n\t"   /* only skips a JMP */
+        "3:                         \n\t"
+        "movq   %[n1], %%rcx        \n\t"
+        "jmp    5f                  \n\t"
+        "4:                         \n\t"   /* remaining limbs */
+        MULX_ADX_STEP(0)
+        "leaq   8(%%rsi), %%rsi     \n\t"
+        "leaq   8(%%rdi), %%rdi     \n\t"
+        "leaq   -1(%%rcx), %%rcx    \n\t"
+        "5:                         \n\t"
+        "jrcxz  6f                  \n\t"
+        "jmp    4b                  \n\t"
+        "6:                         \n\t"
+        "movl   $0, %%eax           \n\t"   /* carry = hi + CF + OF */
+        "adcxq  %%rax, %%r8         \n\t"
+        "adoxq  %%rax, %%r8         \n\t"
+        "movq   %%r8, %[c]          \n\t"
+        : [c] "=r" (c), "+c" (n4), "+S" (s), "+D" (d)
+        : [n1] "r" (n1), "d" (b)
+        : "rax", "r8", "r9", "r10", "cc", "memory"
+        );
+
+    return c;
+}
+#endif /* MBEDTLS_HAVE_ASM && MBEDTLS_HAVE_INT64 && __GNUC__ && x86-64 */
+
 /** Helper for mbedtls_mpi multiplication.
  *
  * Add \p b * \p s to \p d.
@@ -1418,6 +1515,14 @@ void mpi_mul_hlp(size_t i,
     mbedtls_mpi_uint c = 0, t = 0;
     (void) t;                   /* Unused in some architectures */
 
+#if defined(MPI_HAVE_MULX_ADX)
+    if (mpi_mulx_adx_has_support()) {
+        c = mpi_mul_hlp_mulx_adx(i, s, d, b);
+        d += i;
+        i = 0;                  /* nothing left for the loops below */
+    }
+#endif /* MPI_HAVE_MULX_ADX */
+
 #if defined(MULADDC_HUIT)
     for (; i >= 8; i -= 8) {
         MULADDC_INIT
@@ -32,6 +32,10 @@
 #define CHACHAPOLY_STATE_CIPHERTEXT (2)   /* Encrypting or decrypting */
 #define CHACHAPOLY_STATE_FINISHED   (3)
 
+/* Bytes encrypted before they are authenticated: a multiple of the
+ * ChaCha20 block size, small enough to stay in the L1 cache. */
+#define CHACHAPOLY_CHUNK_SIZE       (4096U)
+
 /**
  * \brief           Adds nul bytes to pad the AAD for Poly1305.
  *
@@ -194,26 +198,36 @@ int mbedtls_chachapoly_update(mbedtls_chachapoly_context *ctx,
 
     ctx->ciphertext_len += len;
 
-    if (ctx->mode == MBEDTLS_CHACHAPOLY_ENCRYPT) {
-        ret = mbedtls_chacha20_update(&ctx->chacha20_ctx, len, input, output);
-        if (ret != 0) {
-            return ret;
+    /* Encrypt and authenticate chunk by chunk, so that the data that
+     * Poly1305 reads is still in the cache after ChaCha20 wrote it. */
+    while (len > 0U) {
+        size_t chunk = len < CHACHAPOLY_CHUNK_SIZE ? len : CHACHAPOLY_CHUNK_SIZE;
+
+        if (ctx->mode == MBEDTLS_CHACHAPOLY_ENCRYPT) {
+            ret = mbedtls_chacha20_update(&ctx->chacha20_ctx, chunk, input, output);
+            if (ret != 0) {
+                return ret;
+            }
+
+            ret = mbedtls_poly1305_update(&ctx->poly1305_ctx, output, chunk);
+            if (ret != 0) {
+                return ret;
+            }
+        } else { /* DECRYPT */
+            ret = mbedtls_poly1305_update(&ctx->poly1305_ctx, input, chunk);
+            if (ret != 0) {
+                return ret;
+            }
+
+            ret = mbedtls_chacha20_update(&ctx->chacha20_ctx, chunk, input, output);
+            if (ret != 0) {
+                return ret;
+            }
         }
 
-        ret = mbedtls_poly1305_update(&ctx->poly1305_ctx, output, len);
-        if (ret != 0) {
-            return ret;
-        }
-    } else { /* DECRYPT */
-        ret = mbedtls_poly1305_update(&ctx->poly1305_ctx, input, len);
-        if (ret != 0) {
-            return ret;
-        }
-
-        ret = mbedtls_chacha20_update(&ctx->chacha20_ctx, len, input, output);
-        if (ret != 0) {
-            return ret;
-        }
+        input  += chunk;
+        output += chunk;
+        len    -= chunk;
     }
 
     return 0;
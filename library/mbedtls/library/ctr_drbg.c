@@ -27,6 +27,19 @@
 
 #include "mbedtls/platform.h"
 
+#if defined(MBEDTLS_AESNI_C) && !defined(MBEDTLS_AES_ALT)
+#include "mbedtls/aesni.h"
+#if defined(MBEDTLS_AESNI_HAVE_CODE)
+#define CTR_DRBG_USE_AESNI
+#endif
+#endif
+
+#if defined(CTR_DRBG_USE_AESNI)
+#define CTR_DRBG_PIPELINE_BLOCKS    8
+#define CTR_DRBG_PIPELINE_LEN       (CTR_DRBG_PIPELINE_BLOCKS * \
+                                     MBEDTLS_CTR_DRBG_BLOCKSIZE)
+#endif
+
 /*
  * CTR_DRBG context initialization
  */
@@ -224,6 +237,38 @@ exit:
     return ret;
 }
 
+#if defined(CTR_DRBG_USE_AESNI)
+/*
+ * Increase the counter n times (1 <= n <= CTR_DRBG_PIPELINE_BLOCKS) and
+ * crypt the n counter blocks into output with a single call to the
+ * pipelined AES-NI kernel. Unused blocks of output are filled with
+ * key material too and must be discarded.
+ */
+static void ctr_drbg_crypt_pipeline(mbedtls_ctr_drbg_context *ctx,
+                                    unsigned char output[CTR_DRBG_PIPELINE_LEN],
+                                    int n)
+{
+    unsigned char counters[CTR_DRBG_PIPELINE_LEN];
+    int i, j;
+
+    memset(counters, 0, sizeof(counters));
+
+    for (j = 0; j < n; j++) {
+        for (i = MBEDTLS_CTR_DRBG_BLOCKSIZE; i > 0; i--) {
+            if (++ctx->counter[i - 1] != 0) {
+                break;
+            }
+        }
+        memcpy(counters + j * MBEDTLS_CTR_DRBG_BLOCKSIZE, ctx->counter,
+               MBEDTLS_CTR_DRBG_BLOCKSIZE);
+    }
+
+    mbedtls_aesni_crypt_ecb8(&ctx->aes_ctx, MBEDTLS_AES_ENCRYPT, counters, output);
+
+    mbedtls_platform_zeroize(counters, sizeof(counters));
+}
+#endif /* CTR_DRBG_USE_AESNI */
+
 /* CTR_DRBG_Update (SP 800-90A &sect;10.2.1.2)
  * ctr_drbg_update_internal(ctx, provided_data)
  * implements
@@ -242,7 +287,21 @@ static int ctr_drbg_update_internal(mbedtls_ctr_drbg_context *ctx,
 
     memset(tmp, 0, MBEDTLS_CTR_DRBG_SEEDLEN);
 
-    for (j = 0; j < MBEDTLS_CTR_DRBG_SEEDLEN; j += MBEDTLS_CTR_DRBG_BLOCKSIZE) {
+#if defined(CTR_DRBG_USE_AESNI)
+    /* All SEEDLEN / BLOCKSIZE blocks (2 or 3) in one pass */
+    if (mbedtls_aesni_has_support(MBEDTLS_AESNI_AES)) {
+        unsigned char blocks[CTR_DRBG_PIPELINE_LEN];
+
+        ctr_drbg_crypt_pipeline(ctx, blocks, MBEDTLS_CTR_DRBG_SEEDLEN /
+                                MBEDTLS_CTR_DRBG_BLOCKSIZE);
+        memcpy(tmp, blocks, MBEDTLS_CTR_DRBG_SEEDLEN);
+        mbedtls_platform_zeroize(blocks, sizeof(blocks));
+        p += MBEDTLS_CTR_DRBG_SEEDLEN;
+    }
+#endif
+
+    for (j = (int) (p - tmp); j < MBEDTLS_CTR_DRBG_SEEDLEN;
+         j += MBEDTLS_CTR_DRBG_BLOCKSIZE) {
         /*
          * Increase counter
          */
@@ -537,6 +596,31 @@ int mbedtls_ctr_drbg_random_with_add(void *p_rng,
         }
     }
 
+#if defined(CTR_DRBG_USE_AESNI)
+    /*
+     * Crypt CTR_DRBG_PIPELINE_BLOCKS counter blocks at a time straight
+     * into the destination, and the remaining blocks in one last pass
+     */
+    if (mbedtls_aesni_has_support(MBEDTLS_AESNI_AES)) {
+        while (output_len >= CTR_DRBG_PIPELINE_LEN) {
+            ctr_drbg_crypt_pipeline(ctx, p, CTR_DRBG_PIPELINE_BLOCKS);
+            p += CTR_DRBG_PIPELINE_LEN;
+            output_len -= CTR_DRBG_PIPELINE_LEN;
+        }
+
+        if (output_len > 0) {
+            unsigned char blocks[CTR_DRBG_PIPELINE_LEN];
+
+            ctr_drbg_crypt_pipeline(ctx, blocks,
+                                    (int) ((output_len + MBEDTLS_CTR_DRBG_BLOCKSIZE - 1) /
+                                           MBEDTLS_CTR_DRBG_BLOCKSIZE));
+            memcpy(p, blocks, output_len);
+            mbedtls_platform_zeroize(blocks, sizeof(blocks));
+            output_len = 0;
+        }
+    }
+#endif
+
     while (output_len > 0) {
         /*
          * Increase counter
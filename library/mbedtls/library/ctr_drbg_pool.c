@@ -0,0 +1,179 @@
+/*
+ *  Per-thread CTR_DRBG contexts seeded from one entropy source
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+
+#include "common.h"
+
+#if defined(MBEDTLS_CTR_DRBG_POOL_C)
+
+#include "mbedtls/ctr_drbg_pool.h"
+#include "mbedtls/platform_util.h"
+#include "mbedtls/error.h"
+
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+ * Atomic access to the epoch and the id counter of a pool. Loads need
+ * acquire semantics so that a thread that sees a new epoch also sees what
+ * the scheduling thread did before bumping it.
+ */
+#if defined(__GNUC__)
+#define POOL_ATOMIC_LOAD(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define POOL_ATOMIC_INC(p)      __atomic_fetch_add((p), 1, __ATOMIC_ACQ_REL)
+#elif defined(_MSC_VER)
+/* int and long are both 32 bits wide with MSVC */
+#define POOL_ATOMIC_LOAD(p)     ((int) _InterlockedOr((volatile long *) (p), 0))
+#define POOL_ATOMIC_INC(p)      ((int) _InterlockedIncrement((volatile long *) (p)) - 1)
+#elif !defined(MBEDTLS_THREADING_C)
+#define POOL_ATOMIC_LOAD(p)     (*(p))
+#define POOL_ATOMIC_INC(p)      ((*(p))++)
+#else
+#error "MBEDTLS_CTR_DRBG_POOL_C needs atomic operations with MBEDTLS_THREADING_C"
+#endif
+
+void mbedtls_ctr_drbg_pool_init(mbedtls_ctr_drbg_pool *pool,
+                                int (*f_entropy)(void *, unsigned char *,
+                                                 size_t),
+                                void *p_entropy)
+{
+    memset(pool, 0, sizeof(mbedtls_ctr_drbg_pool));
+
+    pool->f_entropy = f_entropy;
+    pool->p_entropy = p_entropy;
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init(&pool->mutex);
+#endif
+}
+
+void mbedtls_ctr_drbg_pool_free(mbedtls_ctr_drbg_pool *pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free(&pool->mutex);
+#endif
+    mbedtls_platform_zeroize(pool, sizeof(mbedtls_ctr_drbg_pool));
+}
+
+void mbedtls_ctr_drbg_pool_schedule_reseed(mbedtls_ctr_drbg_pool *pool)
+{
+    (void) POOL_ATOMIC_INC(&pool->epoch);
+}
+
+void mbedtls_ctr_drbg_thread_init(mbedtls_ctr_drbg_thread *ctx)
+{
+    memset(ctx, 0, sizeof(mbedtls_ctr_drbg_thread));
+    mbedtls_ctr_drbg_init(&ctx->drbg);
+}
+
+int mbedtls_ctr_drbg_thread_seed(mbedtls_ctr_drbg_thread *ctx,
+                                 mbedtls_ctr_drbg_pool *pool,
+                                 const unsigned char *custom,
+                                 size_t len)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char pers[MBEDTLS_CTR_DRBG_MAX_SEED_INPUT];
+    int id;
+
+    if (len > sizeof(pers) - 4) {
+        return MBEDTLS_ERR_CTR_DRBG_INPUT_TOO_BIG;
+    }
+
+    /* Read the epoch first: a reseed scheduled while we are seeding is
+     * then caught up with on the first request */
+    ctx->epoch = POOL_ATOMIC_LOAD(&pool->epoch);
+    ctx->pool = pool;
+
+    id = POOL_ATOMIC_INC(&pool->next_id);
+    MBEDTLS_PUT_UINT32_BE((uint32_t) id, pers, 0);
+    if (len != 0) {
+        memcpy(pers + 4, custom, len);
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if ((ret = mbedtls_mutex_lock(&pool->mutex)) != 0) {
+        goto exit;
+    }
+#endif
+
+    ret = mbedtls_ctr_drbg_seed(&ctx->drbg, pool->f_entropy, pool->p_entropy,
+                                pers, len + 4);
+
+#if defined(MBEDTLS_THREADING_C)
+    if (mbedtls_mutex_unlock(&pool->mutex) != 0) {
+        ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+    }
+
+exit:
+#endif
+    mbedtls_platform_zeroize(pers, sizeof(pers));
+    return ret;
+}
+
+void mbedtls_ctr_drbg_thread_free(mbedtls_ctr_drbg_thread *ctx)
+{
+    if (ctx == NULL) {
+        return;
+    }
+
+    mbedtls_ctr_drbg_free(&ctx->drbg);
+    mbedtls_platform_zeroize(ctx, sizeof(mbedtls_ctr_drbg_thread));
+}
+
+int mbedtls_ctr_drbg_thread_random(void *p_rng,
+                                   unsigned char *output, size_t output_len)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ctr_drbg_thread *ctx = (mbedtls_ctr_drbg_thread *) p_rng;
+    int epoch = POOL_ATOMIC_LOAD(&ctx->pool->epoch);
+
+    /* The context belongs to this thread: skip the mutex that
+     * mbedtls_ctr_drbg_random() takes, unless the request may call the
+     * entropy source. mbedtls_entropy_func() is not safe to call from
+     * several threads at once (its NV seed update is not under its own
+     * mutex), so every use of the source goes through the pool mutex. */
+    if (epoch == ctx->epoch &&
+        ctx->drbg.reseed_counter <= ctx->drbg.reseed_interval &&
+        !ctx->drbg.prediction_resistance) {
+        return mbedtls_ctr_drbg_random_with_add(&ctx->drbg, output,
+                                                output_len, NULL, 0);
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if ((ret = mbedtls_mutex_lock(&ctx->pool->mutex)) != 0) {
+        return ret;
+    }
+#endif
+
+    ret = 0;
+    if (epoch != ctx->epoch) {
+        ret = mbedtls_ctr_drbg_reseed(&ctx->drbg, NULL, 0);
+        if (ret == 0) {
+            ctx->epoch = epoch;
+        }
+    }
+    if (ret == 0) {
+        ret = mbedtls_ctr_drbg_random_with_add(&ctx->drbg, output, output_len,
+                                               NULL, 0);
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if (mbedtls_mutex_unlock(&ctx->pool->mutex) != 0) {
+        return MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+    }
+#endif
+
+    return ret;
+}
+
+#endif /* MBEDTLS_CTR_DRBG_POOL_C */
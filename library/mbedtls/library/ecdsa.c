@@ -29,6 +29,8 @@
 #include "mbedtls/platform_util.h"
 #include "mbedtls/error.h"
 
+#include "ecp_vartime_internal.h"
+
 /* Parameter validation macros based on platform_util.h */
 #define ECDSA_VALIDATE_RET(cond)    \
     MBEDTLS_INTERNAL_VALIDATE_RET(cond, MBEDTLS_ERR_ECP_BAD_INPUT_DATA)
@@ -648,10 +650,11 @@ static int ecdsa_verify_restartable(mbedtls_ecp_group *grp,
 muladd:
 #endif
     /*
-     * Step 5: R = u1 G + u2 Q
+     * Step 5: R = u1 G + u2 Q, with u1 and u2 public
      */
-    MBEDTLS_MPI_CHK(mbedtls_ecp_muladd_restartable(grp,
-                                                   &R, pu1, &grp->G, pu2, Q, ECDSA_RS_ECP));
+    MBEDTLS_MPI_CHK(mbedtls_ecp_muladd_vartime_restartable(grp,
+                                                           &R, pu1, &grp->G, pu2, Q,
+                                                           ECDSA_RS_ECP));
 
     if (mbedtls_ecp_is_zero(&R)) {
         ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
@@ -699,6 +702,250 @@ int mbedtls_ecdsa_verify(mbedtls_ecp_group *grp,
 
     return ecdsa_verify_restartable(grp, buf, blen, Q, r, s, NULL);
 }
+
+/*
+ * Recover the point R with x-coordinate r from an ECDSA signature, up to
+ * the sign of its y-coordinate: y = sqrt(x^3 + A x + B) mod p.
+ *
+ * Only implemented for p = 3 mod 4 (such as P-256, P-384 and P-521),
+ * where the square root is a single exponentiation. Returns MBEDTLS_ERR_ECP_VERIFY_FAILED
+ * if there is no such point, and MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE
+ * if p is not of that form. Either way the caller falls back to
+ * verifying the signature on its own.
+ */
+static int ecdsa_recover_r(const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                           const mbedtls_mpi *r)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi rhs, e, t;
+
+    if (mbedtls_mpi_get_bit(&grp->P, 0) != 1 ||
+        mbedtls_mpi_get_bit(&grp->P, 1) != 1) {
+        return MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
+    }
+
+    mbedtls_mpi_init(&rhs); mbedtls_mpi_init(&e); mbedtls_mpi_init(&t);
+
+    /* rhs = x^3 + A x + B, with A = -3 when not stored */
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&rhs, r, r));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&rhs, &rhs, &grp->P));
+    if (grp->A.p == NULL) {
+        MBEDTLS_MPI_CHK(mbedtls_mpi_sub_int(&rhs, &rhs, 3));
+    } else {
+        MBEDTLS_MPI_CHK(mbedtls_mpi_add_mpi(&rhs, &rhs, &grp->A));
+    }
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&rhs, &rhs, r));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_add_mpi(&rhs, &rhs, &grp->B));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&rhs, &rhs, &grp->P));
+
+    /* y = rhs^((p + 1) / 4), then check that it is a square root */
+    MBEDTLS_MPI_CHK(mbedtls_mpi_add_int(&e, &grp->P, 1));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_shift_r(&e, 2));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_exp_mod(&R->Y, &rhs, &e, &grp->P, NULL));
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&t, &R->Y, &R->Y));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&t, &t, &grp->P));
+    if (mbedtls_mpi_cmp_mpi(&t, &rhs) != 0) {
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_copy(&R->X, r));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_lset(&R->Z, 1));
+
+cleanup:
+    mbedtls_mpi_free(&rhs); mbedtls_mpi_free(&e); mbedtls_mpi_free(&t);
+
+    return ret;
+}
+
+/*
+ * Verify up to MBEDTLS_ECP_LINCOMB_MAX_SIGNS signatures at once.
+ *
+ * For random z_j, valid signatures satisfy
+ *   sum( z_j u1_j ) G + sum( z_j u2_j Q_j ) - sum( z_j R_j ) = 0
+ * where R_j is the point recovered from r_j. As the sign of R_j is
+ * unknown, all sign choices are tried by mbedtls_ecp_check_lincomb_signs().
+ * Terms with the same public key are merged.
+ *
+ * Entries that can't take part in the batch, and all entries of a batch
+ * that fails, are verified one by one so that each gets its own result.
+ */
+static int ecdsa_verify_sub_batch(mbedtls_ecp_group *grp,
+                                  mbedtls_ecdsa_batch_entry *entries,
+                                  size_t count,
+                                  int (*f_rng)(void *, unsigned char *, size_t),
+                                  void *p_rng)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi m[MBEDTLS_ECP_LINCOMB_MAX_SIGNS + 1];
+    mbedtls_ecp_point Pv[MBEDTLS_ECP_LINCOMB_MAX_SIGNS + 1];
+    mbedtls_mpi z[MBEDTLS_ECP_LINCOMB_MAX_SIGNS];
+    mbedtls_ecp_point S[MBEDTLS_ECP_LINCOMB_MAX_SIGNS];
+    mbedtls_ecdsa_batch_entry *batched[MBEDTLS_ECP_LINCOMB_MAX_SIGNS];
+    unsigned char zbuf[16];
+    mbedtls_mpi e, s_inv, t;
+    size_t i, k, n_terms = 1, n_batched = 0;
+
+    mbedtls_mpi_init(&e); mbedtls_mpi_init(&s_inv); mbedtls_mpi_init(&t);
+    for (i = 0; i < MBEDTLS_ECP_LINCOMB_MAX_SIGNS + 1; i++) {
+        mbedtls_mpi_init(&m[i]);
+        mbedtls_ecp_point_init(&Pv[i]);
+    }
+    for (i = 0; i < MBEDTLS_ECP_LINCOMB_MAX_SIGNS; i++) {
+        mbedtls_mpi_init(&z[i]);
+        mbedtls_ecp_point_init(&S[i]);
+    }
+
+    /* Term 0 is the generator */
+    MBEDTLS_MPI_CHK(mbedtls_ecp_copy(&Pv[0], &grp->G));
+
+    for (i = 0; i < count; i++) {
+        mbedtls_ecdsa_batch_entry *entry = &entries[i];
+        mbedtls_mpi *zj = &z[n_batched];
+
+        entry->ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+        /* Out of range signatures are simply invalid */
+        if (mbedtls_mpi_cmp_int(entry->r, 1) < 0 ||
+            mbedtls_mpi_cmp_mpi(entry->r, &grp->N) >= 0 ||
+            mbedtls_mpi_cmp_int(entry->s, 1) < 0 ||
+            mbedtls_mpi_cmp_mpi(entry->s, &grp->N) >= 0) {
+            entry->ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+            continue;
+        }
+
+        /* Invalid keys or unrecoverable R: leave it to the single check */
+        if (mbedtls_ecp_check_pubkey(grp, entry->Q) != 0 ||
+            ecdsa_recover_r(grp, &S[n_batched], entry->r) != 0) {
+            continue;
+        }
+
+        /* z_j: random, non-zero and 128 bits long */
+        do {
+            MBEDTLS_MPI_CHK(f_rng(p_rng, zbuf, sizeof(zbuf)));
+            MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(zj, zbuf, sizeof(zbuf)));
+        } while (mbedtls_mpi_cmp_int(zj, 0) == 0);
+
+        /* z_j u1_j = z_j e_j / s_j, z_j u2_j = z_j r_j / s_j */
+        MBEDTLS_MPI_CHK(derive_mpi(grp, &e, entry->buf, entry->blen));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_inv_mod(&s_inv, entry->s, &grp->N));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&s_inv, &s_inv, zj));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&s_inv, &s_inv, &grp->N));
+
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&t, &e, &s_inv));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_add_mpi(&m[0], &m[0], &t));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&m[0], &m[0], &grp->N));
+
+        for (k = 1; k < n_terms; k++) {
+            if (mbedtls_ecp_point_cmp(&Pv[k], entry->Q) == 0) {
+                break;
+            }
+        }
+        if (k == n_terms) {
+            MBEDTLS_MPI_CHK(mbedtls_ecp_copy(&Pv[k], entry->Q));
+            n_terms++;
+        }
+
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&t, entry->r, &s_inv));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_add_mpi(&m[k], &m[k], &t));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&m[k], &m[k], &grp->N));
+
+        batched[n_batched++] = entry;
+    }
+
+    if (n_batched > 0) {
+        ret = mbedtls_ecp_check_lincomb_signs(grp, m, Pv, n_terms,
+                                              z, S, n_batched);
+        if (ret == 0) {
+            for (i = 0; i < n_batched; i++) {
+                batched[i]->ret = 0;
+            }
+        } else if (ret != MBEDTLS_ERR_ECP_VERIFY_FAILED) {
+            goto cleanup;
+        }
+    }
+
+    /* Single checks for everything still undecided */
+    for (i = 0; i < count; i++) {
+        if (entries[i].ret == MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED) {
+            entries[i].ret = mbedtls_ecdsa_verify(grp, entries[i].buf,
+                                                  entries[i].blen, entries[i].Q,
+                                                  entries[i].r, entries[i].s);
+        }
+    }
+
+    ret = 0;
+
+cleanup:
+    mbedtls_platform_zeroize(zbuf, sizeof(zbuf));
+    mbedtls_mpi_free(&e); mbedtls_mpi_free(&s_inv); mbedtls_mpi_free(&t);
+    for (i = 0; i < MBEDTLS_ECP_LINCOMB_MAX_SIGNS + 1; i++) {
+        mbedtls_mpi_free(&m[i]);
+        mbedtls_ecp_point_free(&Pv[i]);
+    }
+    for (i = 0; i < MBEDTLS_ECP_LINCOMB_MAX_SIGNS; i++) {
+        mbedtls_mpi_free(&z[i]);
+        mbedtls_ecp_point_free(&S[i]);
+    }
+
+    return ret;
+}
+
+/*
+ * Verify several ECDSA signatures of hashed messages
+ */
+int mbedtls_ecdsa_verify_batch(mbedtls_ecp_group *grp,
+                               mbedtls_ecdsa_batch_entry *entries,
+                               size_t count,
+                               int (*f_rng)(void *, unsigned char *, size_t),
+                               void *p_rng)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i, n;
+
+    ECDSA_VALIDATE_RET(grp     != NULL);
+    ECDSA_VALIDATE_RET(entries != NULL || count == 0);
+
+    if (f_rng == NULL) {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    /* Fail cleanly on curves such as Curve25519 that can't be used for ECDSA */
+    if (!mbedtls_ecdsa_can_do(grp->id) || grp->N.p == NULL) {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (entries[i].Q == NULL || entries[i].r == NULL ||
+            entries[i].s == NULL ||
+            (entries[i].buf == NULL && entries[i].blen != 0)) {
+            return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+        }
+    }
+
+    for (i = 0; i < count; i += n) {
+        n = count - i;
+        if (n > MBEDTLS_ECP_LINCOMB_MAX_SIGNS) {
+            n = MBEDTLS_ECP_LINCOMB_MAX_SIGNS;
+        }
+
+        MBEDTLS_MPI_CHK(ecdsa_verify_sub_batch(grp, &entries[i], n,
+                                               f_rng, p_rng));
+    }
+
+    for (i = 0; i < count; i++) {
+        if (entries[i].ret != 0) {
+            return MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        }
+    }
+
+    ret = 0;
+
+cleanup:
+    return ret;
+}
+
 #endif /* !MBEDTLS_ECDSA_VERIFY_ALT */
 
 /*
@@ -810,6 +1057,318 @@ int mbedtls_ecdsa_write_signature_det(mbedtls_ecdsa_context *ctx,
 }
 #endif
 
+#if !defined(MBEDTLS_ECDSA_SIGN_ALT)
+/*
+ * Pools of precomputed nonces
+ */
+void mbedtls_ecdsa_nonce_pool_init(mbedtls_ecdsa_nonce_pool *pool)
+{
+    ECDSA_VALIDATE(pool != NULL);
+
+    memset(pool, 0, sizeof(mbedtls_ecdsa_nonce_pool));
+    mbedtls_ecp_group_init(&pool->grp);
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init(&pool->mutex);
+#endif
+}
+
+int mbedtls_ecdsa_nonce_pool_setup(mbedtls_ecdsa_nonce_pool *pool,
+                                   mbedtls_ecp_group_id gid, size_t size,
+                                   int (*f_rng)(void *, unsigned char *, size_t),
+                                   void *p_rng)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i;
+
+    ECDSA_VALIDATE_RET(pool  != NULL);
+    ECDSA_VALIDATE_RET(f_rng != NULL);
+
+    if (!mbedtls_ecdsa_can_do(gid) || size == 0 || pool->nonces != NULL) {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    MBEDTLS_MPI_CHK(mbedtls_ecp_group_load(&pool->grp, gid));
+
+    pool->nonces = mbedtls_calloc(size, sizeof(mbedtls_ecdsa_nonce));
+    if (pool->nonces == NULL) {
+        ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+        goto cleanup;
+    }
+    for (i = 0; i < size; i++) {
+        mbedtls_mpi_init(&pool->nonces[i].k_inv);
+        mbedtls_mpi_init(&pool->nonces[i].r);
+    }
+
+    pool->size = size;
+    pool->count = 0;
+    pool->f_rng = f_rng;
+    pool->p_rng = p_rng;
+
+cleanup:
+    if (ret != 0) {
+        mbedtls_ecp_group_free(&pool->grp);
+    }
+
+    return ret;
+}
+
+static void ecdsa_nonce_free(mbedtls_ecdsa_nonce *nonce)
+{
+    mbedtls_mpi_free(&nonce->k_inv);
+    mbedtls_mpi_free(&nonce->r);
+}
+
+/*
+ * SEC1 4.1.3 steps 1-3 and the inversion of step 6, ahead of time:
+ * r = xR mod n with R = k*G, and k^-1 mod n, blinded as t / (kt).
+ */
+static int ecdsa_nonce_gen(mbedtls_ecdsa_nonce_pool *pool,
+                           mbedtls_ecdsa_nonce *nonce)
+{
+    int ret, key_tries = 0;
+    mbedtls_ecp_group *grp = &pool->grp;
+    mbedtls_ecp_point R;
+    mbedtls_mpi k, t;
+
+    mbedtls_ecp_point_init(&R);
+    mbedtls_mpi_init(&k); mbedtls_mpi_init(&t);
+
+    do {
+        if (key_tries++ > 10) {
+            ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+            goto cleanup;
+        }
+
+        MBEDTLS_MPI_CHK(mbedtls_ecp_gen_privkey(grp, &k, pool->f_rng,
+                                                pool->p_rng));
+        MBEDTLS_MPI_CHK(mbedtls_ecp_mul(grp, &R, &k, &grp->G, pool->f_rng,
+                                        pool->p_rng));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&nonce->r, &R.X, &grp->N));
+    } while (mbedtls_mpi_cmp_int(&nonce->r, 0) == 0);
+
+    MBEDTLS_MPI_CHK(mbedtls_ecp_gen_privkey(grp, &t, pool->f_rng,
+                                            pool->p_rng));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&k, &k, &t));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&k, &k, &grp->N));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_inv_mod(&nonce->k_inv, &k, &grp->N));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&nonce->k_inv, &nonce->k_inv, &t));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&nonce->k_inv, &nonce->k_inv,
+                                        &grp->N));
+
+cleanup:
+    mbedtls_ecp_point_free(&R);
+    mbedtls_mpi_free(&k); mbedtls_mpi_free(&t);
+
+    return ret;
+}
+
+int mbedtls_ecdsa_nonce_pool_fill(mbedtls_ecdsa_nonce_pool *pool, size_t max)
+{
+    int ret = 0;
+    mbedtls_ecdsa_nonce nonce;
+    size_t done;
+
+    ECDSA_VALIDATE_RET(pool != NULL);
+
+    if (pool->nonces == NULL) {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    mbedtls_mpi_init(&nonce.k_inv);
+    mbedtls_mpi_init(&nonce.r);
+
+    /* The count may change between the check and the store below: at
+     * worst, a nonce is computed for a pool that another thread has just
+     * filled up, and it is wiped */
+    for (done = 0; done < max &&
+         mbedtls_ecdsa_nonce_pool_count(pool) < pool->size; done++) {
+        MBEDTLS_MPI_CHK(ecdsa_nonce_gen(pool, &nonce));
+
+#if defined(MBEDTLS_THREADING_C)
+        if ((ret = mbedtls_mutex_lock(&pool->mutex)) != 0) {
+            goto cleanup;
+        }
+#endif
+        /* The pool owns the limbs of the nonce from now on */
+        if (pool->count < pool->size) {
+            pool->nonces[pool->count++] = nonce;
+            mbedtls_mpi_init(&nonce.k_inv);
+            mbedtls_mpi_init(&nonce.r);
+        }
+#if defined(MBEDTLS_THREADING_C)
+        if ((ret = mbedtls_mutex_unlock(&pool->mutex)) != 0) {
+            goto cleanup;
+        }
+#endif
+    }
+
+cleanup:
+    ecdsa_nonce_free(&nonce);
+
+    return ret;
+}
+
+size_t mbedtls_ecdsa_nonce_pool_count(mbedtls_ecdsa_nonce_pool *pool)
+{
+    size_t count;
+
+    MBEDTLS_INTERNAL_VALIDATE_RET(pool != NULL, 0);
+
+#if defined(MBEDTLS_THREADING_C)
+    if (mbedtls_mutex_lock(&pool->mutex) != 0) {
+        return 0;
+    }
+#endif
+    count = pool->count;
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock(&pool->mutex);
+#endif
+
+    return count;
+}
+
+void mbedtls_ecdsa_nonce_pool_free(mbedtls_ecdsa_nonce_pool *pool)
+{
+    size_t i;
+
+    if (pool == NULL) {
+        return;
+    }
+
+    if (pool->nonces != NULL) {
+        for (i = 0; i < pool->size; i++) {
+            ecdsa_nonce_free(&pool->nonces[i]);
+        }
+        mbedtls_free(pool->nonces);
+    }
+    mbedtls_ecp_group_free(&pool->grp);
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free(&pool->mutex);
+#endif
+
+    mbedtls_platform_zeroize(pool, sizeof(mbedtls_ecdsa_nonce_pool));
+}
+
+/*
+ * Take the last nonce out of the pool. Returns 0 with the nonce in *nonce,
+ * which the caller must free, or 1 if the pool is empty.
+ */
+static int ecdsa_nonce_take(mbedtls_ecdsa_nonce_pool *pool,
+                            mbedtls_ecdsa_nonce *nonce)
+{
+    int ret = 1;
+
+#if defined(MBEDTLS_THREADING_C)
+    if (mbedtls_mutex_lock(&pool->mutex) != 0) {
+        return 1;
+    }
+#endif
+    if (pool->count > 0) {
+        *nonce = pool->nonces[--pool->count];
+        mbedtls_mpi_init(&pool->nonces[pool->count].k_inv);
+        mbedtls_mpi_init(&pool->nonces[pool->count].r);
+        ret = 0;
+    }
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock(&pool->mutex);
+#endif
+
+    return ret;
+}
+
+int mbedtls_ecdsa_sign_pooled(mbedtls_ecp_group *grp, mbedtls_mpi *r,
+                              mbedtls_mpi *s, const mbedtls_mpi *d,
+                              const unsigned char *buf, size_t blen,
+                              mbedtls_ecdsa_nonce_pool *pool,
+                              int (*f_rng)(void *, unsigned char *, size_t),
+                              void *p_rng)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ecdsa_nonce nonce;
+    mbedtls_mpi e;
+
+    ECDSA_VALIDATE_RET(grp   != NULL);
+    ECDSA_VALIDATE_RET(r     != NULL);
+    ECDSA_VALIDATE_RET(s     != NULL);
+    ECDSA_VALIDATE_RET(d     != NULL);
+    ECDSA_VALIDATE_RET(pool  != NULL);
+    ECDSA_VALIDATE_RET(f_rng != NULL);
+    ECDSA_VALIDATE_RET(buf   != NULL || blen == 0);
+
+    if (grp->id != pool->grp.id || grp->N.p == NULL) {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    /* Make sure d is in range 1..n-1 */
+    if (mbedtls_mpi_cmp_int(d, 1) < 0 || mbedtls_mpi_cmp_mpi(d, &grp->N) >= 0) {
+        return MBEDTLS_ERR_ECP_INVALID_KEY;
+    }
+
+    mbedtls_mpi_init(&e);
+
+    /*
+     * Step 6 with a nonce from the pool: s = (e + r * d) * k^-1 mod n.
+     * A nonce that gives s = 0 is dropped, as the next one from the pool
+     * or a fresh one would be picked instead.
+     */
+    while (ecdsa_nonce_take(pool, &nonce) == 0) {
+        MBEDTLS_MPI_CHK(derive_mpi(grp, &e, buf, blen));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(s, &nonce.r, d));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_add_mpi(&e, &e, s));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(s, &e, &nonce.k_inv));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(s, s, &grp->N));
+
+        if (mbedtls_mpi_cmp_int(s, 0) != 0) {
+            MBEDTLS_MPI_CHK(mbedtls_mpi_copy(r, &nonce.r));
+            goto cleanup;
+        }
+
+        ecdsa_nonce_free(&nonce);
+    }
+
+    /* The pool is empty */
+    mbedtls_mpi_init(&nonce.k_inv);
+    mbedtls_mpi_init(&nonce.r);
+    ret = ecdsa_sign_restartable(grp, r, s, d, buf, blen,
+                                 f_rng, p_rng, f_rng, p_rng, NULL);
+
+cleanup:
+    ecdsa_nonce_free(&nonce);
+    mbedtls_mpi_free(&e);
+
+    return ret;
+}
+
+int mbedtls_ecdsa_write_signature_pooled(mbedtls_ecdsa_context *ctx,
+                                         const unsigned char *hash, size_t hlen,
+                                         unsigned char *sig, size_t *slen,
+                                         mbedtls_ecdsa_nonce_pool *pool,
+                                         int (*f_rng)(void *, unsigned char *,
+                                                      size_t),
+                                         void *p_rng)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi r, s;
+    ECDSA_VALIDATE_RET(ctx  != NULL);
+    ECDSA_VALIDATE_RET(hash != NULL);
+    ECDSA_VALIDATE_RET(sig  != NULL);
+    ECDSA_VALIDATE_RET(slen != NULL);
+
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    MBEDTLS_MPI_CHK(mbedtls_ecdsa_sign_pooled(&ctx->grp, &r, &s, &ctx->d,
+                                              hash, hlen, pool, f_rng, p_rng));
+    MBEDTLS_MPI_CHK(ecdsa_signature_to_asn1(&r, &s, sig, slen));
+
+cleanup:
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+
+    return ret;
+}
+#endif /* !MBEDTLS_ECDSA_SIGN_ALT */
+
 /*
  * Read and check signature
  */
@@ -0,0 +1,229 @@
+/*
+ *  Cooperative scheduling of restartable ECDSA operations
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+
+#include "common.h"
+
+#if defined(MBEDTLS_ECDSA_SCHED_C)
+
+#include "mbedtls/ecdsa_sched.h"
+#include "mbedtls/error.h"
+
+#include <string.h>
+
+void mbedtls_ecdsa_sched_init(mbedtls_ecdsa_sched *sched, unsigned max_ops)
+{
+    memset(sched, 0, sizeof(mbedtls_ecdsa_sched));
+
+    sched->max_ops = max_ops;
+}
+
+void mbedtls_ecdsa_sched_free(mbedtls_ecdsa_sched *sched)
+{
+    mbedtls_ecdsa_sched_op *op;
+
+    if (sched == NULL) {
+        return;
+    }
+
+    while ((op = sched->head) != NULL) {
+        sched->head = op->next;
+        op->next = NULL;
+        mbedtls_ecdsa_restart_free(&op->rs);
+    }
+
+    memset(sched, 0, sizeof(mbedtls_ecdsa_sched));
+}
+
+static void ecdsa_sched_append(mbedtls_ecdsa_sched *sched,
+                               mbedtls_ecdsa_sched_op *op)
+{
+    op->next = NULL;
+
+    if (sched->tail == NULL) {
+        sched->head = op;
+    } else {
+        sched->tail->next = op;
+    }
+    sched->tail = op;
+}
+
+/*
+ * Common part of queueing a signature or a verification. The operation is
+ * not cleared first, and the hash is moved rather than copied: a callback
+ * may queue its operation again, with inputs taken from the operation.
+ */
+static int ecdsa_sched_queue(mbedtls_ecdsa_sched *sched,
+                             mbedtls_ecdsa_sched_op *op, int verify,
+                             mbedtls_ecdsa_context *ctx,
+                             const unsigned char *hash, size_t hlen,
+                             void (*f_done)(void *, mbedtls_ecdsa_sched_op *,
+                                            int),
+                             void *p_done)
+{
+    if (hlen > sizeof(op->hash)) {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    op->verify = verify;
+    op->ctx = ctx;
+    op->md_alg = MBEDTLS_MD_NONE;
+    memmove(op->hash, hash, hlen);
+    op->hlen = hlen;
+    op->f_rng = NULL;
+    op->p_rng = NULL;
+    op->f_done = f_done;
+    op->p_done = p_done;
+    op->slices = 0;
+    mbedtls_ecdsa_restart_init(&op->rs);
+
+    ecdsa_sched_append(sched, op);
+    sched->pending++;
+
+    return 0;
+}
+
+int mbedtls_ecdsa_sched_sign(mbedtls_ecdsa_sched *sched,
+                             mbedtls_ecdsa_sched_op *op,
+                             mbedtls_ecdsa_context *ctx,
+                             mbedtls_md_type_t md_alg,
+                             const unsigned char *hash, size_t hlen,
+                             int (*f_rng)(void *, unsigned char *, size_t),
+                             void *p_rng,
+                             void (*f_done)(void *, mbedtls_ecdsa_sched_op *,
+                                            int),
+                             void *p_done)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if ((ret = ecdsa_sched_queue(sched, op, 0, ctx, hash, hlen,
+                                 f_done, p_done)) != 0) {
+        return ret;
+    }
+
+    op->sig_len = 0;
+    op->md_alg = md_alg;
+    op->f_rng = f_rng;
+    op->p_rng = p_rng;
+
+    return 0;
+}
+
+int mbedtls_ecdsa_sched_verify(mbedtls_ecdsa_sched *sched,
+                               mbedtls_ecdsa_sched_op *op,
+                               mbedtls_ecdsa_context *ctx,
+                               const unsigned char *hash, size_t hlen,
+                               const unsigned char *sig, size_t slen,
+                               void (*f_done)(void *, mbedtls_ecdsa_sched_op *,
+                                              int),
+                               void *p_done)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if (slen > sizeof(op->sig)) {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    if ((ret = ecdsa_sched_queue(sched, op, 1, ctx, hash, hlen,
+                                 f_done, p_done)) != 0) {
+        return ret;
+    }
+
+    memmove(op->sig, sig, slen);
+    op->sig_len = slen;
+
+    return 0;
+}
+
+int mbedtls_ecdsa_sched_cancel(mbedtls_ecdsa_sched *sched,
+                               mbedtls_ecdsa_sched_op *op)
+{
+    mbedtls_ecdsa_sched_op *prev = NULL, *cur;
+
+    for (cur = sched->head; cur != NULL; prev = cur, cur = cur->next) {
+        if (cur != op) {
+            continue;
+        }
+
+        if (prev == NULL) {
+            sched->head = op->next;
+        } else {
+            prev->next = op->next;
+        }
+        if (sched->tail == op) {
+            sched->tail = prev;
+        }
+
+        op->next = NULL;
+        sched->pending--;
+        mbedtls_ecdsa_restart_free(&op->rs);
+
+        return 0;
+    }
+
+    return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+}
+
+size_t mbedtls_ecdsa_sched_step(mbedtls_ecdsa_sched *sched)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ecdsa_sched_op *op = sched->head;
+
+    if (op == NULL) {
+        return 0;
+    }
+
+    /* The budget is global: only set it for the duration of the slice,
+     * so that restartable calls made outside of the scheduler keep
+     * running to completion. */
+    mbedtls_ecp_set_max_ops(sched->max_ops);
+
+    if (op->verify) {
+        ret = mbedtls_ecdsa_read_signature_restartable(op->ctx,
+                                                       op->hash, op->hlen,
+                                                       op->sig, op->sig_len,
+                                                       &op->rs);
+    } else {
+        ret = mbedtls_ecdsa_write_signature_restartable(op->ctx, op->md_alg,
+                                                        op->hash, op->hlen,
+                                                        op->sig, &op->sig_len,
+                                                        op->f_rng, op->p_rng,
+                                                        &op->rs);
+    }
+
+    mbedtls_ecp_set_max_ops(0);
+    op->slices++;
+
+    sched->head = op->next;
+    if (sched->head == NULL) {
+        sched->tail = NULL;
+    }
+
+    if (ret == MBEDTLS_ERR_ECP_IN_PROGRESS) {
+        ecdsa_sched_append(sched, op);
+        return sched->pending;
+    }
+
+    op->next = NULL;
+    sched->pending--;
+    mbedtls_ecdsa_restart_free(&op->rs);
+
+    /* The operation is off the queue: the callback may queue it again */
+    if (op->f_done != NULL) {
+        op->f_done(op->p_done, op, ret);
+    }
+
+    return sched->pending;
+}
+
+void mbedtls_ecdsa_sched_run(mbedtls_ecdsa_sched *sched)
+{
+    while (mbedtls_ecdsa_sched_step(sched) != 0) {
+        continue;
+    }
+}
+
+#endif /* MBEDTLS_ECDSA_SCHED_C */
@@ -69,6 +69,7 @@
 #include "mbedtls/bn_mul.h"
 
 #include "ecp_invasive.h"
+#include "ecp_vartime_internal.h"
 
 #include <string.h>
 
@@ -709,6 +710,19 @@ void mbedtls_ecp_point_free(mbedtls_ecp_point *pt)
     mbedtls_mpi_free(&(pt->Z));
 }
 
+/*
+ * Is the comb table of G a static one from ecp_curves.c (never freed)?
+ */
+static int ecp_group_is_static_comb_table(const mbedtls_ecp_group *grp)
+{
+#if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
+    return grp->T != NULL && grp->T_size == 0;
+#else
+    (void) grp;
+    return 0;
+#endif
+}
+
 /*
  * Unallocate (the components of) a group
  */
@@ -728,7 +742,7 @@ void mbedtls_ecp_group_free(mbedtls_ecp_group *grp)
         mbedtls_mpi_free(&grp->N);
     }
 
-    if (grp->T != NULL) {
+    if (!ecp_group_is_static_comb_table(grp) && grp->T != NULL) {
         for (i = 0; i < grp->T_size; i++) {
             mbedtls_ecp_point_free(&grp->T[i]);
         }
@@ -2247,16 +2261,19 @@ static unsigned char ecp_pick_window_size(const mbedtls_ecp_group *grp,
     }
 
     /*
-     * Make sure w is within bounds.
+     * A static comb table for G was generated for exactly this w, so it
+     * must not be changed. Otherwise make sure w is within bounds.
      * (The last test is useful only for very small curves in the test suite.)
      */
+    if (!p_eq_g || !ecp_group_is_static_comb_table(grp)) {
 #if (MBEDTLS_ECP_WINDOW_SIZE < 6)
-    if (w > MBEDTLS_ECP_WINDOW_SIZE) {
-        w = MBEDTLS_ECP_WINDOW_SIZE;
-    }
+        if (w > MBEDTLS_ECP_WINDOW_SIZE) {
+            w = MBEDTLS_ECP_WINDOW_SIZE;
+        }
 #endif
-    if (w >= grp->nbits) {
-        w = 2;
+        if (w >= grp->nbits) {
+            w = 2;
+        }
     }
 
     return w;
@@ -2849,6 +2866,363 @@ cleanup:
     return ret;
 }
 
+/*
+ * Interleaved multiplication of several points by several scalars, using
+ * Straus' method (one shared chain of doublings) on the width-w NAF of each
+ * scalar, for curves in short Weierstrass form.
+ *
+ * The comb method above is designed to resist side channels. This method
+ * is not: all the branches and table accesses depend on the scalars, so
+ * it must ONLY be used with public data, as in signature verification.
+ */
+
+/* Largest window size, which determines the size of the per-point tables */
+#define ECP_WNAF_MAX_W          5
+#define ECP_WNAF_TABLE_SIZE     (1 << (ECP_WNAF_MAX_W - 2))
+
+/*
+ * One term m * P of a linear combination:
+ * - naf holds the len wNAF digits of m (least significant first),
+ * - T holds the odd multiples P, 3P, .., (2^(w-1) - 1)P in affine
+ *   coordinates and N their opposites.
+ * w == 0 means that m is zero, in which case no table is computed.
+ */
+typedef struct {
+    unsigned char w;
+    size_t len;
+    signed char *naf;
+    mbedtls_ecp_point T[ECP_WNAF_TABLE_SIZE];
+    mbedtls_ecp_point N[ECP_WNAF_TABLE_SIZE];
+} ecp_wnaf_term;
+
+/*
+ * Compute the width-w NAF of m >= 0, that is digits naf[i] such that
+ * m = sum( naf[i] 2^i ), every non-zero digit is odd and lies between
+ * -2^(w-1) and 2^(w-1), and among any w consecutive digits at most one
+ * is non-zero. len must be at least bitlen(m) + 1.
+ */
+static void ecp_wnaf_recode(signed char naf[], size_t len,
+                            const mbedtls_mpi *m, unsigned char w)
+{
+    size_t bit = 0, j, now;
+    int carry = 0, word;
+
+    memset(naf, 0, len);
+
+    while (bit < len) {
+        if ((int) mbedtls_mpi_get_bit(m, bit) == carry) {
+            bit++;
+            continue;
+        }
+
+        now = (len - bit < w) ? len - bit : w;
+
+        word = carry;
+        for (j = 0; j < now; j++) {
+            word += mbedtls_mpi_get_bit(m, bit + j) << j;
+        }
+
+        /* Make the digit negative if it is too large, and carry */
+        carry = (word >> (w - 1)) & 1;
+        word -= carry << w;
+
+        naf[bit] = (signed char) word;
+        bit += now;
+    }
+}
+
+static void ecp_wnaf_terms_free(ecp_wnaf_term *terms, size_t count)
+{
+    size_t i, j;
+
+    if (terms == NULL) {
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        for (j = 0; j < ECP_WNAF_TABLE_SIZE; j++) {
+            mbedtls_ecp_point_free(&terms[i].T[j]);
+            mbedtls_ecp_point_free(&terms[i].N[j]);
+        }
+        mbedtls_free(terms[i].naf);
+    }
+
+    mbedtls_free(terms);
+}
+
+#if defined(MBEDTLS_TEST_HOOKS)
+unsigned long mbedtls_ecp_vartime_calls = 0;
+#endif
+
+/*
+ * Recode the scalars and precompute the tables of odd multiples of
+ * all points at once, so that only two inversions are needed.
+ *
+ * Assumes that P[i] are valid (affine) points and that m[i] are in the
+ * range 0..N-1.
+ */
+static int ecp_wnaf_terms_setup(const mbedtls_ecp_group *grp,
+                                ecp_wnaf_term **terms_out,
+                                const mbedtls_mpi *m,
+                                const mbedtls_ecp_point *P,
+                                size_t count)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    ecp_wnaf_term *terms;
+    mbedtls_ecp_point *dbl = NULL;
+    mbedtls_ecp_point **norm = NULL;
+    size_t i, j, n_dbl = 0, n_norm = 0;
+    size_t bits;
+
+    *terms_out = NULL;
+
+#if defined(MBEDTLS_TEST_HOOKS)
+    mbedtls_ecp_vartime_calls++;
+#endif
+
+    terms = mbedtls_calloc(count, sizeof(ecp_wnaf_term));
+    dbl = mbedtls_calloc(count, sizeof(mbedtls_ecp_point));
+    norm = mbedtls_calloc(count * ECP_WNAF_TABLE_SIZE,
+                          sizeof(mbedtls_ecp_point *));
+    if (terms == NULL || dbl == NULL || norm == NULL) {
+        ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    for (i = 0; i < count; i++) {
+        mbedtls_ecp_point_init(&dbl[i]);
+        for (j = 0; j < ECP_WNAF_TABLE_SIZE; j++) {
+            mbedtls_ecp_point_init(&terms[i].T[j]);
+            mbedtls_ecp_point_init(&terms[i].N[j]);
+        }
+    }
+
+    /*
+     * Recode the scalars. Short scalars (such as the random coefficients
+     * of batch verification) get a smaller window, as their table would
+     * not pay for itself.
+     */
+    for (i = 0; i < count; i++) {
+        bits = mbedtls_mpi_bitlen(&m[i]);
+        terms[i].len = bits + 1;
+        terms[i].w = bits == 0 ? 0 : bits > 160 ? ECP_WNAF_MAX_W : 4;
+
+        terms[i].naf = mbedtls_calloc(terms[i].len, 1);
+        if (terms[i].naf == NULL) {
+            ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+            goto cleanup;
+        }
+
+        if (terms[i].w != 0) {
+            ecp_wnaf_recode(terms[i].naf, terms[i].len, &m[i], terms[i].w);
+        }
+    }
+
+    /* 2 P[i], normalized together */
+    for (i = 0; i < count; i++) {
+        if (terms[i].w == 0) {
+            continue;
+        }
+
+        MBEDTLS_MPI_CHK(ecp_double_jac(grp, &dbl[i], &P[i]));
+        norm[n_dbl++] = &dbl[i];
+    }
+
+    if (n_dbl == 0) {
+        ret = 0;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK(ecp_normalize_jac_many(grp, norm, n_dbl));
+
+    /* T[j] = T[j-1] + 2 P, then all T[j] normalized together */
+    for (i = 0; i < count; i++) {
+        if (terms[i].w == 0) {
+            continue;
+        }
+
+        MBEDTLS_MPI_CHK(mbedtls_ecp_copy(&terms[i].T[0], &P[i]));
+        for (j = 1; j < (1U << (terms[i].w - 2)); j++) {
+            MBEDTLS_MPI_CHK(ecp_add_mixed(grp, &terms[i].T[j],
+                                          &terms[i].T[j - 1], &dbl[i]));
+            norm[n_norm++] = &terms[i].T[j];
+        }
+    }
+
+    if (n_norm != 0) {
+        MBEDTLS_MPI_CHK(ecp_normalize_jac_many(grp, norm, n_norm));
+    }
+
+    /* Opposites: -(X, Y) = (X, P - Y), Y is never 0 in a group of odd order */
+    for (i = 0; i < count; i++) {
+        if (terms[i].w == 0) {
+            continue;
+        }
+
+        for (j = 0; j < (1U << (terms[i].w - 2)); j++) {
+            MBEDTLS_MPI_CHK(mbedtls_mpi_copy(&terms[i].N[j].X, &terms[i].T[j].X));
+            MBEDTLS_MPI_CHK(mbedtls_mpi_sub_mpi(&terms[i].N[j].Y,
+                                                &grp->P, &terms[i].T[j].Y));
+        }
+    }
+
+    ret = 0;
+
+cleanup:
+    if (dbl != NULL) {
+        for (i = 0; i < count; i++) {
+            mbedtls_ecp_point_free(&dbl[i]);
+        }
+    }
+    mbedtls_free(dbl);
+    mbedtls_free(norm);
+
+    if (ret == 0) {
+        *terms_out = terms;
+    } else {
+        ecp_wnaf_terms_free(terms, count);
+    }
+
+    return ret;
+}
+
+/*
+ * R += Q, where R is in Jacobian coordinates and may be zero, and Q is
+ * affine and not zero.
+ */
+static int ecp_wnaf_add(const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                        const mbedtls_ecp_point *Q)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if (mbedtls_mpi_cmp_int(&R->Z, 0) == 0) {
+        /* Tables don't store Z, but R needs it */
+        MBEDTLS_MPI_CHK(mbedtls_mpi_copy(&R->X, &Q->X));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_copy(&R->Y, &Q->Y));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_lset(&R->Z, 1));
+    } else {
+        MBEDTLS_MPI_CHK(ecp_add_mixed(grp, R, R, Q));
+    }
+
+cleanup:
+    return ret;
+}
+
+/*
+ * R = sum( m[i] P[i] ) for the terms first .. first + count - 1.
+ * R is left in Jacobian coordinates, and may be zero.
+ */
+static int ecp_wnaf_mul_core(const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                             const ecp_wnaf_term *terms, size_t count)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i, bit, len = 0;
+    int digit;
+
+    for (i = 0; i < count; i++) {
+        if (terms[i].w != 0 && terms[i].len > len) {
+            len = terms[i].len;
+        }
+    }
+
+    MBEDTLS_MPI_CHK(mbedtls_ecp_set_zero(R));
+
+    for (bit = len; bit-- > 0;) {
+        if (mbedtls_mpi_cmp_int(&R->Z, 0) != 0) {
+            MBEDTLS_MPI_CHK(ecp_double_jac(grp, R, R));
+        }
+
+        for (i = 0; i < count; i++) {
+            if (terms[i].w == 0 || bit >= terms[i].len) {
+                continue;
+            }
+
+            digit = terms[i].naf[bit];
+            if (digit > 0) {
+                MBEDTLS_MPI_CHK(ecp_wnaf_add(grp, R, &terms[i].T[digit >> 1]));
+            } else if (digit < 0) {
+                MBEDTLS_MPI_CHK(ecp_wnaf_add(grp, R, &terms[i].N[(-digit) >> 1]));
+            }
+        }
+    }
+
+cleanup:
+    return ret;
+}
+
+/*
+ * Common checks for linear combinations: scalars in 0..N-1 (or 1..N-1 if
+ * non_zero is set), valid points.
+ */
+static int ecp_check_lincomb_args(const mbedtls_ecp_group *grp,
+                                  const mbedtls_mpi *m,
+                                  const mbedtls_ecp_point *P,
+                                  size_t count, int non_zero)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (mbedtls_mpi_cmp_int(&m[i], non_zero) < 0 ||
+            mbedtls_mpi_cmp_mpi(&m[i], &grp->N) >= 0) {
+            return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+        }
+
+        MBEDTLS_MPI_CHK(mbedtls_ecp_check_pubkey(grp, &P[i]));
+    }
+
+cleanup:
+    return ret;
+}
+
+/*
+ * R = m P + n Q with a single chain of doublings
+ * NOT constant-time
+ *
+ * Returns MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE for inputs outside the range
+ * handled here (scalars not in 0..N-1, invalid points): the caller then
+ * falls back to separate multiplications, which report the exact error.
+ */
+static int ecp_muladd_wnaf(mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                           const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+                           const mbedtls_mpi *n, const mbedtls_ecp_point *Q)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    ecp_wnaf_term *terms = NULL;
+    mbedtls_mpi k[2];
+    mbedtls_ecp_point T[2];
+    size_t i;
+
+    for (i = 0; i < 2; i++) {
+        mbedtls_mpi_init(&k[i]);
+        mbedtls_ecp_point_init(&T[i]);
+    }
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_copy(&k[0], m));
+    MBEDTLS_MPI_CHK(mbedtls_ecp_copy(&T[0], P));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_copy(&k[1], n));
+    MBEDTLS_MPI_CHK(mbedtls_ecp_copy(&T[1], Q));
+
+    if (ecp_check_lincomb_args(grp, k, T, 2, 0) != 0) {
+        ret = MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK(ecp_wnaf_terms_setup(grp, &terms, k, T, 2));
+    MBEDTLS_MPI_CHK(ecp_wnaf_mul_core(grp, R, terms, 2));
+    MBEDTLS_MPI_CHK(ecp_normalize_jac(grp, R));
+
+cleanup:
+    ecp_wnaf_terms_free(terms, 2);
+
+    for (i = 0; i < 2; i++) {
+        mbedtls_mpi_free(&k[i]);
+        mbedtls_ecp_point_free(&T[i]);
+    }
+
+    return ret;
+}
+
 /*
  * Restartable linear combination
  * NOT constant-time
@@ -2971,6 +3345,260 @@ int mbedtls_ecp_muladd(mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     ECP_VALIDATE_RET(Q   != NULL);
     return mbedtls_ecp_muladd_restartable(grp, R, m, P, n, Q, NULL);
 }
+
+/*
+ * Linear combination of public scalars and points, with a single chain of
+ * doublings unless the operation may have to be restarted
+ * NOT constant-time: only for signature verification
+ */
+int mbedtls_ecp_muladd_vartime_restartable(
+    mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+    const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+    const mbedtls_mpi *n, const mbedtls_ecp_point *Q,
+    mbedtls_ecp_restart_ctx *rs_ctx)
+{
+    int ret = MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+
+    if (mbedtls_ecp_get_type(grp) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS) {
+        return MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
+    }
+
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+    if (rs_ctx == NULL ||
+        (rs_ctx->ma == NULL && !mbedtls_ecp_restart_is_enabled()))
+#endif
+    {
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+        if ((is_grp_capable = mbedtls_internal_ecp_grp_capable(grp))) {
+            MBEDTLS_MPI_CHK(mbedtls_internal_ecp_init(grp));
+        }
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+        ret = ecp_muladd_wnaf(grp, R, m, P, n, Q);
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+        if (is_grp_capable) {
+            mbedtls_internal_ecp_free(grp);
+        }
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+    }
+
+    /* Restartable operations, and inputs that need special handling, go
+     * through separate multiplications, which report the exact error */
+    if (ret == MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE) {
+        ret = mbedtls_ecp_muladd_restartable(grp, R, m, P, n, Q, rs_ctx);
+    }
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+cleanup:
+#endif
+    return ret;
+}
+
+/*
+ * Linear combination of several points
+ * NOT constant-time
+ */
+int mbedtls_ecp_muladd_multi(mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+                             size_t count)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    ecp_wnaf_term *terms = NULL;
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+    ECP_VALIDATE_RET(grp != NULL);
+    ECP_VALIDATE_RET(R   != NULL);
+    ECP_VALIDATE_RET(m   != NULL);
+    ECP_VALIDATE_RET(P   != NULL);
+
+    if (mbedtls_ecp_get_type(grp) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS) {
+        return MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
+    }
+
+    if (count == 0) {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    MBEDTLS_MPI_CHK(ecp_check_lincomb_args(grp, m, P, count, 0));
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if ((is_grp_capable = mbedtls_internal_ecp_grp_capable(grp))) {
+        MBEDTLS_MPI_CHK(mbedtls_internal_ecp_init(grp));
+    }
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    MBEDTLS_MPI_CHK(ecp_wnaf_terms_setup(grp, &terms, m, P, count));
+    MBEDTLS_MPI_CHK(ecp_wnaf_mul_core(grp, R, terms, count));
+    MBEDTLS_MPI_CHK(ecp_normalize_jac(grp, R));
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if (is_grp_capable) {
+        mbedtls_internal_ecp_free(grp);
+    }
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    ecp_wnaf_terms_free(terms, count);
+
+    return ret;
+}
+
+/*
+ * Check whether sum( m[i] P[i] ) + sum( +/- z[j] S[j] ) can be zero.
+ * NOT constant-time
+ *
+ * All z[j] S[j] are first added with a positive sign into the result T of
+ * a single interleaved multiplication. Switching the sign of term j then
+ * amounts to subtracting D[j] = 2 z[j] S[j], so all 2^s_count sign choices
+ * can be checked with one mixed addition each, visiting them in Gray code
+ * order.
+ */
+int mbedtls_ecp_check_lincomb_signs(mbedtls_ecp_group *grp,
+                                    const mbedtls_mpi *m,
+                                    const mbedtls_ecp_point *P,
+                                    size_t count,
+                                    const mbedtls_mpi *z,
+                                    const mbedtls_ecp_point *S,
+                                    size_t s_count)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    ecp_wnaf_term *terms = NULL;
+    mbedtls_ecp_point T;
+    mbedtls_ecp_point D[MBEDTLS_ECP_LINCOMB_MAX_SIGNS];
+    mbedtls_ecp_point ND[MBEDTLS_ECP_LINCOMB_MAX_SIGNS];
+    mbedtls_ecp_point *pD[MBEDTLS_ECP_LINCOMB_MAX_SIGNS];
+    mbedtls_mpi *scalars = NULL;
+    mbedtls_ecp_point *points = NULL;
+    unsigned long k, signs = 0;
+    size_t i, j;
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+    ECP_VALIDATE_RET(grp != NULL);
+    ECP_VALIDATE_RET(m   != NULL || count == 0);
+    ECP_VALIDATE_RET(P   != NULL || count == 0);
+    ECP_VALIDATE_RET(z   != NULL || s_count == 0);
+    ECP_VALIDATE_RET(S   != NULL || s_count == 0);
+
+    if (mbedtls_ecp_get_type(grp) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS) {
+        return MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
+    }
+
+    if (count + s_count == 0 || s_count > MBEDTLS_ECP_LINCOMB_MAX_SIGNS) {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    mbedtls_ecp_point_init(&T);
+    for (j = 0; j < MBEDTLS_ECP_LINCOMB_MAX_SIGNS; j++) {
+        mbedtls_ecp_point_init(&D[j]);
+        mbedtls_ecp_point_init(&ND[j]);
+        pD[j] = &D[j];
+    }
+
+    MBEDTLS_MPI_CHK(ecp_check_lincomb_args(grp, m, P, count, 0));
+    MBEDTLS_MPI_CHK(ecp_check_lincomb_args(grp, z, S, s_count, 1));
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if ((is_grp_capable = mbedtls_internal_ecp_grp_capable(grp))) {
+        MBEDTLS_MPI_CHK(mbedtls_internal_ecp_init(grp));
+    }
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    /* Gather all terms, signed ones last, so they share tables */
+    scalars = mbedtls_calloc(count + s_count, sizeof(mbedtls_mpi));
+    points = mbedtls_calloc(count + s_count, sizeof(mbedtls_ecp_point));
+    if (scalars == NULL || points == NULL) {
+        ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    for (i = 0; i < count + s_count; i++) {
+        mbedtls_mpi_init(&scalars[i]);
+        mbedtls_ecp_point_init(&points[i]);
+    }
+
+    for (i = 0; i < count; i++) {
+        MBEDTLS_MPI_CHK(mbedtls_mpi_copy(&scalars[i], &m[i]));
+        MBEDTLS_MPI_CHK(mbedtls_ecp_copy(&points[i], &P[i]));
+    }
+    for (j = 0; j < s_count; j++) {
+        MBEDTLS_MPI_CHK(mbedtls_mpi_copy(&scalars[count + j], &z[j]));
+        MBEDTLS_MPI_CHK(mbedtls_ecp_copy(&points[count + j], &S[j]));
+    }
+
+    MBEDTLS_MPI_CHK(ecp_wnaf_terms_setup(grp, &terms, scalars, points,
+                                         count + s_count));
+
+    /* T = sum( m[i] P[i] ) + sum( z[j] S[j] ) */
+    MBEDTLS_MPI_CHK(ecp_wnaf_mul_core(grp, &T, terms, count + s_count));
+
+    if (s_count != 0) {
+        /* D[j] = 2 z[j] S[j], reusing the tables of S[j] */
+        for (j = 0; j < s_count; j++) {
+            MBEDTLS_MPI_CHK(ecp_wnaf_mul_core(grp, &D[j], &terms[count + j], 1));
+            MBEDTLS_MPI_CHK(ecp_double_jac(grp, &D[j], &D[j]));
+        }
+
+        MBEDTLS_MPI_CHK(ecp_normalize_jac_many(grp, pD, s_count));
+
+        for (j = 0; j < s_count; j++) {
+            MBEDTLS_MPI_CHK(mbedtls_mpi_copy(&ND[j].X, &D[j].X));
+            MBEDTLS_MPI_CHK(mbedtls_mpi_sub_mpi(&ND[j].Y, &grp->P, &D[j].Y));
+        }
+    }
+
+    for (k = 1;; k++) {
+        if (mbedtls_mpi_cmp_int(&T.Z, 0) == 0) {
+            ret = 0;
+            break;
+        }
+
+        if (k == (1UL << s_count)) {
+            ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+            break;
+        }
+
+        /* Flip the sign of the term given by the lowest set bit of k */
+        for (j = 0; (k & (1UL << j)) == 0; j++) {
+            ;
+        }
+        signs ^= 1UL << j;
+
+        MBEDTLS_MPI_CHK(ecp_wnaf_add(grp, &T,
+                                     (signs & (1UL << j)) ? &ND[j] : &D[j]));
+    }
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if (is_grp_capable) {
+        mbedtls_internal_ecp_free(grp);
+    }
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    ecp_wnaf_terms_free(terms, count + s_count);
+
+    if (scalars != NULL && points != NULL) {
+        for (i = 0; i < count + s_count; i++) {
+            mbedtls_mpi_free(&scalars[i]);
+            mbedtls_ecp_point_free(&points[i]);
+        }
+    }
+    mbedtls_free(scalars);
+    mbedtls_free(points);
+
+    mbedtls_ecp_point_free(&T);
+    for (j = 0; j < MBEDTLS_ECP_LINCOMB_MAX_SIGNS; j++) {
+        mbedtls_ecp_point_free(&D[j]);
+        mbedtls_ecp_point_free(&ND[j]);
+    }
+
+    return ret;
+}
 #endif /* MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED */
 
 #if defined(MBEDTLS_ECP_MONTGOMERY_ENABLED)
@@ -64,6 +64,14 @@ int mbedtls_ecp_gen_privkey_mx(size_t high_bit,
 
 #endif /* MBEDTLS_ECP_MONTGOMERY_ENABLED */
 
+#if !defined(MBEDTLS_ECP_ALT)
+/** The number of multiplications run by the variable-time wNAF code of
+ * mbedtls_ecp_muladd_vartime_restartable(), mbedtls_ecp_muladd_multi()
+ * and mbedtls_ecp_check_lincomb_signs(). Operations on secret scalars
+ * must never increase it. */
+extern unsigned long mbedtls_ecp_vartime_calls;
+#endif
+
 #endif /* MBEDTLS_TEST_HOOKS && MBEDTLS_ECP_C */
 
 #endif /* MBEDTLS_ECP_INVASIVE_H */
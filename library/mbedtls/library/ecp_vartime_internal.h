@@ -0,0 +1,55 @@
+/**
+ * \file ecp_vartime_internal.h
+ *
+ * \brief Variable-time ECP operations, for use on public data only
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+#ifndef MBEDTLS_ECP_VARTIME_INTERNAL_H
+#define MBEDTLS_ECP_VARTIME_INTERNAL_H
+
+#include "common.h"
+#include "mbedtls/ecp.h"
+
+#if defined(MBEDTLS_ECP_C)
+
+#if !defined(MBEDTLS_ECP_ALT)
+/**
+ * \brief           This function computes R = m * P + n * Q with a single
+ *                  chain of doublings, as for signature verification.
+ *
+ *                  If the operation may have to be restarted, or if the
+ *                  inputs need special handling, it is done by
+ *                  mbedtls_ecp_muladd_restartable() instead.
+ *
+ * \warning         The running time depends on \p m and \p n. Never use
+ *                  this function with a secret scalar: use
+ *                  mbedtls_ecp_muladd() for that.
+ *
+ * \param grp       The ECP group to use. It must be a short Weierstrass
+ *                  curve.
+ * \param R         The point in which to store the result.
+ * \param m         The public integer by which to multiply \p P.
+ * \param P         The point to multiply by \p m.
+ * \param n         The public integer by which to multiply \p Q.
+ * \param Q         The point to be multiplied by \p n.
+ * \param rs_ctx    The restart context, as for
+ *                  mbedtls_ecp_muladd_restartable(). This may be \c NULL.
+ *
+ * \return          \c 0 on success, or an error code as for
+ *                  mbedtls_ecp_muladd_restartable().
+ */
+int mbedtls_ecp_muladd_vartime_restartable(
+    mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+    const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+    const mbedtls_mpi *n, const mbedtls_ecp_point *Q,
+    mbedtls_ecp_restart_ctx *rs_ctx);
+#else
+#define mbedtls_ecp_muladd_vartime_restartable mbedtls_ecp_muladd_restartable
+#endif /* !MBEDTLS_ECP_ALT */
+
+#endif /* MBEDTLS_ECP_C */
+
+#endif /* MBEDTLS_ECP_VARTIME_INTERNAL_H */
@@ -31,6 +31,12 @@
 #include "mbedtls/aesni.h"
 #endif
 
+/* The AES-NI GCM kernel reads the round keys of the AES context itself */
+#if defined(MBEDTLS_AESNI_HAVE_CODE) && !defined(MBEDTLS_AES_ALT) && \
+    !defined(MBEDTLS_AES_SETKEY_ENC_ALT) && !defined(MBEDTLS_AES_ENCRYPT_ALT)
+#define GCM_USE_AESNI_CRYPT4
+#endif
+
 #if !defined(MBEDTLS_GCM_ALT)
 
 /* Parameter validation macros */
@@ -48,6 +54,29 @@ void mbedtls_gcm_init(mbedtls_gcm_context *ctx)
     memset(ctx, 0, sizeof(mbedtls_gcm_context));
 }
 
+#if defined(GCM_USE_AESNI_CRYPT4)
+/*
+ * Precompute H^4, H^3, H^2 and H for mbedtls_aesni_gcm_crypt4(), each
+ * with its bytes reversed
+ */
+static void gcm_aesni_gen_powers(mbedtls_gcm_context *ctx,
+                                 const unsigned char h[16])
+{
+    unsigned char hn[16];
+    int i, j;
+
+    memcpy(hn, h, 16);
+    for (i = 3; i >= 0; i--) {
+        for (j = 0; j < 16; j++) {
+            ctx->HP[16 * i + j] = hn[15 - j];
+        }
+        mbedtls_aesni_gcm_mult(hn, hn, h);
+    }
+
+    mbedtls_platform_zeroize(hn, sizeof(hn));
+}
+#endif /* GCM_USE_AESNI_CRYPT4 */
+
 /*
  * Precompute small multiples of H, that is set
  *      HH[i] || HL[i] = H times i,
@@ -85,6 +114,9 @@ static int gcm_gen_table(mbedtls_gcm_context *ctx)
 #if defined(MBEDTLS_AESNI_HAVE_CODE)
     /* With CLMUL support, we need only h, not the rest of the table */
     if (mbedtls_aesni_has_support(MBEDTLS_AESNI_CLMUL)) {
+#if defined(GCM_USE_AESNI_CRYPT4)
+        gcm_aesni_gen_powers(ctx, h);
+#endif
         return 0;
     }
 #endif
@@ -311,6 +343,69 @@ int mbedtls_gcm_starts(mbedtls_gcm_context *ctx,
     return 0;
 }
 
+#if defined(GCM_USE_AESNI_CRYPT4)
+static int gcm_aesni_crypt4_usable(const mbedtls_gcm_context *ctx)
+{
+    mbedtls_cipher_type_t type = mbedtls_cipher_get_type(&ctx->cipher_ctx);
+
+    return (type == MBEDTLS_CIPHER_AES_128_ECB ||
+            type == MBEDTLS_CIPHER_AES_192_ECB ||
+            type == MBEDTLS_CIPHER_AES_256_ECB) &&
+           mbedtls_aesni_has_support(MBEDTLS_AESNI_AES) &&
+           mbedtls_aesni_has_support(MBEDTLS_AESNI_CLMUL);
+}
+
+/*
+ * En(de)crypt and hash length bytes, a multiple of 64, with the AES-NI
+ * kernel. When encrypting, the ciphertext of each group of 4 blocks is
+ * hashed while the next group is encrypted: the first group is only
+ * encrypted, and the last one is only hashed.
+ */
+static void gcm_aesni_crypt4(mbedtls_gcm_context *ctx, size_t length,
+                             const unsigned char *input,
+                             unsigned char *output)
+{
+    mbedtls_aes_context *aes = ctx->cipher_ctx.cipher_ctx;
+    unsigned char ectr[128];
+    size_t i;
+    int j;
+
+    if (ctx->mode == MBEDTLS_GCM_DECRYPT) {
+        mbedtls_aesni_gcm_crypt4(aes, ctx->HP, ctx->y, ctx->buf, length / 64,
+                                 input, output, input);
+        return;
+    }
+
+    /* The first group goes through the 8-block kernel, the upper half of
+     * ectr is not used */
+    memset(ectr, 0, sizeof(ectr));
+    for (j = 0; j < 4; j++) {
+        for (i = 16; i > 12; i--) {
+            if (++ctx->y[i - 1] != 0) {
+                break;
+            }
+        }
+        memcpy(ectr + 16 * j, ctx->y, 16);
+    }
+    mbedtls_aesni_crypt_ecb8(aes, MBEDTLS_AES_ENCRYPT, ectr, ectr);
+    for (i = 0; i < 64; i++) {
+        output[i] = ectr[i] ^ input[i];
+    }
+
+    mbedtls_aesni_gcm_crypt4(aes, ctx->HP, ctx->y, ctx->buf, length / 64 - 1,
+                             input + 64, output + 64, output);
+
+    for (j = 0; j < 4; j++) {
+        for (i = 0; i < 16; i++) {
+            ctx->buf[i] ^= output[length - 64 + 16 * j + i];
+        }
+        gcm_mult(ctx, ctx->buf, ctx->buf);
+    }
+
+    mbedtls_platform_zeroize(ectr, sizeof(ectr));
+}
+#endif /* GCM_USE_AESNI_CRYPT4 */
+
 int mbedtls_gcm_update(mbedtls_gcm_context *ctx,
                        size_t length,
                        const unsigned char *input,
@@ -341,6 +436,19 @@ int mbedtls_gcm_update(mbedtls_gcm_context *ctx,
     ctx->len += length;
 
     p = input;
+
+#if defined(GCM_USE_AESNI_CRYPT4)
+    if (length >= 64 && gcm_aesni_crypt4_usable(ctx)) {
+        use_len = length & ~(size_t) 63;
+
+        gcm_aesni_crypt4(ctx, use_len, p, out_p);
+
+        length -= use_len;
+        p += use_len;
+        out_p += use_len;
+    }
+#endif
+
     while (length > 0) {
         use_len = (length < 16) ? length : 16;
 
@@ -0,0 +1,196 @@
+/*
+ *  Per-thread arena allocator
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+
+#include "common.h"
+
+#if defined(MBEDTLS_MEMORY_ARENA_C)
+#include "mbedtls/memory_arena.h"
+
+/* No need for the header guard as MBEDTLS_MEMORY_ARENA_C
+   is dependent upon MBEDTLS_PLATFORM_C */
+#include "mbedtls/platform.h"
+#include "mbedtls/platform_util.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define ARENA_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define ARENA_THREAD_LOCAL __thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define ARENA_THREAD_LOCAL _Thread_local
+#elif !defined(MBEDTLS_THREADING_C)
+#define ARENA_THREAD_LOCAL
+#else
+#error "MBEDTLS_MEMORY_ARENA_C needs thread-local storage with MBEDTLS_THREADING_C"
+#endif
+
+#if (MBEDTLS_MEMORY_ARENA_ALIGN & (MBEDTLS_MEMORY_ARENA_ALIGN - 1)) != 0 || \
+    MBEDTLS_MEMORY_ARENA_ALIGN < 8
+#error "MBEDTLS_MEMORY_ARENA_ALIGN must be a power of 2, at least 8"
+#endif
+
+#if MBEDTLS_MEMORY_ARENA_MAX_BLOCK % MBEDTLS_MEMORY_ARENA_ALIGN != 0
+#error "MBEDTLS_MEMORY_ARENA_MAX_BLOCK must be a multiple of MBEDTLS_MEMORY_ARENA_ALIGN"
+#endif
+
+/*
+ * Each block is preceded by a header of MBEDTLS_MEMORY_ARENA_ALIGN bytes
+ * holding its size class: block sizes are rounded up to a multiple of the
+ * alignment, and class i holds blocks of (i + 1) * MBEDTLS_MEMORY_ARENA_ALIGN
+ * bytes. A freed block stores the next block of its free list in place.
+ */
+#define ARENA_HDR_SIZE      MBEDTLS_MEMORY_ARENA_ALIGN
+
+/* The arena bound to the current thread, NULL if none */
+static ARENA_THREAD_LOCAL mbedtls_memory_arena *thread_arena;
+
+static int arena_owns(const mbedtls_memory_arena *arena, const void *ptr)
+{
+    uintptr_t p = (uintptr_t) ptr;
+    uintptr_t b = (uintptr_t) arena->buf;
+
+    return p >= b && p - b < arena->len;
+}
+
+static void *arena_calloc(size_t n, size_t size)
+{
+    mbedtls_memory_arena *arena = thread_arena;
+    unsigned char *p;
+    size_t len, cls;
+
+    if (arena == NULL || arena->depth == 0 || n == 0 || size == 0) {
+        return MBEDTLS_PLATFORM_STD_CALLOC(n, size);
+    }
+
+    arena->stats.op_allocs++;
+
+    if (size > MBEDTLS_MEMORY_ARENA_MAX_BLOCK / n) {
+        arena->stats.op_fallbacks++;
+        return MBEDTLS_PLATFORM_STD_CALLOC(n, size);
+    }
+    len = n * size;
+    cls = (len - 1) / MBEDTLS_MEMORY_ARENA_ALIGN;
+
+    p = arena->free_list[cls];
+    if (p != NULL) {
+        memcpy(&arena->free_list[cls], p, sizeof(void *));
+    } else {
+        size_t block = ARENA_HDR_SIZE + (cls + 1) * MBEDTLS_MEMORY_ARENA_ALIGN;
+
+        if (block > arena->len - arena->used) {
+            arena->stats.op_fallbacks++;
+            return MBEDTLS_PLATFORM_STD_CALLOC(n, size);
+        }
+
+        p = arena->buf + arena->used + ARENA_HDR_SIZE;
+        memcpy(p - ARENA_HDR_SIZE, &cls, sizeof(cls));
+        arena->used += block;
+        if (arena->used > arena->stats.op_peak) {
+            arena->stats.op_peak = arena->used;
+        }
+    }
+
+    arena->live++;
+    memset(p, 0, len);
+    return p;
+}
+
+static void arena_free(void *ptr)
+{
+    mbedtls_memory_arena *arena = thread_arena;
+    unsigned char *p = ptr;
+    size_t cls;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    if (arena == NULL || !arena_owns(arena, ptr)) {
+        MBEDTLS_PLATFORM_STD_FREE(ptr);
+        return;
+    }
+
+    if (--arena->live == 0) {
+        /* Nothing left in use: rewind the whole buffer */
+        memset(arena->free_list, 0, sizeof(arena->free_list));
+        arena->used = 0;
+        return;
+    }
+
+    memcpy(&cls, p - ARENA_HDR_SIZE, sizeof(cls));
+    memcpy(p, &arena->free_list[cls], sizeof(void *));
+    arena->free_list[cls] = p;
+}
+
+void mbedtls_memory_arena_init(mbedtls_memory_arena *arena,
+                               unsigned char *buf, size_t len)
+{
+    size_t pad = (size_t) (-(uintptr_t) buf) & (MBEDTLS_MEMORY_ARENA_ALIGN - 1);
+
+    memset(arena, 0, sizeof(mbedtls_memory_arena));
+
+    if (len > pad) {
+        arena->buf = buf + pad;
+        arena->len = (len - pad) & ~(size_t) (MBEDTLS_MEMORY_ARENA_ALIGN - 1);
+    }
+
+    thread_arena = arena;
+    mbedtls_platform_set_calloc_free(arena_calloc, arena_free);
+}
+
+void mbedtls_memory_arena_free(mbedtls_memory_arena *arena)
+{
+    if (arena == NULL) {
+        return;
+    }
+
+    if (thread_arena == arena) {
+        thread_arena = NULL;
+    }
+
+    if (arena->buf != NULL) {
+        mbedtls_platform_zeroize(arena->buf, arena->len);
+    }
+    mbedtls_platform_zeroize(arena, sizeof(mbedtls_memory_arena));
+}
+
+void mbedtls_memory_arena_begin(mbedtls_memory_arena *arena)
+{
+    if (arena->depth++ > 0) {
+        return;
+    }
+
+    arena->stats.op_allocs = 0;
+    arena->stats.op_fallbacks = 0;
+    arena->stats.op_peak = arena->used;
+}
+
+size_t mbedtls_memory_arena_end(mbedtls_memory_arena *arena)
+{
+    if (arena->depth == 0 || --arena->depth > 0) {
+        return arena->live;
+    }
+
+    arena->stats.ops++;
+    arena->stats.total_allocs += arena->stats.op_allocs;
+    arena->stats.total_fallbacks += arena->stats.op_fallbacks;
+    if (arena->stats.op_peak > arena->stats.max_peak) {
+        arena->stats.max_peak = arena->stats.op_peak;
+    }
+
+    return arena->live;
+}
+
+void mbedtls_memory_arena_get_stats(const mbedtls_memory_arena *arena,
+                                    mbedtls_memory_arena_stats *stats)
+{
+    *stats = arena->stats;
+}
+
+#endif /* MBEDTLS_MEMORY_ARENA_C */
@@ -29,6 +29,21 @@
 #define MAGIC2       0xEE119966
 #define MAX_BT 20
 
+/*
+ * Free blocks are kept in segregated lists, one per size class, as in TLSF.
+ * Below SMALL_SIZE there are SL_COUNT classes of equal width. Above, each
+ * range [2^f, 2^(f+1)) is a first-level class, split into SL_COUNT
+ * second-level classes of equal width. A bitmap of the first-level classes
+ * that have a free block, and one of the second-level classes of each, find
+ * a free block large enough in constant time.
+ */
+#define SL_LOG2      3
+#define SL_COUNT     (1 << SL_LOG2)
+#define SMALL_LOG2   7
+#define SMALL_SIZE   ((size_t) 1 << SMALL_LOG2)
+#define FL_COUNT     (sizeof(size_t) * 8 - SMALL_LOG2 + 1)
+#define PROBE_COUNT  4
+
 typedef struct _memory_header memory_header;
 struct _memory_header {
     size_t          magic1;
@@ -49,7 +64,9 @@ typedef struct {
     unsigned char   *buf;
     size_t          len;
     memory_header   *first;
-    memory_header   *first_free;
+    memory_header   *free_lists[FL_COUNT][SL_COUNT];
+    size_t          fl_bitmap;
+    unsigned char   sl_bitmap[FL_COUNT];
     int             verify;
 #if defined(MBEDTLS_MEMORY_DEBUG)
     size_t          alloc_count;
@@ -67,6 +84,142 @@ buffer_alloc_ctx;
 
 static buffer_alloc_ctx heap;
 
+/* Index of the most significant bit set in x, x != 0 */
+static size_t bit_fls(size_t x)
+{
+#if defined(__GNUC__)
+    return 63 - (size_t) __builtin_clzll((unsigned long long) x);
+#else
+    size_t n = 0;
+
+    while (x >>= 1) {
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* Index of the least significant bit set in x, x != 0 */
+static size_t bit_ffs(size_t x)
+{
+#if defined(__GNUC__)
+    return (size_t) __builtin_ctzll((unsigned long long) x);
+#else
+    size_t n = 0;
+
+    while ((x & 1) == 0) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static void size_class(size_t size, size_t *fl, size_t *sl)
+{
+    size_t f;
+
+    if (size < SMALL_SIZE) {
+        *fl = 0;
+        *sl = size >> (SMALL_LOG2 - SL_LOG2);
+        return;
+    }
+
+    f = bit_fls(size);
+    *fl = f - SMALL_LOG2 + 1;
+    *sl = (size >> (f - SL_LOG2)) & (SL_COUNT - 1);
+}
+
+static void insert_free(memory_header *hdr)
+{
+    size_t fl, sl;
+
+    size_class(hdr->size, &fl, &sl);
+
+    hdr->prev_free = NULL;
+    hdr->next_free = heap.free_lists[fl][sl];
+    if (hdr->next_free != NULL) {
+        hdr->next_free->prev_free = hdr;
+    }
+    heap.free_lists[fl][sl] = hdr;
+
+    heap.fl_bitmap |= (size_t) 1 << fl;
+    heap.sl_bitmap[fl] |= (unsigned char) (1 << sl);
+}
+
+/* Remove hdr from the list of its size class fl/sl */
+static void remove_free(memory_header *hdr, size_t fl, size_t sl)
+{
+    if (hdr->prev_free != NULL) {
+        hdr->prev_free->next_free = hdr->next_free;
+    } else {
+        heap.free_lists[fl][sl] = hdr->next_free;
+        if (hdr->next_free == NULL) {
+            heap.sl_bitmap[fl] &= (unsigned char) ~(1 << sl);
+            if (heap.sl_bitmap[fl] == 0) {
+                heap.fl_bitmap &= ~((size_t) 1 << fl);
+            }
+        }
+    }
+
+    if (hdr->next_free != NULL) {
+        hdr->next_free->prev_free = hdr->prev_free;
+    }
+
+    hdr->prev_free = NULL;
+    hdr->next_free = NULL;
+}
+
+/*
+ * Find a free block of at least len bytes, and its size class. Try the first
+ * few blocks of the class of len, then any block of the first non-empty
+ * class above it, which is large enough and found with the bitmaps. Only if
+ * there is none, go through the rest of the class of len: this finds a
+ * block whenever there is one.
+ */
+static memory_header *find_free(size_t len, size_t *fl_found, size_t *sl_found)
+{
+    memory_header *cur;
+    size_t fl, sl, map = 0, fl_map = 0, probe;
+
+    size_class(len, &fl, &sl);
+    *fl_found = fl;
+    *sl_found = sl;
+
+    for (cur = heap.free_lists[fl][sl], probe = 0;
+         cur != NULL && probe < PROBE_COUNT;
+         cur = cur->next_free, probe++) {
+        if (cur->size >= len) {
+            return cur;
+        }
+    }
+
+    if (sl + 1 < SL_COUNT) {
+        map = heap.sl_bitmap[fl] & (~0u << (sl + 1));
+    }
+    if (map == 0 && fl + 1 < FL_COUNT) {
+        fl_map = heap.fl_bitmap & (~(size_t) 0 << (fl + 1));
+        if (fl_map != 0) {
+            fl = bit_ffs(fl_map);
+            map = heap.sl_bitmap[fl];
+        }
+    }
+
+    if (map != 0) {
+        *fl_found = fl;
+        *sl_found = bit_ffs(map);
+        return heap.free_lists[fl][*sl_found];
+    }
+
+    for (; cur != NULL; cur = cur->next_free) {
+        if (cur->size >= len) {
+            return cur;
+        }
+    }
+
+    return NULL;
+}
+
 #if defined(MBEDTLS_MEMORY_DEBUG)
 static void debug_header(memory_header *hdr)
 {
@@ -93,6 +246,7 @@ static void debug_header(memory_header *hdr)
 static void debug_chain(void)
 {
     memory_header *cur = heap.first;
+    size_t fl, sl;
 
     mbedtls_fprintf(stderr, "\nBlock list\n");
     while (cur != NULL) {
@@ -100,12 +254,19 @@ static void debug_chain(void)
         cur = cur->next;
     }
 
-    mbedtls_fprintf(stderr, "Free list\n");
-    cur = heap.first_free;
+    for (fl = 0; fl < FL_COUNT; fl++) {
+        for (sl = 0; sl < SL_COUNT; sl++) {
+            cur = heap.free_lists[fl][sl];
+            if (cur == NULL) {
+                continue;
+            }
 
-    while (cur != NULL) {
-        debug_header(cur);
-        cur = cur->next_free;
+            mbedtls_fprintf(stderr, "Free list %zu/%zu\n", fl, sl);
+            while (cur != NULL) {
+                debug_header(cur);
+                cur = cur->next_free;
+            }
+        }
     }
 }
 #endif /* MBEDTLS_MEMORY_DEBUG */
@@ -150,9 +311,87 @@ static int verify_header(memory_header *hdr)
     return 0;
 }
 
+static int verify_free_lists(size_t free_blocks)
+{
+    memory_header *cur;
+    size_t fl, sl, cur_fl, cur_sl, listed = 0;
+
+    for (fl = 0; fl < FL_COUNT; fl++) {
+        if (((heap.fl_bitmap >> fl) & 1) != (heap.sl_bitmap[fl] != 0)) {
+#if defined(MBEDTLS_MEMORY_DEBUG)
+            mbedtls_fprintf(stderr, "FATAL: verification failed: "
+                                    "first-level bitmap\n");
+#endif
+            return 1;
+        }
+
+        for (sl = 0; sl < SL_COUNT; sl++) {
+            cur = heap.free_lists[fl][sl];
+
+            if (((heap.sl_bitmap[fl] >> sl) & 1) != (cur != NULL)) {
+#if defined(MBEDTLS_MEMORY_DEBUG)
+                mbedtls_fprintf(stderr, "FATAL: verification failed: "
+                                        "second-level bitmap\n");
+#endif
+                return 1;
+            }
+
+            if (cur != NULL && cur->prev_free != NULL) {
+#if defined(MBEDTLS_MEMORY_DEBUG)
+                mbedtls_fprintf(stderr, "FATAL: verification failed: "
+                                        "free list head has prev_free\n");
+#endif
+                return 1;
+            }
+
+            for (; cur != NULL; cur = cur->next_free) {
+                if (verify_header(cur) != 0 || cur->alloc != 0) {
+#if defined(MBEDTLS_MEMORY_DEBUG)
+                    mbedtls_fprintf(stderr, "FATAL: verification of free "
+                                            "header failed\n");
+#endif
+                    return 1;
+                }
+
+                size_class(cur->size, &cur_fl, &cur_sl);
+                if (cur_fl != fl || cur_sl != sl ||
+                    (cur->next_free != NULL &&
+                     cur->next_free->prev_free != cur)) {
+#if defined(MBEDTLS_MEMORY_DEBUG)
+                    mbedtls_fprintf(stderr, "FATAL: verification failed: "
+                                            "free list %zu/%zu\n", fl, sl);
+#endif
+                    return 1;
+                }
+
+                /* Also stops on a loop in a list */
+                if (listed++ == free_blocks) {
+#if defined(MBEDTLS_MEMORY_DEBUG)
+                    mbedtls_fprintf(stderr, "FATAL: verification failed: "
+                                            "more free blocks listed than "
+                                            "in the chain\n");
+#endif
+                    return 1;
+                }
+            }
+        }
+    }
+
+    if (listed != free_blocks) {
+#if defined(MBEDTLS_MEMORY_DEBUG)
+        mbedtls_fprintf(stderr, "FATAL: verification failed: "
+                                "free block not in a free list\n");
+#endif
+        return 1;
+    }
+
+    return 0;
+}
+
 static int verify_chain(void)
 {
     memory_header *prv = heap.first, *cur;
+    size_t free_blocks;
 
     if (prv == NULL || verify_header(prv) != 0) {
 #if defined(MBEDTLS_MEMORY_DEBUG)
@@ -170,6 +409,7 @@ static int verify_chain(void)
         return 1;
     }
 
+    free_blocks = heap.first->alloc == 0;
     cur = heap.first->next;
 
     while (cur != NULL) {
@@ -189,19 +429,20 @@ static int verify_chain(void)
             return 1;
         }
 
+        free_blocks += cur->alloc == 0;
         prv = cur;
         cur = cur->next;
     }
 
-    return 0;
+    return verify_free_lists(free_blocks);
 }
 
 static void *buffer_alloc_calloc(size_t n, size_t size)
 {
-    memory_header *new, *cur = heap.first_free;
+    memory_header *new, *cur;
     unsigned char *p;
     void *ret;
-    size_t original_len, len;
+    size_t original_len, len, fl, sl;
 #if defined(MBEDTLS_MEMORY_BACKTRACE)
     void *trace_buffer[MAX_BT];
     size_t trace_cnt;
@@ -215,7 +456,7 @@ static void *buffer_alloc_calloc(size_t n, size_t size)
 
     if (n == 0 || size == 0 || len / n != size) {
         return NULL;
-    } else if (len > (size_t) -MBEDTLS_MEMORY_ALIGN_MULTIPLE) {
+    } else if (len > heap.len) {
         return NULL;
     }
 
@@ -226,13 +467,7 @@ static void *buffer_alloc_calloc(size_t n, size_t size)
 
     // Find block that fits
     //
-    while (cur != NULL) {
-        if (cur->size >= len) {
-            break;
-        }
-
-        cur = cur->next_free;
-    }
+    cur = find_free(len, &fl, &sl);
 
     if (cur == NULL) {
         return NULL;
@@ -250,92 +485,46 @@ static void *buffer_alloc_calloc(size_t n, size_t size)
     heap.alloc_count++;
 #endif
 
-    // Found location, split block if > memory_header + 4 room left
+    remove_free(cur, fl, sl);
+    cur->alloc = 1;
+
+    // Found location, split block if > memory_header + 4 room left,
+    // and file the rest under its own size class
     //
-    if (cur->size - len < sizeof(memory_header) +
+    if (cur->size - len >= sizeof(memory_header) +
         MBEDTLS_MEMORY_ALIGN_MULTIPLE) {
-        cur->alloc = 1;
-
-        // Remove from free_list
-        //
-        if (cur->prev_free != NULL) {
-            cur->prev_free->next_free = cur->next_free;
-        } else {
-            heap.first_free = cur->next_free;
-        }
-
-        if (cur->next_free != NULL) {
-            cur->next_free->prev_free = cur->prev_free;
-        }
+        p = ((unsigned char *) cur) + sizeof(memory_header) + len;
+        new = (memory_header *) p;
 
-        cur->prev_free = NULL;
-        cur->next_free = NULL;
-
-#if defined(MBEDTLS_MEMORY_DEBUG)
-        heap.total_used += cur->size;
-        if (heap.total_used > heap.maximum_used) {
-            heap.maximum_used = heap.total_used;
-        }
-#endif
+        new->size = cur->size - len - sizeof(memory_header);
+        new->alloc = 0;
+        new->prev = cur;
+        new->next = cur->next;
 #if defined(MBEDTLS_MEMORY_BACKTRACE)
-        trace_cnt = backtrace(trace_buffer, MAX_BT);
-        cur->trace = backtrace_symbols(trace_buffer, trace_cnt);
-        cur->trace_count = trace_cnt;
+        new->trace = NULL;
+        new->trace_count = 0;
 #endif
+        new->magic1 = MAGIC1;
+        new->magic2 = MAGIC2;
 
-        if ((heap.verify & MBEDTLS_MEMORY_VERIFY_ALLOC) && verify_chain() != 0) {
-            mbedtls_exit(1);
+        if (new->next != NULL) {
+            new->next->prev = new;
         }
 
-        ret = (unsigned char *) cur + sizeof(memory_header);
-        memset(ret, 0, original_len);
+        cur->size = len;
+        cur->next = new;
 
-        return ret;
-    }
-
-    p = ((unsigned char *) cur) + sizeof(memory_header) + len;
-    new = (memory_header *) p;
+        insert_free(new);
 
-    new->size = cur->size - len - sizeof(memory_header);
-    new->alloc = 0;
-    new->prev = cur;
-    new->next = cur->next;
-#if defined(MBEDTLS_MEMORY_BACKTRACE)
-    new->trace = NULL;
-    new->trace_count = 0;
+#if defined(MBEDTLS_MEMORY_DEBUG)
+        heap.header_count++;
+        if (heap.header_count > heap.maximum_header_count) {
+            heap.maximum_header_count = heap.header_count;
+        }
 #endif
-    new->magic1 = MAGIC1;
-    new->magic2 = MAGIC2;
-
-    if (new->next != NULL) {
-        new->next->prev = new;
-    }
-
-    // Replace cur with new in free_list
-    //
-    new->prev_free = cur->prev_free;
-    new->next_free = cur->next_free;
-    if (new->prev_free != NULL) {
-        new->prev_free->next_free = new;
-    } else {
-        heap.first_free = new;
-    }
-
-    if (new->next_free != NULL) {
-        new->next_free->prev_free = new;
     }
 
-    cur->alloc = 1;
-    cur->size = len;
-    cur->next = new;
-    cur->prev_free = NULL;
-    cur->next_free = NULL;
-
 #if defined(MBEDTLS_MEMORY_DEBUG)
-    heap.header_count++;
-    if (heap.header_count > heap.maximum_header_count) {
-        heap.maximum_header_count = heap.header_count;
-    }
     heap.total_used += cur->size;
     if (heap.total_used > heap.maximum_used) {
         heap.maximum_used = heap.total_used;
@@ -359,8 +548,9 @@ static void *buffer_alloc_calloc(size_t n, size_t size)
 
 static void buffer_alloc_free(void *ptr)
 {
-    memory_header *hdr, *old = NULL;
+    memory_header *hdr, *old;
     unsigned char *p = (unsigned char *) ptr;
+    size_t fl, sl;
 
     if (ptr == NULL || heap.buf == NULL || heap.first == NULL) {
         return;
@@ -408,6 +598,8 @@ static void buffer_alloc_free(void *ptr)
 #if defined(MBEDTLS_MEMORY_DEBUG)
         heap.header_count--;
 #endif
+        size_class(hdr->prev->size, &fl, &sl);
+        remove_free(hdr->prev, fl, sl);
         hdr->prev->size += sizeof(memory_header) + hdr->size;
         hdr->prev->next = hdr->next;
         old = hdr;
@@ -426,35 +618,12 @@ static void buffer_alloc_free(void *ptr)
 #if defined(MBEDTLS_MEMORY_DEBUG)
         heap.header_count--;
 #endif
+        size_class(hdr->next->size, &fl, &sl);
+        remove_free(hdr->next, fl, sl);
         hdr->size += sizeof(memory_header) + hdr->next->size;
         old = hdr->next;
         hdr->next = hdr->next->next;
 
-        if (hdr->prev_free != NULL || hdr->next_free != NULL) {
-            if (hdr->prev_free != NULL) {
-                hdr->prev_free->next_free = hdr->next_free;
-            } else {
-                heap.first_free = hdr->next_free;
-            }
-
-            if (hdr->next_free != NULL) {
-                hdr->next_free->prev_free = hdr->prev_free;
-            }
-        }
-
-        hdr->prev_free = old->prev_free;
-        hdr->next_free = old->next_free;
-
-        if (hdr->prev_free != NULL) {
-            hdr->prev_free->next_free = hdr;
-        } else {
-            heap.first_free = hdr;
-        }
-
-        if (hdr->next_free != NULL) {
-            hdr->next_free->prev_free = hdr;
-        }
-
         if (hdr->next != NULL) {
             hdr->next->prev = hdr;
         }
@@ -462,16 +631,9 @@ static void buffer_alloc_free(void *ptr)
         memset(old, 0, sizeof(memory_header));
     }
 
-    // Prepend to free_list if we have not merged
-    // (Does not have to stay in same order as prev / next list)
+    // File the (merged) block under its size class
     //
-    if (old == NULL) {
-        hdr->next_free = heap.first_free;
-        if (heap.first_free != NULL) {
-            heap.first_free->prev_free = hdr;
-        }
-        heap.first_free = hdr;
-    }
+    insert_free(hdr);
 
     if ((heap.verify & MBEDTLS_MEMORY_VERIFY_FREE) && verify_chain() != 0) {
         mbedtls_exit(1);
@@ -584,7 +746,7 @@ void mbedtls_memory_buffer_alloc_init(unsigned char *buf, size_t len)
     heap.first->size = len - sizeof(memory_header);
     heap.first->magic1 = MAGIC1;
     heap.first->magic2 = MAGIC2;
-    heap.first_free = heap.first;
+    insert_free(heap.first);
 }
 
 void mbedtls_memory_buffer_alloc_free(void)
@@ -615,7 +777,7 @@ static int check_all_free(void)
 #if defined(MBEDTLS_MEMORY_DEBUG)
         heap.total_used != 0 ||
 #endif
-        heap.first != heap.first_free ||
+        heap.first->alloc != 0 || heap.first->next != NULL ||
         (void *) heap.first != (void *) heap.buf) {
         return -1;
     }
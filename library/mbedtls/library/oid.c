@@ -14,6 +14,7 @@
 #include "mbedtls/oid.h"
 #include "mbedtls/rsa.h"
 #include "mbedtls/error.h"
+#include "oid_invasive.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -25,6 +26,46 @@
  */
 #define ADD_LEN(s)      s, MBEDTLS_OID_SIZE(s)
 
+/*
+ * Perfect hash index of an OID table: the OIDs of the table have different
+ * values of
+ *
+ *     len * mul[0] + p[len - 1] * mul[1] + p[len - 2] * mul[2]
+ *
+ * modulo mask + 1, and slot[] holds their position in the table at that
+ * value, or OID_INDEX_NONE. The indexes are generated from the tables by
+ * scripts/generate_oid_index.py into oid_index.h.
+ */
+typedef struct {
+    unsigned char mul[3];
+    unsigned char mask;
+    const unsigned char *slot;
+} oid_index_t;
+
+#define OID_INDEX_NONE  0xFF
+
+#include "oid_index.h"
+
+/*
+ * Return the position in its table of the OID that may be oid, or
+ * OID_INDEX_NONE
+ */
+static unsigned char oid_index_lookup(const oid_index_t *index,
+                                      const mbedtls_asn1_buf *oid)
+{
+    size_t h;
+
+    if (oid->len < 2) {
+        return OID_INDEX_NONE;
+    }
+
+    h = oid->len * index->mul[0] +
+        oid->p[oid->len - 1] * index->mul[1] +
+        oid->p[oid->len - 2] * index->mul[2];
+
+    return index->slot[h & index->mask];
+}
+
 /*
  * Macro to generate an internal function for oid_XXX_from_asn1() (used by
  * the other functions)
@@ -33,19 +74,19 @@
     static const TYPE_T *oid_ ## NAME ## _from_asn1(                   \
         const mbedtls_asn1_buf *oid)     \
     {                                                                   \
-        const TYPE_T *p = (LIST);                                       \
-        const mbedtls_oid_descriptor_t *cur =                           \
-            (const mbedtls_oid_descriptor_t *) p;                       \
-        if (p == NULL || oid == NULL) return NULL;                  \
-        while (cur->asn1 != NULL) {                                    \
-            if (cur->asn1_len == oid->len &&                            \
-                memcmp(cur->asn1, oid->p, oid->len) == 0) {          \
-                return p;                                            \
-            }                                                           \
-            p++;                                                        \
-            cur = (const mbedtls_oid_descriptor_t *) p;                 \
+        const TYPE_T *p;                                                \
+        const mbedtls_oid_descriptor_t *cur;                            \
+        unsigned char i;                                                \
+        if (oid == NULL) return NULL;                                   \
+        i = oid_index_lookup(&LIST ## _index, oid);                     \
+        if (i == OID_INDEX_NONE) return NULL;                           \
+        p = (LIST) + i;                                                 \
+        cur = (const mbedtls_oid_descriptor_t *) p;                     \
+        if (cur->asn1_len == oid->len &&                                \
+            memcmp(cur->asn1, oid->p, oid->len) == 0) {                 \
+            return p;                                                   \
         }                                                               \
-        return NULL;                                                 \
+        return NULL;                                                    \
     }
 
 /*
@@ -832,4 +873,72 @@ int mbedtls_oid_get_numeric_string(char *buf, size_t size,
     return (int) (size - n);
 }
 
+#if defined(MBEDTLS_TEST_HOOKS)
+/*
+ * Check that the index of a table counts the entries of the table, and
+ * finds each of them
+ */
+static int oid_check_index(const void *list, size_t size, size_t count,
+                           const oid_index_t *index)
+{
+    const unsigned char *p = list;
+    const mbedtls_oid_descriptor_t *cur;
+    mbedtls_asn1_buf oid;
+    size_t i;
+
+    cur = (const mbedtls_oid_descriptor_t *) (p + count * size);
+    if (cur->asn1 != NULL) {
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        cur = (const mbedtls_oid_descriptor_t *) (p + i * size);
+        if (cur->asn1 == NULL) {
+            return -1;
+        }
+
+        oid.p = (unsigned char *) cur->asn1;
+        oid.len = cur->asn1_len;
+        if (oid_index_lookup(index, &oid) != i) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+#define OID_CHECK_INDEX(LIST, PREFIX)                                   \
+    oid_check_index((LIST), sizeof((LIST)[0]), PREFIX ## _COUNT,        \
+                    &LIST ## _index)
+
+int mbedtls_oid_check_indexes(void)
+{
+    int ret = 0;
+
+    ret |= OID_CHECK_INDEX(oid_x520_attr_type, OID_X520_ATTR_TYPE);
+    ret |= OID_CHECK_INDEX(oid_x509_ext, OID_X509_EXT);
+    ret |= OID_CHECK_INDEX(oid_ext_key_usage, OID_EXT_KEY_USAGE);
+    ret |= OID_CHECK_INDEX(oid_certificate_policies, OID_CERTIFICATE_POLICIES);
+#if defined(MBEDTLS_MD_C)
+    ret |= OID_CHECK_INDEX(oid_sig_alg, OID_SIG_ALG);
+#endif
+    ret |= OID_CHECK_INDEX(oid_pk_alg, OID_PK_ALG);
+#if defined(MBEDTLS_ECP_C)
+    ret |= OID_CHECK_INDEX(oid_ecp_grp, OID_ECP_GRP);
+#endif
+#if defined(MBEDTLS_CIPHER_C)
+    ret |= OID_CHECK_INDEX(oid_cipher_alg, OID_CIPHER_ALG);
+#endif
+#if defined(MBEDTLS_MD_C)
+    ret |= OID_CHECK_INDEX(oid_md_alg, OID_MD_ALG);
+    ret |= OID_CHECK_INDEX(oid_md_hmac, OID_MD_HMAC);
+#endif
+#if defined(MBEDTLS_PKCS12_C)
+    ret |= OID_CHECK_INDEX(oid_pkcs12_pbe_alg, OID_PKCS12_PBE_ALG);
+#endif
+
+    return ret;
+}
+#endif /* MBEDTLS_TEST_HOOKS */
+
 #endif /* MBEDTLS_OID_C */
@@ -0,0 +1,781 @@
+/**
+ * \file oid_index.h
+ *
+ * \brief Perfect hash indexes of the OID tables of oid.c
+ *
+ * Automatically generated by scripts/generate_oid_index.py from
+ * library/oid.c and include/mbedtls/oid.h. DO NOT EDIT.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+#ifndef MBEDTLS_OID_INDEX_H
+#define MBEDTLS_OID_INDEX_H
+
+/*
+ * oid_x520_attr_type
+ */
+enum {
+    OID_X520_ATTR_TYPE_0 = 0,
+    OID_X520_ATTR_TYPE_1 = OID_X520_ATTR_TYPE_0 + 1,
+    OID_X520_ATTR_TYPE_2 = OID_X520_ATTR_TYPE_1 + 1,
+    OID_X520_ATTR_TYPE_3 = OID_X520_ATTR_TYPE_2 + 1,
+    OID_X520_ATTR_TYPE_4 = OID_X520_ATTR_TYPE_3 + 1,
+    OID_X520_ATTR_TYPE_5 = OID_X520_ATTR_TYPE_4 + 1,
+    OID_X520_ATTR_TYPE_6 = OID_X520_ATTR_TYPE_5 + 1,
+    OID_X520_ATTR_TYPE_7 = OID_X520_ATTR_TYPE_6 + 1,
+    OID_X520_ATTR_TYPE_8 = OID_X520_ATTR_TYPE_7 + 1,
+    OID_X520_ATTR_TYPE_9 = OID_X520_ATTR_TYPE_8 + 1,
+    OID_X520_ATTR_TYPE_10 = OID_X520_ATTR_TYPE_9 + 1,
+    OID_X520_ATTR_TYPE_11 = OID_X520_ATTR_TYPE_10 + 1,
+    OID_X520_ATTR_TYPE_12 = OID_X520_ATTR_TYPE_11 + 1,
+    OID_X520_ATTR_TYPE_13 = OID_X520_ATTR_TYPE_12 + 1,
+    OID_X520_ATTR_TYPE_14 = OID_X520_ATTR_TYPE_13 + 1,
+    OID_X520_ATTR_TYPE_15 = OID_X520_ATTR_TYPE_14 + 1,
+    OID_X520_ATTR_TYPE_16 = OID_X520_ATTR_TYPE_15 + 1,
+    OID_X520_ATTR_TYPE_17 = OID_X520_ATTR_TYPE_16 + 1,
+    OID_X520_ATTR_TYPE_18 = OID_X520_ATTR_TYPE_17 + 1,
+    OID_X520_ATTR_TYPE_COUNT = OID_X520_ATTR_TYPE_18 + 1
+};
+
+static const unsigned char oid_x520_attr_type_slot[64] =
+{
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_X520_ATTR_TYPE_16,              /* MBEDTLS_OID_AT_PSEUDONYM */
+    OID_INDEX_NONE,
+    OID_X520_ATTR_TYPE_0,               /* MBEDTLS_OID_AT_CN */
+    OID_X520_ATTR_TYPE_10,              /* MBEDTLS_OID_AT_SUR_NAME */
+    OID_X520_ATTR_TYPE_7,               /* MBEDTLS_OID_AT_SERIAL_NUMBER */
+    OID_X520_ATTR_TYPE_1,               /* MBEDTLS_OID_AT_COUNTRY */
+    OID_X520_ATTR_TYPE_2,               /* MBEDTLS_OID_AT_LOCALITY */
+    OID_X520_ATTR_TYPE_3,               /* MBEDTLS_OID_AT_STATE */
+    OID_INDEX_NONE,
+    OID_X520_ATTR_TYPE_4,               /* MBEDTLS_OID_AT_ORGANIZATION */
+    OID_X520_ATTR_TYPE_5,               /* MBEDTLS_OID_AT_ORG_UNIT */
+    OID_X520_ATTR_TYPE_14,              /* MBEDTLS_OID_AT_TITLE */
+    OID_X520_ATTR_TYPE_17,              /* MBEDTLS_OID_DOMAIN_COMPONENT */
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_X520_ATTR_TYPE_8,               /* MBEDTLS_OID_AT_POSTAL_ADDRESS */
+    OID_X520_ATTR_TYPE_9,               /* MBEDTLS_OID_AT_POSTAL_CODE */
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_X520_ATTR_TYPE_6,               /* MBEDTLS_OID_PKCS9_EMAIL */
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_X520_ATTR_TYPE_11,              /* MBEDTLS_OID_AT_GIVEN_NAME */
+    OID_X520_ATTR_TYPE_12,              /* MBEDTLS_OID_AT_INITIALS */
+    OID_X520_ATTR_TYPE_13,              /* MBEDTLS_OID_AT_GENERATION_QUALIFIER */
+    OID_X520_ATTR_TYPE_18,              /* MBEDTLS_OID_AT_UNIQUE_IDENTIFIER */
+    OID_X520_ATTR_TYPE_15,              /* MBEDTLS_OID_AT_DN_QUALIFIER */
+    OID_INDEX_NONE,
+};
+
+static const oid_index_t oid_x520_attr_type_index =
+{
+    { 0, 1, 4 }, 63, oid_x520_attr_type_slot
+};
+
+/*
+ * oid_x509_ext
+ */
+enum {
+    OID_X509_EXT_0 = 0,
+    OID_X509_EXT_1 = OID_X509_EXT_0 + 1,
+    OID_X509_EXT_2 = OID_X509_EXT_1 + 1,
+    OID_X509_EXT_3 = OID_X509_EXT_2 + 1,
+    OID_X509_EXT_4 = OID_X509_EXT_3 + 1,
+    OID_X509_EXT_5 = OID_X509_EXT_4 + 1,
+    OID_X509_EXT_COUNT = OID_X509_EXT_5 + 1
+};
+
+static const unsigned char oid_x509_ext_slot[16] =
+{
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_X509_EXT_4,                     /* MBEDTLS_OID_NS_CERT_TYPE */
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_X509_EXT_1,                     /* MBEDTLS_OID_KEY_USAGE */
+    OID_X509_EXT_5,                     /* MBEDTLS_OID_CERTIFICATE_POLICIES */
+    OID_X509_EXT_3,                     /* MBEDTLS_OID_SUBJECT_ALT_NAME */
+    OID_INDEX_NONE,
+    OID_X509_EXT_0,                     /* MBEDTLS_OID_BASIC_CONSTRAINTS */
+    OID_INDEX_NONE,
+    OID_X509_EXT_2,                     /* MBEDTLS_OID_EXTENDED_KEY_USAGE */
+};
+
+static const oid_index_t oid_x509_ext_index =
+{
+    { 0, 1, 2 }, 15, oid_x509_ext_slot
+};
+
+/*
+ * oid_ext_key_usage
+ */
+enum {
+    OID_EXT_KEY_USAGE_0 = 0,
+    OID_EXT_KEY_USAGE_1 = OID_EXT_KEY_USAGE_0 + 1,
+    OID_EXT_KEY_USAGE_2 = OID_EXT_KEY_USAGE_1 + 1,
+    OID_EXT_KEY_USAGE_3 = OID_EXT_KEY_USAGE_2 + 1,
+    OID_EXT_KEY_USAGE_4 = OID_EXT_KEY_USAGE_3 + 1,
+    OID_EXT_KEY_USAGE_5 = OID_EXT_KEY_USAGE_4 + 1,
+    OID_EXT_KEY_USAGE_6 = OID_EXT_KEY_USAGE_5 + 1,
+    OID_EXT_KEY_USAGE_COUNT = OID_EXT_KEY_USAGE_6 + 1
+};
+
+static const unsigned char oid_ext_key_usage_slot[16] =
+{
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_EXT_KEY_USAGE_0,                /* MBEDTLS_OID_SERVER_AUTH */
+    OID_EXT_KEY_USAGE_1,                /* MBEDTLS_OID_CLIENT_AUTH */
+    OID_EXT_KEY_USAGE_2,                /* MBEDTLS_OID_CODE_SIGNING */
+    OID_EXT_KEY_USAGE_3,                /* MBEDTLS_OID_EMAIL_PROTECTION */
+    OID_EXT_KEY_USAGE_6,                /* MBEDTLS_OID_WISUN_FAN */
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_EXT_KEY_USAGE_4,                /* MBEDTLS_OID_TIME_STAMPING */
+    OID_EXT_KEY_USAGE_5,                /* MBEDTLS_OID_OCSP_SIGNING */
+};
+
+static const oid_index_t oid_ext_key_usage_index =
+{
+    { 0, 1, 2 }, 15, oid_ext_key_usage_slot
+};
+
+/*
+ * oid_certificate_policies
+ */
+enum {
+    OID_CERTIFICATE_POLICIES_0 = 0,
+    OID_CERTIFICATE_POLICIES_COUNT = OID_CERTIFICATE_POLICIES_0 + 1
+};
+
+static const unsigned char oid_certificate_policies_slot[1] =
+{
+    OID_CERTIFICATE_POLICIES_0,         /* MBEDTLS_OID_ANY_POLICY */
+};
+
+static const oid_index_t oid_certificate_policies_index =
+{
+    { 0, 0, 0 }, 0, oid_certificate_policies_slot
+};
+
+/*
+ * oid_sig_alg
+ */
+#if defined(MBEDTLS_MD_C)
+enum {
+    OID_SIG_ALG_0 = 0,
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD2_C)
+    OID_SIG_ALG_1 = OID_SIG_ALG_0 + 1,
+#else
+    OID_SIG_ALG_1 = OID_SIG_ALG_0,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD4_C)
+    OID_SIG_ALG_2 = OID_SIG_ALG_1 + 1,
+#else
+    OID_SIG_ALG_2 = OID_SIG_ALG_1,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD5_C)
+    OID_SIG_ALG_3 = OID_SIG_ALG_2 + 1,
+#else
+    OID_SIG_ALG_3 = OID_SIG_ALG_2,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_4 = OID_SIG_ALG_3 + 1,
+#else
+    OID_SIG_ALG_4 = OID_SIG_ALG_3,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_5 = OID_SIG_ALG_4 + 1,
+#else
+    OID_SIG_ALG_5 = OID_SIG_ALG_4,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_6 = OID_SIG_ALG_5 + 1,
+#else
+    OID_SIG_ALG_6 = OID_SIG_ALG_5,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_7 = OID_SIG_ALG_6 + 1,
+#else
+    OID_SIG_ALG_7 = OID_SIG_ALG_6,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_8 = OID_SIG_ALG_7 + 1,
+#else
+    OID_SIG_ALG_8 = OID_SIG_ALG_7,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_9 = OID_SIG_ALG_8 + 1,
+#else
+    OID_SIG_ALG_9 = OID_SIG_ALG_8,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_10 = OID_SIG_ALG_9 + 1,
+#else
+    OID_SIG_ALG_10 = OID_SIG_ALG_9,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_11 = OID_SIG_ALG_10 + 1,
+#else
+    OID_SIG_ALG_11 = OID_SIG_ALG_10,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_12 = OID_SIG_ALG_11 + 1,
+#else
+    OID_SIG_ALG_12 = OID_SIG_ALG_11,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_13 = OID_SIG_ALG_12 + 1,
+#else
+    OID_SIG_ALG_13 = OID_SIG_ALG_12,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_14 = OID_SIG_ALG_13 + 1,
+#else
+    OID_SIG_ALG_14 = OID_SIG_ALG_13,
+#endif
+#if defined(MBEDTLS_RSA_C)
+    OID_SIG_ALG_COUNT = OID_SIG_ALG_14 + 1
+#else
+    OID_SIG_ALG_COUNT = OID_SIG_ALG_14
+#endif
+};
+
+static const unsigned char oid_sig_alg_slot[32] =
+{
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_9,                      /* MBEDTLS_OID_ECDSA_SHA1 */
+#else
+    OID_INDEX_NONE,
+#endif
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD2_C)
+    OID_SIG_ALG_0,                      /* MBEDTLS_OID_PKCS1_MD2 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD4_C)
+    OID_SIG_ALG_1,                      /* MBEDTLS_OID_PKCS1_MD4 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD5_C)
+    OID_SIG_ALG_2,                      /* MBEDTLS_OID_PKCS1_MD5 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_3,                      /* MBEDTLS_OID_PKCS1_SHA1 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_8,                      /* MBEDTLS_OID_RSA_SHA_OBS */
+#else
+    OID_INDEX_NONE,
+#endif
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_RSA_C)
+    OID_SIG_ALG_14,                     /* MBEDTLS_OID_RSASSA_PSS */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_5,                      /* MBEDTLS_OID_PKCS1_SHA256 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_6,                      /* MBEDTLS_OID_PKCS1_SHA384 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_7,                      /* MBEDTLS_OID_PKCS1_SHA512 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_4,                      /* MBEDTLS_OID_PKCS1_SHA224 */
+#else
+    OID_INDEX_NONE,
+#endif
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_10,                     /* MBEDTLS_OID_ECDSA_SHA224 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_11,                     /* MBEDTLS_OID_ECDSA_SHA256 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_12,                     /* MBEDTLS_OID_ECDSA_SHA384 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_13,                     /* MBEDTLS_OID_ECDSA_SHA512 */
+#else
+    OID_INDEX_NONE,
+#endif
+};
+
+static const oid_index_t oid_sig_alg_index =
+{
+    { 0, 1, 9 }, 31, oid_sig_alg_slot
+};
+#endif /* defined(MBEDTLS_MD_C) */
+
+/*
+ * oid_pk_alg
+ */
+enum {
+    OID_PK_ALG_0 = 0,
+    OID_PK_ALG_1 = OID_PK_ALG_0 + 1,
+    OID_PK_ALG_2 = OID_PK_ALG_1 + 1,
+    OID_PK_ALG_COUNT = OID_PK_ALG_2 + 1
+};
+
+static const unsigned char oid_pk_alg_slot[4] =
+{
+    OID_INDEX_NONE,
+    OID_PK_ALG_2,                       /* MBEDTLS_OID_EC_ALG_ECDH */
+    OID_PK_ALG_0,                       /* MBEDTLS_OID_PKCS1_RSA */
+    OID_PK_ALG_1,                       /* MBEDTLS_OID_EC_ALG_UNRESTRICTED */
+};
+
+static const oid_index_t oid_pk_alg_index =
+{
+    { 0, 1, 1 }, 3, oid_pk_alg_slot
+};
+
+/*
+ * oid_ecp_grp
+ */
+#if defined(MBEDTLS_ECP_C)
+enum {
+    OID_ECP_GRP_0 = 0,
+#if defined(MBEDTLS_ECP_DP_SECP192R1_ENABLED)
+    OID_ECP_GRP_1 = OID_ECP_GRP_0 + 1,
+#else
+    OID_ECP_GRP_1 = OID_ECP_GRP_0,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP224R1_ENABLED)
+    OID_ECP_GRP_2 = OID_ECP_GRP_1 + 1,
+#else
+    OID_ECP_GRP_2 = OID_ECP_GRP_1,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+    OID_ECP_GRP_3 = OID_ECP_GRP_2 + 1,
+#else
+    OID_ECP_GRP_3 = OID_ECP_GRP_2,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP384R1_ENABLED)
+    OID_ECP_GRP_4 = OID_ECP_GRP_3 + 1,
+#else
+    OID_ECP_GRP_4 = OID_ECP_GRP_3,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP521R1_ENABLED)
+    OID_ECP_GRP_5 = OID_ECP_GRP_4 + 1,
+#else
+    OID_ECP_GRP_5 = OID_ECP_GRP_4,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP192K1_ENABLED)
+    OID_ECP_GRP_6 = OID_ECP_GRP_5 + 1,
+#else
+    OID_ECP_GRP_6 = OID_ECP_GRP_5,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP224K1_ENABLED)
+    OID_ECP_GRP_7 = OID_ECP_GRP_6 + 1,
+#else
+    OID_ECP_GRP_7 = OID_ECP_GRP_6,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+    OID_ECP_GRP_8 = OID_ECP_GRP_7 + 1,
+#else
+    OID_ECP_GRP_8 = OID_ECP_GRP_7,
+#endif
+#if defined(MBEDTLS_ECP_DP_BP256R1_ENABLED)
+    OID_ECP_GRP_9 = OID_ECP_GRP_8 + 1,
+#else
+    OID_ECP_GRP_9 = OID_ECP_GRP_8,
+#endif
+#if defined(MBEDTLS_ECP_DP_BP384R1_ENABLED)
+    OID_ECP_GRP_10 = OID_ECP_GRP_9 + 1,
+#else
+    OID_ECP_GRP_10 = OID_ECP_GRP_9,
+#endif
+#if defined(MBEDTLS_ECP_DP_BP512R1_ENABLED)
+    OID_ECP_GRP_COUNT = OID_ECP_GRP_10 + 1
+#else
+    OID_ECP_GRP_COUNT = OID_ECP_GRP_10
+#endif
+};
+
+static const unsigned char oid_ecp_grp_slot[16] =
+{
+#if defined(MBEDTLS_ECP_DP_BP512R1_ENABLED)
+    OID_ECP_GRP_10,                     /* MBEDTLS_OID_EC_GRP_BP512R1 */
+#else
+    OID_INDEX_NONE,
+#endif
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_ECP_DP_SECP192R1_ENABLED)
+    OID_ECP_GRP_0,                      /* MBEDTLS_OID_EC_GRP_SECP192R1 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP192K1_ENABLED)
+    OID_ECP_GRP_5,                      /* MBEDTLS_OID_EC_GRP_SECP192K1 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP224K1_ENABLED)
+    OID_ECP_GRP_6,                      /* MBEDTLS_OID_EC_GRP_SECP224K1 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP224R1_ENABLED)
+    OID_ECP_GRP_1,                      /* MBEDTLS_OID_EC_GRP_SECP224R1 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP384R1_ENABLED)
+    OID_ECP_GRP_3,                      /* MBEDTLS_OID_EC_GRP_SECP384R1 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP521R1_ENABLED)
+    OID_ECP_GRP_4,                      /* MBEDTLS_OID_EC_GRP_SECP521R1 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+    OID_ECP_GRP_2,                      /* MBEDTLS_OID_EC_GRP_SECP256R1 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_BP256R1_ENABLED)
+    OID_ECP_GRP_8,                      /* MBEDTLS_OID_EC_GRP_BP256R1 */
+#else
+    OID_INDEX_NONE,
+#endif
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_ECP_DP_BP384R1_ENABLED)
+    OID_ECP_GRP_9,                      /* MBEDTLS_OID_EC_GRP_BP384R1 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+    OID_ECP_GRP_7,                      /* MBEDTLS_OID_EC_GRP_SECP256K1 */
+#else
+    OID_INDEX_NONE,
+#endif
+};
+
+static const oid_index_t oid_ecp_grp_index =
+{
+    { 1, 1, 10 }, 15, oid_ecp_grp_slot
+};
+#endif /* defined(MBEDTLS_ECP_C) */
+
+/*
+ * oid_cipher_alg
+ */
+#if defined(MBEDTLS_CIPHER_C)
+enum {
+    OID_CIPHER_ALG_0 = 0,
+    OID_CIPHER_ALG_1 = OID_CIPHER_ALG_0 + 1,
+    OID_CIPHER_ALG_COUNT = OID_CIPHER_ALG_1 + 1
+};
+
+static const unsigned char oid_cipher_alg_slot[2] =
+{
+    OID_CIPHER_ALG_0,                   /* MBEDTLS_OID_DES_CBC */
+    OID_CIPHER_ALG_1,                   /* MBEDTLS_OID_DES_EDE3_CBC */
+};
+
+static const oid_index_t oid_cipher_alg_index =
+{
+    { 0, 0, 1 }, 1, oid_cipher_alg_slot
+};
+#endif /* defined(MBEDTLS_CIPHER_C) */
+
+/*
+ * oid_md_alg
+ */
+#if defined(MBEDTLS_MD_C)
+enum {
+    OID_MD_ALG_0 = 0,
+#if defined(MBEDTLS_MD2_C)
+    OID_MD_ALG_1 = OID_MD_ALG_0 + 1,
+#else
+    OID_MD_ALG_1 = OID_MD_ALG_0,
+#endif
+#if defined(MBEDTLS_MD4_C)
+    OID_MD_ALG_2 = OID_MD_ALG_1 + 1,
+#else
+    OID_MD_ALG_2 = OID_MD_ALG_1,
+#endif
+#if defined(MBEDTLS_MD5_C)
+    OID_MD_ALG_3 = OID_MD_ALG_2 + 1,
+#else
+    OID_MD_ALG_3 = OID_MD_ALG_2,
+#endif
+#if defined(MBEDTLS_SHA1_C)
+    OID_MD_ALG_4 = OID_MD_ALG_3 + 1,
+#else
+    OID_MD_ALG_4 = OID_MD_ALG_3,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_ALG_5 = OID_MD_ALG_4 + 1,
+#else
+    OID_MD_ALG_5 = OID_MD_ALG_4,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_ALG_6 = OID_MD_ALG_5 + 1,
+#else
+    OID_MD_ALG_6 = OID_MD_ALG_5,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_ALG_7 = OID_MD_ALG_6 + 1,
+#else
+    OID_MD_ALG_7 = OID_MD_ALG_6,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_ALG_8 = OID_MD_ALG_7 + 1,
+#else
+    OID_MD_ALG_8 = OID_MD_ALG_7,
+#endif
+#if defined(MBEDTLS_RIPEMD160_C)
+    OID_MD_ALG_COUNT = OID_MD_ALG_8 + 1
+#else
+    OID_MD_ALG_COUNT = OID_MD_ALG_8
+#endif
+};
+
+static const unsigned char oid_md_alg_slot[16] =
+{
+#if defined(MBEDTLS_MD4_C)
+    OID_MD_ALG_1,                       /* MBEDTLS_OID_DIGEST_ALG_MD4 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_ALG_4,                       /* MBEDTLS_OID_DIGEST_ALG_SHA224 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_MD5_C)
+    OID_MD_ALG_2,                       /* MBEDTLS_OID_DIGEST_ALG_MD5 */
+#else
+    OID_INDEX_NONE,
+#endif
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_RIPEMD160_C)
+    OID_MD_ALG_8,                       /* MBEDTLS_OID_DIGEST_ALG_RIPEMD160 */
+#else
+    OID_INDEX_NONE,
+#endif
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_SHA1_C)
+    OID_MD_ALG_3,                       /* MBEDTLS_OID_DIGEST_ALG_SHA1 */
+#else
+    OID_INDEX_NONE,
+#endif
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_ALG_5,                       /* MBEDTLS_OID_DIGEST_ALG_SHA256 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_MD2_C)
+    OID_MD_ALG_0,                       /* MBEDTLS_OID_DIGEST_ALG_MD2 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_ALG_6,                       /* MBEDTLS_OID_DIGEST_ALG_SHA384 */
+#else
+    OID_INDEX_NONE,
+#endif
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_ALG_7,                       /* MBEDTLS_OID_DIGEST_ALG_SHA512 */
+#else
+    OID_INDEX_NONE,
+#endif
+};
+
+static const oid_index_t oid_md_alg_index =
+{
+    { 1, 2, 0 }, 15, oid_md_alg_slot
+};
+#endif /* defined(MBEDTLS_MD_C) */
+
+/*
+ * oid_md_hmac
+ */
+#if defined(MBEDTLS_MD_C)
+enum {
+    OID_MD_HMAC_0 = 0,
+#if defined(MBEDTLS_SHA1_C)
+    OID_MD_HMAC_1 = OID_MD_HMAC_0 + 1,
+#else
+    OID_MD_HMAC_1 = OID_MD_HMAC_0,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_HMAC_2 = OID_MD_HMAC_1 + 1,
+#else
+    OID_MD_HMAC_2 = OID_MD_HMAC_1,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_HMAC_3 = OID_MD_HMAC_2 + 1,
+#else
+    OID_MD_HMAC_3 = OID_MD_HMAC_2,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_HMAC_4 = OID_MD_HMAC_3 + 1,
+#else
+    OID_MD_HMAC_4 = OID_MD_HMAC_3,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_HMAC_COUNT = OID_MD_HMAC_4 + 1
+#else
+    OID_MD_HMAC_COUNT = OID_MD_HMAC_4
+#endif
+};
+
+static const unsigned char oid_md_hmac_slot[8] =
+{
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_HMAC_1,                      /* MBEDTLS_OID_HMAC_SHA224 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_HMAC_2,                      /* MBEDTLS_OID_HMAC_SHA256 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_HMAC_3,                      /* MBEDTLS_OID_HMAC_SHA384 */
+#else
+    OID_INDEX_NONE,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_HMAC_4,                      /* MBEDTLS_OID_HMAC_SHA512 */
+#else
+    OID_INDEX_NONE,
+#endif
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+    OID_INDEX_NONE,
+#if defined(MBEDTLS_SHA1_C)
+    OID_MD_HMAC_0,                      /* MBEDTLS_OID_HMAC_SHA1 */
+#else
+    OID_INDEX_NONE,
+#endif
+};
+
+static const oid_index_t oid_md_hmac_index =
+{
+    { 0, 1, 0 }, 7, oid_md_hmac_slot
+};
+#endif /* defined(MBEDTLS_MD_C) */
+
+/*
+ * oid_pkcs12_pbe_alg
+ */
+#if defined(MBEDTLS_PKCS12_C)
+enum {
+    OID_PKCS12_PBE_ALG_0 = 0,
+    OID_PKCS12_PBE_ALG_1 = OID_PKCS12_PBE_ALG_0 + 1,
+    OID_PKCS12_PBE_ALG_COUNT = OID_PKCS12_PBE_ALG_1 + 1
+};
+
+static const unsigned char oid_pkcs12_pbe_alg_slot[2] =
+{
+    OID_PKCS12_PBE_ALG_1,               /* MBEDTLS_OID_PKCS12_PBE_SHA1_DES2_EDE_CBC */
+    OID_PKCS12_PBE_ALG_0,               /* MBEDTLS_OID_PKCS12_PBE_SHA1_DES3_EDE_CBC */
+};
+
+static const oid_index_t oid_pkcs12_pbe_alg_index =
+{
+    { 0, 1, 0 }, 1, oid_pkcs12_pbe_alg_slot
+};
+#endif /* defined(MBEDTLS_PKCS12_C) */
+
+#endif /* MBEDTLS_OID_INDEX_H */
@@ -0,0 +1,31 @@
+/**
+ * \file oid_invasive.h
+ *
+ * \brief OID module: interfaces for invasive testing only.
+ *
+ * The interfaces in this file are intended for testing purposes only.
+ * They SHOULD NOT be made available in library integrations except when
+ * building the library for testing.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+#ifndef MBEDTLS_OID_INVASIVE_H
+#define MBEDTLS_OID_INVASIVE_H
+
+#include "common.h"
+
+#if defined(MBEDTLS_TEST_HOOKS) && defined(MBEDTLS_OID_C)
+
+/** Check the perfect hash indexes of the OID tables (see oid_index.h)
+ *  against the tables: each index must find every OID of its table at its
+ *  position, and count the entries of the table in this configuration.
+ *
+ * \return         \c 0 if all indexes are consistent, \c -1 otherwise.
+ */
+int mbedtls_oid_check_indexes(void);
+
+#endif /* MBEDTLS_TEST_HOOKS && MBEDTLS_OID_C */
+
+#endif /* MBEDTLS_OID_INVASIVE_H */
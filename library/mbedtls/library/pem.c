@@ -370,11 +370,8 @@ int mbedtls_pem_read_buffer(mbedtls_pem_context *ctx, const char *header, const
         return MBEDTLS_ERR_PEM_INVALID_DATA;
     }
 
-    ret = mbedtls_base64_decode(NULL, 0, &len, s1, s2 - s1);
-
-    if (ret == MBEDTLS_ERR_BASE64_INVALID_CHARACTER) {
-        return MBEDTLS_ERROR_ADD(MBEDTLS_ERR_PEM_INVALID_DATA, ret);
-    }
+    /* Room for any output, so that decoding takes a single pass */
+    len = mbedtls_base64_decode_bound(s2 - s1);
 
     if ((buf = mbedtls_calloc(1, len)) == NULL) {
         return MBEDTLS_ERR_PEM_ALLOC_FAILED;
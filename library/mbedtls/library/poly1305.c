@@ -55,6 +55,118 @@ static inline uint64_t mul64(uint32_t a, uint32_t b)
 }
 #endif
 
+/*
+ * Where the compiler has a 128-bit integer type, the accumulator and r are
+ * split into three limbs of 44, 44 and 42 bits while blocks are processed,
+ * which takes 9 64x64-bit multiplications per block instead of 20 32x32-bit
+ * ones. The context keeps the 32-bit representation, which is converted
+ * on entry and exit of poly1305_process().
+ */
+#if defined(__GNUC__) && defined(__SIZEOF_INT128__) && \
+    !defined(MBEDTLS_NO_64BIT_MULTIPLICATION)
+#define POLY1305_USE_64BIT_LIMBS
+typedef unsigned int poly1305_uint128 __attribute__((mode(TI)));
+
+#define POLY1305_MASK44 ((UINT64_C(1) << 44) - 1U)
+#define POLY1305_MASK42 ((UINT64_C(1) << 42) - 1U)
+#endif
+
+#if defined(POLY1305_USE_64BIT_LIMBS)
+
+/**
+ * \brief                   Process blocks with Poly1305.
+ *
+ * \param ctx               The Poly1305 context.
+ * \param nblocks           Number of blocks to process. Note that this
+ *                          function only processes full blocks.
+ * \param input             Buffer containing the input block(s).
+ * \param needs_padding     Set to 0 if the padding bit has already been
+ *                          applied to the input data before calling this
+ *                          function.  Otherwise, set this parameter to 1.
+ */
+static void poly1305_process(mbedtls_poly1305_context *ctx,
+                             size_t nblocks,
+                             const unsigned char *input,
+                             uint32_t needs_padding)
+{
+    poly1305_uint128 d0, d1, d2;
+    uint64_t h0, h1, h2;
+    uint64_t r0, r1, r2;
+    uint64_t rs1, rs2;
+    uint64_t t0, t1, c;
+    const uint64_t hibit = (uint64_t) needs_padding << 40;
+    size_t offset  = 0U;
+    size_t i;
+
+    t0 = (uint64_t) ctx->r[0] | ((uint64_t) ctx->r[1] << 32);
+    t1 = (uint64_t) ctx->r[2] | ((uint64_t) ctx->r[3] << 32);
+    r0 = t0 & POLY1305_MASK44;
+    r1 = ((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44;
+    r2 = t1 >> 24;
+
+    /* 2^132 = 4 * 5 (mod 2^130 - 5) */
+    rs1 = r1 * 20U;
+    rs2 = r2 * 20U;
+
+    /* The accumulator is partially reduced: acc4 may exceed 2 bits, in
+     * which case h2 holds more than 42 bits. This is fine as long as the
+     * products below cannot overflow. */
+    t0 = (uint64_t) ctx->acc[0] | ((uint64_t) ctx->acc[1] << 32);
+    t1 = (uint64_t) ctx->acc[2] | ((uint64_t) ctx->acc[3] << 32);
+    h0 = t0 & POLY1305_MASK44;
+    h1 = ((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44;
+    h2 = (t1 >> 24) | ((uint64_t) ctx->acc[4] << 40);
+
+    /* Process full blocks */
+    for (i = 0U; i < nblocks; i++) {
+        /* The input block is treated as a 128-bit little-endian integer */
+        t0 = MBEDTLS_GET_UINT64_LE(input, offset + 0);
+        t1 = MBEDTLS_GET_UINT64_LE(input, offset + 8);
+
+        /* Compute: acc += (padded) block as a 130-bit integer */
+        h0 += t0 & POLY1305_MASK44;
+        h1 += ((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44;
+        h2 += (t1 >> 24) | hibit;
+
+        /* Compute: acc *= r */
+        d0 = (poly1305_uint128) h0 * r0 +
+             (poly1305_uint128) h1 * rs2 +
+             (poly1305_uint128) h2 * rs1;
+        d1 = (poly1305_uint128) h0 * r1 +
+             (poly1305_uint128) h1 * r0 +
+             (poly1305_uint128) h2 * rs2;
+        d2 = (poly1305_uint128) h0 * r2 +
+             (poly1305_uint128) h1 * r1 +
+             (poly1305_uint128) h2 * r0;
+
+        /* Compute: acc %= (2^130 - 5) (partial remainder) */
+        c  = (uint64_t) (d0 >> 44);
+        h0 = (uint64_t) d0 & POLY1305_MASK44;
+        d1 += c;
+        c  = (uint64_t) (d1 >> 44);
+        h1 = (uint64_t) d1 & POLY1305_MASK44;
+        d2 += c;
+        c  = (uint64_t) (d2 >> 42);
+        h2 = (uint64_t) d2 & POLY1305_MASK42;
+        h0 += c * 5U;
+        c  = h0 >> 44;
+        h0 &= POLY1305_MASK44;
+        h1 += c;
+
+        offset    += POLY1305_BLOCK_SIZE_BYTES;
+    }
+
+    /* Back to 32-bit words: acc = h0 + 2^44 h1 + 2^88 h2 */
+    d0 = (poly1305_uint128) h0 + ((poly1305_uint128) h1 << 44);
+    ctx->acc[0] = (uint32_t) d0;
+    ctx->acc[1] = (uint32_t) (d0 >> 32);
+    d0 = (d0 >> 64) + ((poly1305_uint128) h2 << 24);
+    ctx->acc[2] = (uint32_t) d0;
+    ctx->acc[3] = (uint32_t) (d0 >> 32);
+    ctx->acc[4] = (uint32_t) (d0 >> 64);
+}
+
+#else /* POLY1305_USE_64BIT_LIMBS */
 
 /**
  * \brief                   Process blocks with Poly1305.
@@ -167,6 +279,8 @@ static void poly1305_process(mbedtls_poly1305_context *ctx,
     ctx->acc[4] = acc4;
 }
 
+#endif /* POLY1305_USE_64BIT_LIMBS */
+
 /**
  * \brief                   Compute the Poly1305 MAC
  *
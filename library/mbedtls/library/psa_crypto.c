@@ -22,6 +22,7 @@
 #include "psa_crypto_driver_wrappers.h"
 #include "psa_crypto_ecp.h"
 #include "psa_crypto_hash.h"
+#include "psa_crypto_its.h"
 #include "psa_crypto_mac.h"
 #include "psa_crypto_rsa.h"
 #include "psa_crypto_ecp.h"
@@ -1065,9 +1066,9 @@ psa_status_t psa_wipe_key_slot(psa_key_slot_t *slot)
      * phase, they have a copy of the key. Note that this means that
      * key material can linger until all operations are completed. */
     /* At this point, key material and other type-specific content has
-     * been wiped. Clear remaining metadata. We can call memset and not
-     * zeroize because the metadata is not particularly sensitive. */
-    memset(slot, 0, sizeof(*slot));
+     * been wiped. Clear remaining metadata and return the slot to the
+     * key store. */
+    psa_free_key_slot(slot);
     return status;
 }
 
@@ -1662,6 +1663,7 @@ static psa_status_t psa_start_key_creation(
         slot->attr.id.key_id = volatile_key_id;
 #endif
     }
+    psa_index_key_slot(slot);
 
     /* Erase external-only flags from the internal copy. To access
      * external-only flags, query `attributes`. Thanks to the check
@@ -5431,6 +5433,10 @@ void mbedtls_psa_crypto_free(void)
 
     /* Terminate drivers */
     psa_driver_wrapper_free();
+
+#if defined(MBEDTLS_PSA_ITS_LOG_C)
+    psa_its_log_close();
+#endif
 }
 
 #if defined(PSA_CRYPTO_STORAGE_HAS_TRANSACTIONS)
@@ -76,6 +76,15 @@ typedef struct {
         uint8_t *data;
         size_t bytes;
     } key;
+
+    /* Key store bookkeeping, which belongs to psa_crypto_slot_management.c
+     * and is kept when the slot is wiped: the position of the slot in the
+     * key store, the position plus one of the next slot on the same list
+     * (0 at the end of the list), and which list the slot is on: the list
+     * of free slots, a bucket of the key identifier index, or neither. */
+    size_t store_index;
+    size_t store_next;
+    uint8_t store_list;
 } psa_key_slot_t;
 
 /* A mask of key attribute flags used only internally.
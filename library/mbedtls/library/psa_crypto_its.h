@@ -124,6 +124,16 @@ psa_status_t psa_its_get_info(psa_storage_uid_t uid,
  */
 psa_status_t psa_its_remove(psa_storage_uid_t uid);
 
+#if defined(MBEDTLS_PSA_ITS_LOG_C)
+/**
+ * \brief Close the log of the ITS log backend and free its index
+ *
+ * The log is read again by the next call to one of the functions above.
+ * This is called by mbedtls_psa_crypto_free().
+ */
+void psa_its_log_close(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,13 +26,176 @@
 
 #define ARRAY_LENGTH(array) (sizeof(array) / sizeof(*(array)))
 
+/*
+ * Key slots are allocated on demand, in chunks of PSA_KEY_SLOT_CHUNK_SIZE
+ * slots, up to MBEDTLS_PSA_KEY_SLOT_COUNT slots. Chunks never move, so
+ * pointers to slots remain valid when the key store grows.
+ *
+ * Slot i is global_data.chunks[i / PSA_KEY_SLOT_CHUNK_SIZE]
+ * [i % PSA_KEY_SLOT_CHUNK_SIZE]. The slot of a volatile key is given by its
+ * identifier. The slots of other keys are found through a hash index of
+ * their identifier, which chains the slots of each bucket through their
+ * store_next field. The free slots are chained through the same field.
+ */
+#define PSA_KEY_SLOT_CHUNK_SIZE 16
+#define PSA_KEY_SLOT_CHUNK_COUNT                                  \
+    ((MBEDTLS_PSA_KEY_SLOT_COUNT + PSA_KEY_SLOT_CHUNK_SIZE - 1) / \
+     PSA_KEY_SLOT_CHUNK_SIZE)
+
+/* Values of psa_key_slot_t::store_list */
+#define PSA_KEY_SLOT_LIST_NONE  0
+#define PSA_KEY_SLOT_LIST_FREE  1
+#define PSA_KEY_SLOT_LIST_INDEX 2
+
 typedef struct {
-    psa_key_slot_t key_slots[MBEDTLS_PSA_KEY_SLOT_COUNT];
+    psa_key_slot_t *chunks[PSA_KEY_SLOT_CHUNK_COUNT];
+    size_t slot_count;          /* Number of allocated slots */
+    size_t first_free;          /* Position plus one of the first free slot */
+    size_t *buckets;            /* Position plus one of the first slot */
+    size_t bucket_count;        /* Power of 2, or 0 if buckets is NULL */
     unsigned key_slots_initialized : 1;
 } psa_global_data_t;
 
 static psa_global_data_t global_data;
 
+static inline psa_key_slot_t *psa_key_slot_at(size_t slot_idx)
+{
+    return &global_data.chunks[slot_idx / PSA_KEY_SLOT_CHUNK_SIZE]
+           [slot_idx % PSA_KEY_SLOT_CHUNK_SIZE];
+}
+
+static size_t psa_key_id_bucket(mbedtls_svc_key_id_t key)
+{
+    uint32_t h = MBEDTLS_SVC_KEY_ID_GET_KEY_ID(key);
+
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_ID_ENCODES_OWNER)
+    h ^= (uint32_t) MBEDTLS_SVC_KEY_ID_GET_OWNER_ID(key) * 0x85EBCA6BU;
+#endif
+    /* Key identifiers are often consecutive: mix them over all the bits */
+    h *= 0x9E3779B1U;
+    h ^= h >> 16;
+    return (size_t) h & (global_data.bucket_count - 1);
+}
+
+/** Add a slot to the bucket of the index for its key identifier, after the
+ * slots already there, so that a lookup finds the oldest slot first.
+ */
+static void psa_key_slot_link(psa_key_slot_t *slot)
+{
+    size_t *link = &global_data.buckets[psa_key_id_bucket(slot->attr.id)];
+
+    while (*link != 0) {
+        link = &psa_key_slot_at(*link - 1)->store_next;
+    }
+    *link = slot->store_index + 1;
+    slot->store_next = 0;
+    slot->store_list = PSA_KEY_SLOT_LIST_INDEX;
+}
+
+/** Remove a slot from its bucket of the key identifier index. */
+static void psa_key_slot_unlink(psa_key_slot_t *slot)
+{
+    size_t *link = &global_data.buckets[psa_key_id_bucket(slot->attr.id)];
+
+    while (*link != 0) {
+        if (*link == slot->store_index + 1) {
+            *link = slot->store_next;
+            break;
+        }
+        link = &psa_key_slot_at(*link - 1)->store_next;
+    }
+    slot->store_next = 0;
+    slot->store_list = PSA_KEY_SLOT_LIST_NONE;
+}
+
+/** Resize the key identifier index to at least one bucket per slot.
+ *
+ * If the allocation fails, the index keeps its current buckets, which only
+ * makes the buckets longer.
+ */
+static psa_status_t psa_resize_key_slot_index(void)
+{
+    size_t bucket_count = global_data.bucket_count;
+    size_t *buckets;
+    size_t slot_idx;
+
+    if (bucket_count == 0) {
+        bucket_count = PSA_KEY_SLOT_CHUNK_SIZE;
+    }
+    while (bucket_count < global_data.slot_count) {
+        bucket_count *= 2;
+    }
+    if (bucket_count == global_data.bucket_count) {
+        return PSA_SUCCESS;
+    }
+
+    buckets = mbedtls_calloc(bucket_count, sizeof(*buckets));
+    if (buckets == NULL) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    mbedtls_free(global_data.buckets);
+    global_data.buckets = buckets;
+    global_data.bucket_count = bucket_count;
+
+    for (slot_idx = 0; slot_idx < global_data.slot_count; slot_idx++) {
+        psa_key_slot_t *slot = psa_key_slot_at(slot_idx);
+        if (slot->store_list == PSA_KEY_SLOT_LIST_INDEX) {
+            psa_key_slot_link(slot);
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
+/** Allocate the next chunk of key slots and add them to the free list.
+ *
+ * \retval #PSA_SUCCESS \emptydescription
+ * \retval #PSA_ERROR_INSUFFICIENT_MEMORY
+ *         The key store has #MBEDTLS_PSA_KEY_SLOT_COUNT slots already,
+ *         or the allocation failed.
+ */
+static psa_status_t psa_grow_key_slots(void)
+{
+    size_t count = MBEDTLS_PSA_KEY_SLOT_COUNT - global_data.slot_count;
+    size_t first = global_data.slot_count;
+    psa_key_slot_t *chunk;
+    size_t i;
+
+    if (count == 0) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+    if (count > PSA_KEY_SLOT_CHUNK_SIZE) {
+        count = PSA_KEY_SLOT_CHUNK_SIZE;
+    }
+
+    /* The index must exist before any slot can be added to it */
+    if (global_data.buckets == NULL &&
+        psa_resize_key_slot_index() != PSA_SUCCESS) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    chunk = mbedtls_calloc(count, sizeof(*chunk));
+    if (chunk == NULL) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+    global_data.chunks[first / PSA_KEY_SLOT_CHUNK_SIZE] = chunk;
+    global_data.slot_count += count;
+
+    /* Push the new slots in reverse order, so that the lowest positions,
+     * and thus the lowest volatile key identifiers, are used first. */
+    for (i = count; i > 0; i--) {
+        psa_key_slot_t *slot = &chunk[i - 1];
+        slot->store_index = first + i - 1;
+        slot->store_next = global_data.first_free;
+        slot->store_list = PSA_KEY_SLOT_LIST_FREE;
+        global_data.first_free = first + i;
+    }
+
+    (void) psa_resize_key_slot_index();
+    return PSA_SUCCESS;
+}
+
 int psa_is_valid_key_id(mbedtls_svc_key_id_t key, int vendor_ok)
 {
     psa_key_id_t key_id = MBEDTLS_SVC_KEY_ID_GET_KEY_ID(key);
@@ -64,7 +227,9 @@ int psa_is_valid_key_id(mbedtls_svc_key_id_t key, int vendor_ok)
  *
  * For volatile key identifiers, only one key slot is queried as a volatile
  * key with identifier key_id can only be stored in slot of index
- * ( key_id - #PSA_KEY_ID_VOLATILE_MIN ).
+ * ( key_id - #PSA_KEY_ID_VOLATILE_MIN ). For other key identifiers, only
+ * the key slots in the bucket of the key identifier index for \p key are
+ * queried.
  *
  * On success, the function locks the key slot. It is the responsibility of
  * the caller to unlock the key slot when it does not access it anymore.
@@ -91,7 +256,11 @@ static psa_status_t psa_get_and_lock_key_slot_in_memory(
     psa_key_slot_t *slot = NULL;
 
     if (psa_key_id_is_volatile(key_id)) {
-        slot = &global_data.key_slots[key_id - PSA_KEY_ID_VOLATILE_MIN];
+        slot_idx = key_id - PSA_KEY_ID_VOLATILE_MIN;
+        if (slot_idx >= global_data.slot_count) {
+            return PSA_ERROR_DOES_NOT_EXIST;
+        }
+        slot = psa_key_slot_at(slot_idx);
 
         /*
          * Check if both the PSA key identifier key_id and the owner
@@ -108,14 +277,19 @@ static psa_status_t psa_get_and_lock_key_slot_in_memory(
             return PSA_ERROR_INVALID_HANDLE;
         }
 
-        for (slot_idx = 0; slot_idx < MBEDTLS_PSA_KEY_SLOT_COUNT; slot_idx++) {
-            slot = &global_data.key_slots[slot_idx];
+        status = PSA_ERROR_DOES_NOT_EXIST;
+        if (global_data.buckets == NULL) {
+            return status;
+        }
+
+        for (slot_idx = global_data.buckets[psa_key_id_bucket(key)];
+             slot_idx != 0; slot_idx = slot->store_next) {
+            slot = psa_key_slot_at(slot_idx - 1);
             if (mbedtls_svc_key_id_equal(key, slot->attr.id)) {
+                status = PSA_SUCCESS;
                 break;
             }
         }
-        status = (slot_idx < MBEDTLS_PSA_KEY_SLOT_COUNT) ?
-                 PSA_SUCCESS : PSA_ERROR_DOES_NOT_EXIST;
     }
 
     if (status == PSA_SUCCESS) {
@@ -131,8 +305,8 @@ static psa_status_t psa_get_and_lock_key_slot_in_memory(
 psa_status_t psa_initialize_key_slots(void)
 {
     /* Nothing to do: program startup and psa_wipe_all_key_slots() both
-     * guarantee that the key slots are initialized to all-zero, which
-     * means that all the key slots are in a valid, empty state. */
+     * guarantee that the key store is empty, and slots are allocated
+     * when they are first needed. */
     global_data.key_slots_initialized = 1;
     return PSA_SUCCESS;
 }
@@ -140,13 +314,54 @@ psa_status_t psa_initialize_key_slots(void)
 void psa_wipe_all_key_slots(void)
 {
     size_t slot_idx;
+    size_t chunk_idx;
 
-    for (slot_idx = 0; slot_idx < MBEDTLS_PSA_KEY_SLOT_COUNT; slot_idx++) {
-        psa_key_slot_t *slot = &global_data.key_slots[slot_idx];
+    for (slot_idx = 0; slot_idx < global_data.slot_count; slot_idx++) {
+        psa_key_slot_t *slot = psa_key_slot_at(slot_idx);
+        if (slot->store_list == PSA_KEY_SLOT_LIST_FREE) {
+            continue;
+        }
         slot->lock_count = 1;
         (void) psa_wipe_key_slot(slot);
     }
-    global_data.key_slots_initialized = 0;
+
+    for (chunk_idx = 0; chunk_idx < PSA_KEY_SLOT_CHUNK_COUNT; chunk_idx++) {
+        mbedtls_free(global_data.chunks[chunk_idx]);
+    }
+    mbedtls_free(global_data.buckets);
+    memset(&global_data, 0, sizeof(global_data));
+}
+
+void psa_index_key_slot(psa_key_slot_t *slot)
+{
+    if (slot->store_list == PSA_KEY_SLOT_LIST_INDEX) {
+        psa_key_slot_unlink(slot);
+    }
+
+    /* Volatile keys are found by their identifier */
+    if (!psa_key_id_is_volatile(MBEDTLS_SVC_KEY_ID_GET_KEY_ID(slot->attr.id))) {
+        psa_key_slot_link(slot);
+    }
+}
+
+void psa_free_key_slot(psa_key_slot_t *slot)
+{
+    size_t store_index = slot->store_index;
+
+    if (slot->store_list == PSA_KEY_SLOT_LIST_FREE) {
+        return;
+    }
+    if (slot->store_list == PSA_KEY_SLOT_LIST_INDEX) {
+        psa_key_slot_unlink(slot);
+    }
+
+    /* We can call memset and not zeroize because the metadata is not
+     * particularly sensitive. */
+    memset(slot, 0, sizeof(*slot));
+    slot->store_index = store_index;
+    slot->store_next = global_data.first_free;
+    slot->store_list = PSA_KEY_SLOT_LIST_FREE;
+    global_data.first_free = store_index + 1;
 }
 
 psa_status_t psa_get_empty_key_slot(psa_key_id_t *volatile_key_id,
@@ -154,50 +369,49 @@ psa_status_t psa_get_empty_key_slot(psa_key_id_t *volatile_key_id,
 {
     psa_status_t status = PSA_ERROR_CORRUPTION_DETECTED;
     size_t slot_idx;
-    psa_key_slot_t *selected_slot, *unlocked_persistent_key_slot;
+    psa_key_slot_t *selected_slot;
 
     if (!global_data.key_slots_initialized) {
         status = PSA_ERROR_BAD_STATE;
         goto error;
     }
 
-    selected_slot = unlocked_persistent_key_slot = NULL;
-    for (slot_idx = 0; slot_idx < MBEDTLS_PSA_KEY_SLOT_COUNT; slot_idx++) {
-        psa_key_slot_t *slot = &global_data.key_slots[slot_idx];
-        if (!psa_is_key_slot_occupied(slot)) {
-            selected_slot = slot;
-            break;
-        }
-
-        if ((unlocked_persistent_key_slot == NULL) &&
-            (!PSA_KEY_LIFETIME_IS_VOLATILE(slot->attr.lifetime)) &&
-            (!psa_is_key_slot_locked(slot))) {
-            unlocked_persistent_key_slot = slot;
-        }
+    if (global_data.first_free == 0) {
+        (void) psa_grow_key_slots();
     }
 
     /*
-     * If there is no unused key slot and there is at least one unlocked key
-     * slot containing the description of a persistent key, recycle the first
-     * such key slot we encountered. If we later need to operate on the
-     * persistent key we are evicting now, we will reload its description from
-     * storage.
+     * If there is no free key slot and the key store cannot grow, and there
+     * is at least one unlocked key slot containing the description of a
+     * persistent key, recycle the first such key slot. If we later need to
+     * operate on the persistent key we are evicting now, we will reload its
+     * description from storage.
      */
-    if ((selected_slot == NULL) &&
-        (unlocked_persistent_key_slot != NULL)) {
-        selected_slot = unlocked_persistent_key_slot;
-        selected_slot->lock_count = 1;
-        psa_wipe_key_slot(selected_slot);
+    if (global_data.first_free == 0) {
+        for (slot_idx = 0; slot_idx < global_data.slot_count; slot_idx++) {
+            psa_key_slot_t *slot = psa_key_slot_at(slot_idx);
+            if ((!PSA_KEY_LIFETIME_IS_VOLATILE(slot->attr.lifetime)) &&
+                (!psa_is_key_slot_locked(slot))) {
+                slot->lock_count = 1;
+                psa_wipe_key_slot(slot);
+                break;
+            }
+        }
     }
 
-    if (selected_slot != NULL) {
+    if (global_data.first_free != 0) {
+        selected_slot = psa_key_slot_at(global_data.first_free - 1);
+        global_data.first_free = selected_slot->store_next;
+        selected_slot->store_next = 0;
+        selected_slot->store_list = PSA_KEY_SLOT_LIST_NONE;
+
         status = psa_lock_key_slot(selected_slot);
         if (status != PSA_SUCCESS) {
             goto error;
         }
 
         *volatile_key_id = PSA_KEY_ID_VOLATILE_MIN +
-                           ((psa_key_id_t) (selected_slot - global_data.key_slots));
+                           (psa_key_id_t) selected_slot->store_index;
         *p_slot = selected_slot;
 
         return PSA_SUCCESS;
@@ -357,6 +571,7 @@ psa_status_t psa_get_and_lock_key_slot(mbedtls_svc_key_id_t key,
 
     (*p_slot)->attr.id = key;
     (*p_slot)->attr.lifetime = PSA_KEY_LIFETIME_PERSISTENT;
+    psa_index_key_slot(*p_slot);
 
     status = PSA_ERROR_DOES_NOT_EXIST;
 #if defined(MBEDTLS_PSA_CRYPTO_BUILTIN_KEYS)
@@ -537,8 +752,11 @@ void mbedtls_psa_get_stats(mbedtls_psa_stats_t *stats)
 
     memset(stats, 0, sizeof(*stats));
 
-    for (slot_idx = 0; slot_idx < MBEDTLS_PSA_KEY_SLOT_COUNT; slot_idx++) {
-        const psa_key_slot_t *slot = &global_data.key_slots[slot_idx];
+    /* Slots that are not allocated yet count as empty */
+    stats->empty_slots = MBEDTLS_PSA_KEY_SLOT_COUNT - global_data.slot_count;
+
+    for (slot_idx = 0; slot_idx < global_data.slot_count; slot_idx++) {
+        const psa_key_slot_t *slot = psa_key_slot_at(slot_idx);
         if (psa_is_key_slot_locked(slot)) {
             ++stats->locked_slots;
         }
@@ -113,6 +113,27 @@ void psa_wipe_all_key_slots(void);
 psa_status_t psa_get_empty_key_slot(psa_key_id_t *volatile_key_id,
                                     psa_key_slot_t **p_slot);
 
+/** Make a key slot findable by the identifier of the key it contains.
+ *
+ * Call this function after setting the identifier of a key in a slot
+ * returned by psa_get_empty_key_slot(). Slots of volatile keys are found
+ * by their identifier without an index, so this function does nothing for
+ * them. The slot is removed from the index when it is wiped.
+ *
+ * \param[in] slot  The key slot, whose \c attr.id field is set.
+ */
+void psa_index_key_slot(psa_key_slot_t *slot);
+
+/** Return a key slot to the free slots of the key store.
+ *
+ * This function removes the slot from the key identifier index and resets
+ * it to its ground state. It is called by psa_wipe_key_slot() once the key
+ * material has been wiped, and must not be called otherwise.
+ *
+ * \param[in] slot  The key slot.
+ */
+void psa_free_key_slot(psa_key_slot_t *slot);
+
 /** Lock a key slot.
  *
  * This function increments the key slot lock counter by one.
@@ -0,0 +1,625 @@
+/*
+ *  PSA ITS simulator over a single append-only stdio log file.
+ *
+ *  Every psa_its_set() and psa_its_remove() appends one record to the log.
+ *  An index in memory maps each uid to the position of its data in the log,
+ *  so that looking up a uid does not depend on the number of uids stored.
+ *  The index is built by reading the log on first use. When overwritten and
+ *  removed records take up more space than live ones, the live records are
+ *  copied to a new log which replaces the old one.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+
+#include "common.h"
+
+#if defined(MBEDTLS_PSA_ITS_LOG_C)
+
+#include "mbedtls/platform.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include "psa_crypto_its.h"
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(PSA_ITS_STORAGE_PREFIX)
+#define PSA_ITS_STORAGE_PREFIX ""
+#endif
+
+#define PSA_ITS_LOG_FILENAME PSA_ITS_STORAGE_PREFIX "psa_its.log"
+#define PSA_ITS_LOG_TEMP PSA_ITS_STORAGE_PREFIX "psa_its.log.tmp"
+
+#define PSA_ITS_LOG_MAGIC_STRING "PSA\0LOG\0"
+#define PSA_ITS_LOG_MAGIC_LENGTH 8
+
+/* Kinds of records */
+#define PSA_ITS_LOG_SET    1
+#define PSA_ITS_LOG_REMOVE 2
+
+/* The log is compacted when overwritten and removed records take up more
+ * than this many bytes, and more than the live records. */
+#if !defined(PSA_ITS_LOG_COMPACT_THRESHOLD)
+#define PSA_ITS_LOG_COMPACT_THRESHOLD 4096
+#endif
+
+/* Size of the buffer used to check and copy the data of records */
+#define PSA_ITS_LOG_BUFFER_SIZE 256
+
+/* Initial number of slots of the index. Must be a power of 2. */
+#define PSA_ITS_LOG_INDEX_MIN_SIZE 16
+
+/* As rename fails on Windows if the new filepath already exists,
+ * use MoveFileExA with the MOVEFILE_REPLACE_EXISTING flag instead.
+ * Returns 0 on success, nonzero on failure. */
+#if defined(_WIN32)
+#define rename_replace_existing(oldpath, newpath) \
+    (!MoveFileExA(oldpath, newpath, MOVEFILE_REPLACE_EXISTING))
+#else
+#define rename_replace_existing(oldpath, newpath) rename(oldpath, newpath)
+#endif
+
+/* A record is this header followed by size bytes of data. The check
+ * value is the FNV-1a hash of the other fields and of the data: a record
+ * that was not completely written when the system stopped doesn't match
+ * it and marks the end of the log. */
+typedef struct {
+    uint8_t kind[sizeof(uint32_t)];
+    uint8_t uid[sizeof(psa_storage_uid_t)];
+    uint8_t size[sizeof(uint32_t)];
+    uint8_t flags[sizeof(psa_storage_create_flags_t)];
+    uint8_t check[sizeof(uint32_t)];
+} psa_its_log_record_t;
+
+#define PSA_ITS_LOG_RECORD_LENGTH(size) \
+    ((long) sizeof(psa_its_log_record_t) + (long) (size))
+
+typedef struct {
+    psa_storage_uid_t uid;              /* 0 for an empty slot */
+    long offset;                        /* position of the data in the log */
+    uint32_t size;
+    psa_storage_create_flags_t flags;
+} psa_its_log_entry_t;
+
+static struct {
+    FILE *stream;                   /* the log, NULL if it doesn't exist */
+    psa_its_log_entry_t *index;     /* open addressing, linear probing */
+    size_t index_size;              /* number of slots, a power of 2 */
+    size_t count;                   /* number of uids in the index */
+    long end;                       /* end of the last valid record */
+    long live;                      /* length of the records in the index */
+    unsigned loaded : 1;            /* the index matches the log */
+    unsigned dirty : 1;             /* the log may end with a bad record */
+} psa_its_log;
+
+static uint32_t psa_its_log_fnv1a(uint32_t hash,
+                                  const unsigned char *data, size_t length)
+{
+    size_t i;
+    for (i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+static size_t psa_its_log_home(psa_storage_uid_t uid)
+{
+    uint32_t h = (uint32_t) (uid ^ (uid >> 32)) * 0x9E3779B1;
+    return (size_t) (h ^ (h >> 16)) & (psa_its_log.index_size - 1);
+}
+
+static psa_its_log_entry_t *psa_its_log_find(psa_storage_uid_t uid)
+{
+    size_t mask = psa_its_log.index_size - 1;
+    size_t i;
+
+    if (psa_its_log.index == NULL || uid == 0) {
+        return NULL;
+    }
+    for (i = psa_its_log_home(uid);
+         psa_its_log.index[i].uid != 0;
+         i = (i + 1) & mask) {
+        if (psa_its_log.index[i].uid == uid) {
+            return &psa_its_log.index[i];
+        }
+    }
+    return NULL;
+}
+
+/* Add an entry for a uid which is not in the index. There must be a free
+ * slot, see psa_its_log_reserve(). */
+static psa_its_log_entry_t *psa_its_log_insert(psa_storage_uid_t uid)
+{
+    size_t mask = psa_its_log.index_size - 1;
+    size_t i = psa_its_log_home(uid);
+
+    while (psa_its_log.index[i].uid != 0) {
+        i = (i + 1) & mask;
+    }
+    psa_its_log.index[i].uid = uid;
+    psa_its_log.count++;
+    return &psa_its_log.index[i];
+}
+
+/* Make sure that one more uid can be inserted while keeping the index
+ * at most 3/4 full. */
+static psa_status_t psa_its_log_reserve(void)
+{
+    psa_its_log_entry_t *old_index = psa_its_log.index;
+    size_t old_size = psa_its_log.index_size;
+    size_t i;
+
+    if (psa_its_log.count + 1 <= old_size / 4 * 3) {
+        return PSA_SUCCESS;
+    }
+
+    psa_its_log.index_size =
+        old_size == 0 ? PSA_ITS_LOG_INDEX_MIN_SIZE : 2 * old_size;
+    psa_its_log.index = mbedtls_calloc(psa_its_log.index_size,
+                                       sizeof(*psa_its_log.index));
+    if (psa_its_log.index == NULL) {
+        psa_its_log.index = old_index;
+        psa_its_log.index_size = old_size;
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    psa_its_log.count = 0;
+    for (i = 0; i < old_size; i++) {
+        if (old_index[i].uid != 0) {
+            *psa_its_log_insert(old_index[i].uid) = old_index[i];
+        }
+    }
+    mbedtls_free(old_index);
+    return PSA_SUCCESS;
+}
+
+/* Remove an entry from the index, moving back the entries that follow it
+ * in its cluster so that lookups don't need tombstones. */
+static void psa_its_log_delete(psa_its_log_entry_t *entry)
+{
+    size_t mask = psa_its_log.index_size - 1;
+    size_t hole = (size_t) (entry - psa_its_log.index);
+    size_t i = hole;
+    size_t home;
+
+    for (;;) {
+        i = (i + 1) & mask;
+        if (psa_its_log.index[i].uid == 0) {
+            break;
+        }
+        /* The entry at i can fill the hole unless its home slot is
+         * (cyclically) after the hole. */
+        home = psa_its_log_home(psa_its_log.index[i].uid);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            psa_its_log.index[hole] = psa_its_log.index[i];
+            hole = i;
+        }
+    }
+    memset(&psa_its_log.index[hole], 0, sizeof(psa_its_log.index[hole]));
+    psa_its_log.count--;
+}
+
+void psa_its_log_close(void)
+{
+    if (psa_its_log.stream != NULL) {
+        fclose(psa_its_log.stream);
+    }
+    mbedtls_free(psa_its_log.index);
+    memset(&psa_its_log, 0, sizeof(psa_its_log));
+}
+
+/* Read the record at psa_its_log.end and apply it to the index.
+ * Return PSA_ERROR_DOES_NOT_EXIST at the end of the valid records. */
+static psa_status_t psa_its_log_read_record(void)
+{
+    psa_its_log_record_t record;
+    unsigned char buffer[PSA_ITS_LOG_BUFFER_SIZE];
+    psa_its_log_entry_t *entry;
+    psa_storage_uid_t uid;
+    uint32_t kind, size, flags, hash;
+    size_t n, remaining;
+    psa_status_t status;
+
+    n = fread(&record, 1, sizeof(record), psa_its_log.stream);
+    if (n != sizeof(record)) {
+        /* Clean end of the log, or a torn record header */
+        psa_its_log.dirty = (n != 0);
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+
+    kind = MBEDTLS_GET_UINT32_LE(record.kind, 0);
+    uid = (psa_storage_uid_t) MBEDTLS_GET_UINT32_LE(record.uid, 0) |
+          (psa_storage_uid_t) MBEDTLS_GET_UINT32_LE(record.uid, 4) << 32;
+    size = MBEDTLS_GET_UINT32_LE(record.size, 0);
+    flags = MBEDTLS_GET_UINT32_LE(record.flags, 0);
+    if ((kind != PSA_ITS_LOG_SET && kind != PSA_ITS_LOG_REMOVE) ||
+        (kind == PSA_ITS_LOG_REMOVE && size != 0) ||
+        uid == 0 ||
+        (unsigned long) size > (unsigned long) (LONG_MAX - psa_its_log.end -
+                                                PSA_ITS_LOG_RECORD_LENGTH(0))) {
+        goto bad_record;
+    }
+
+    hash = psa_its_log_fnv1a(0x811c9dc5, (const unsigned char *) &record,
+                             offsetof(psa_its_log_record_t, check));
+    for (remaining = size; remaining != 0; remaining -= n) {
+        n = remaining < sizeof(buffer) ? remaining : sizeof(buffer);
+        if (fread(buffer, 1, n, psa_its_log.stream) != n) {
+            goto bad_record;
+        }
+        hash = psa_its_log_fnv1a(hash, buffer, n);
+    }
+    if (hash != MBEDTLS_GET_UINT32_LE(record.check, 0)) {
+        goto bad_record;
+    }
+
+    entry = psa_its_log_find(uid);
+    if (entry != NULL) {
+        psa_its_log.live -= PSA_ITS_LOG_RECORD_LENGTH(entry->size);
+        if (kind == PSA_ITS_LOG_REMOVE) {
+            psa_its_log_delete(entry);
+        }
+    } else if (kind == PSA_ITS_LOG_SET) {
+        status = psa_its_log_reserve();
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+        entry = psa_its_log_insert(uid);
+    }
+    if (kind == PSA_ITS_LOG_SET) {
+        entry->offset = psa_its_log.end + PSA_ITS_LOG_RECORD_LENGTH(0);
+        entry->size = size;
+        entry->flags = flags;
+        psa_its_log.live += PSA_ITS_LOG_RECORD_LENGTH(size);
+    }
+    psa_its_log.end += PSA_ITS_LOG_RECORD_LENGTH(size);
+    return PSA_SUCCESS;
+
+bad_record:
+    /* Only the last record can be bad, if the system stopped while it was
+     * being written. It is left out of the log at the next compaction. */
+    psa_its_log.dirty = 1;
+    return PSA_ERROR_DOES_NOT_EXIST;
+}
+
+/* Build the index from the log, if this hasn't been done yet. */
+static psa_status_t psa_its_log_load(void)
+{
+    uint8_t magic[PSA_ITS_LOG_MAGIC_LENGTH];
+    psa_status_t status;
+
+    if (psa_its_log.loaded) {
+        return PSA_SUCCESS;
+    }
+
+    psa_its_log.stream = fopen(PSA_ITS_LOG_FILENAME, "r+b");
+    if (psa_its_log.stream == NULL) {
+        /* No log yet: it is created by the first write. */
+        psa_its_log.loaded = 1;
+        return PSA_SUCCESS;
+    }
+
+    if (fread(magic, 1, sizeof(magic), psa_its_log.stream) != sizeof(magic) ||
+        memcmp(magic, PSA_ITS_LOG_MAGIC_STRING,
+               PSA_ITS_LOG_MAGIC_LENGTH) != 0) {
+        status = PSA_ERROR_DATA_CORRUPT;
+        goto exit;
+    }
+    psa_its_log.end = PSA_ITS_LOG_MAGIC_LENGTH;
+
+    do {
+        status = psa_its_log_read_record();
+    } while (status == PSA_SUCCESS);
+    if (status != PSA_ERROR_DOES_NOT_EXIST) {
+        goto exit;
+    }
+    psa_its_log.loaded = 1;
+    status = PSA_SUCCESS;
+
+exit:
+    if (status != PSA_SUCCESS) {
+        psa_its_log_close();
+    }
+    return status;
+}
+
+/* Write the live records to a new log and replace the old log with it.
+ * This also creates the log if it doesn't exist yet. */
+static psa_status_t psa_its_log_compact(void)
+{
+    psa_status_t status = PSA_ERROR_STORAGE_FAILURE;
+    unsigned char buffer[PSA_ITS_LOG_BUFFER_SIZE];
+    FILE *temp = NULL;
+    long offset = PSA_ITS_LOG_MAGIC_LENGTH;
+    size_t i, n;
+    long remaining;
+    int ret;
+
+    if (psa_its_log.stream == NULL && psa_its_log.count != 0) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    temp = fopen(PSA_ITS_LOG_TEMP, "wb");
+    if (temp == NULL) {
+        goto exit;
+    }
+
+    status = PSA_ERROR_INSUFFICIENT_STORAGE;
+    if (fwrite(PSA_ITS_LOG_MAGIC_STRING, 1, PSA_ITS_LOG_MAGIC_LENGTH,
+               temp) != PSA_ITS_LOG_MAGIC_LENGTH) {
+        goto exit;
+    }
+    /* The records of the index were checked when they were read or
+     * written, so they are copied as they are, header included. */
+    for (i = 0; i < psa_its_log.index_size; i++) {
+        const psa_its_log_entry_t *entry = &psa_its_log.index[i];
+        if (entry->uid == 0) {
+            continue;
+        }
+        if (fseek(psa_its_log.stream,
+                  entry->offset - PSA_ITS_LOG_RECORD_LENGTH(0),
+                  SEEK_SET) != 0) {
+            status = PSA_ERROR_STORAGE_FAILURE;
+            goto exit;
+        }
+        for (remaining = PSA_ITS_LOG_RECORD_LENGTH(entry->size);
+             remaining != 0; remaining -= (long) n) {
+            n = remaining < (long) sizeof(buffer) ?
+                (size_t) remaining : sizeof(buffer);
+            if (fread(buffer, 1, n, psa_its_log.stream) != n) {
+                status = PSA_ERROR_STORAGE_FAILURE;
+                goto exit;
+            }
+            if (fwrite(buffer, 1, n, temp) != n) {
+                goto exit;
+            }
+        }
+    }
+    ret = fclose(temp);
+    temp = NULL;
+    if (ret != 0) {
+        goto exit;
+    }
+
+    /* The log must be closed to be replaced on some platforms. */
+    if (psa_its_log.stream != NULL) {
+        fclose(psa_its_log.stream);
+    }
+    status = PSA_SUCCESS;
+    if (rename_replace_existing(PSA_ITS_LOG_TEMP, PSA_ITS_LOG_FILENAME) != 0) {
+        status = PSA_ERROR_STORAGE_FAILURE;
+    }
+    psa_its_log.stream = fopen(PSA_ITS_LOG_FILENAME, "r+b");
+    if (psa_its_log.stream == NULL) {
+        /* The log can't be read from any more. Forget about it: the next
+         * access builds the index from the log again. */
+        psa_its_log_close();
+        status = PSA_ERROR_STORAGE_FAILURE;
+    }
+    if (status != PSA_SUCCESS) {
+        goto exit;
+    }
+
+    for (i = 0; i < psa_its_log.index_size; i++) {
+        psa_its_log_entry_t *entry = &psa_its_log.index[i];
+        if (entry->uid != 0) {
+            entry->offset = offset + PSA_ITS_LOG_RECORD_LENGTH(0);
+            offset += PSA_ITS_LOG_RECORD_LENGTH(entry->size);
+        }
+    }
+    psa_its_log.end = offset;
+    psa_its_log.live = offset - PSA_ITS_LOG_MAGIC_LENGTH;
+    psa_its_log.dirty = 0;
+
+exit:
+    if (temp != NULL) {
+        fclose(temp);
+    }
+    /* As in psa_its_file.c, the temporary file only remains in failure
+     * cases, where there is nothing more to do about it. */
+    (void) remove(PSA_ITS_LOG_TEMP);
+    return status;
+}
+
+/* Compact the log if enough of it is dead. This is done after a successful
+ * write, whose result doesn't depend on it: if compaction fails, the log
+ * is simply longer than necessary. */
+static void psa_its_log_maybe_compact(void)
+{
+    long dead = psa_its_log.end - PSA_ITS_LOG_MAGIC_LENGTH - psa_its_log.live;
+    if (dead > PSA_ITS_LOG_COMPACT_THRESHOLD && dead > psa_its_log.live) {
+        (void) psa_its_log_compact();
+    }
+}
+
+/* Append a record to the log. The header and the data are written with a
+ * single flush, so each record normally costs one write to the file. */
+static psa_status_t psa_its_log_append(uint32_t kind,
+                                       psa_storage_uid_t uid,
+                                       uint32_t data_length,
+                                       const void *p_data,
+                                       psa_storage_create_flags_t flags)
+{
+    psa_its_log_record_t record;
+    uint32_t hash;
+    psa_status_t status;
+
+    if (psa_its_log.stream == NULL || psa_its_log.dirty) {
+        status = psa_its_log_compact();
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+    }
+    if ((unsigned long) data_length >
+        (unsigned long) (LONG_MAX - psa_its_log.end -
+                         PSA_ITS_LOG_RECORD_LENGTH(0))) {
+        return PSA_ERROR_INSUFFICIENT_STORAGE;
+    }
+
+    MBEDTLS_PUT_UINT32_LE(kind, record.kind, 0);
+    MBEDTLS_PUT_UINT32_LE((uint32_t) uid, record.uid, 0);
+    MBEDTLS_PUT_UINT32_LE((uint32_t) (uid >> 32), record.uid, 4);
+    MBEDTLS_PUT_UINT32_LE(data_length, record.size, 0);
+    MBEDTLS_PUT_UINT32_LE(flags, record.flags, 0);
+    hash = psa_its_log_fnv1a(0x811c9dc5, (const unsigned char *) &record,
+                             offsetof(psa_its_log_record_t, check));
+    hash = psa_its_log_fnv1a(hash, p_data, data_length);
+    MBEDTLS_PUT_UINT32_LE(hash, record.check, 0);
+
+    if (fseek(psa_its_log.stream, psa_its_log.end, SEEK_SET) != 0) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+    if (fwrite(&record, 1, sizeof(record), psa_its_log.stream) !=
+        sizeof(record) ||
+        (data_length != 0 &&
+         fwrite(p_data, 1, data_length, psa_its_log.stream) != data_length) ||
+        fflush(psa_its_log.stream) != 0) {
+        /* Part of the record may have been written */
+        psa_its_log.dirty = 1;
+        return PSA_ERROR_INSUFFICIENT_STORAGE;
+    }
+    psa_its_log.end += PSA_ITS_LOG_RECORD_LENGTH(data_length);
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_its_get_info(psa_storage_uid_t uid,
+                              struct psa_storage_info_t *p_info)
+{
+    const psa_its_log_entry_t *entry;
+    psa_status_t status = psa_its_log_load();
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    entry = psa_its_log_find(uid);
+    if (entry == NULL) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+    p_info->size = entry->size;
+    p_info->flags = entry->flags;
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_its_get(psa_storage_uid_t uid,
+                         uint32_t data_offset,
+                         uint32_t data_length,
+                         void *p_data,
+                         size_t *p_data_length)
+{
+    const psa_its_log_entry_t *entry;
+    size_t n;
+    psa_status_t status = psa_its_log_load();
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    entry = psa_its_log_find(uid);
+    if (entry == NULL) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+    if (data_offset + data_length < data_offset) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+#if SIZE_MAX < 0xffffffff
+    if (data_offset + data_length > SIZE_MAX) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+#endif
+    if (data_offset + data_length > entry->size) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* The record is entirely before psa_its_log.end, so this position
+     * fits in a long. */
+    if (fseek(psa_its_log.stream, entry->offset + (long) data_offset,
+              SEEK_SET) != 0) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+    n = fread(p_data, 1, data_length, psa_its_log.stream);
+    if (n != data_length) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+    if (p_data_length != NULL) {
+        *p_data_length = n;
+    }
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_its_set(psa_storage_uid_t uid,
+                         uint32_t data_length,
+                         const void *p_data,
+                         psa_storage_create_flags_t create_flags)
+{
+    psa_its_log_entry_t *entry;
+    psa_status_t status;
+
+    if (uid == 0) {
+        return PSA_ERROR_INVALID_HANDLE;
+    }
+
+    status = psa_its_log_load();
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+    /* Make room in the index first, so that the record can always be
+     * indexed once it is in the log. */
+    status = psa_its_log_reserve();
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    status = psa_its_log_append(PSA_ITS_LOG_SET, uid,
+                                data_length, p_data, create_flags);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    entry = psa_its_log_find(uid);
+    if (entry != NULL) {
+        psa_its_log.live -= PSA_ITS_LOG_RECORD_LENGTH(entry->size);
+    } else {
+        entry = psa_its_log_insert(uid);
+    }
+    entry->offset = psa_its_log.end - (long) data_length;
+    entry->size = data_length;
+    entry->flags = create_flags;
+    psa_its_log.live += PSA_ITS_LOG_RECORD_LENGTH(data_length);
+
+    psa_its_log_maybe_compact();
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_its_remove(psa_storage_uid_t uid)
+{
+    psa_its_log_entry_t *entry;
+    psa_status_t status = psa_its_log_load();
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    entry = psa_its_log_find(uid);
+    if (entry == NULL) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+
+    status = psa_its_log_append(PSA_ITS_LOG_REMOVE, uid, 0, NULL, 0);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+    psa_its_log.live -= PSA_ITS_LOG_RECORD_LENGTH(entry->size);
+    psa_its_log_delete(entry);
+
+    psa_its_log_maybe_compact();
+    return PSA_SUCCESS;
+}
+
+#endif /* MBEDTLS_PSA_ITS_LOG_C */
@@ -5,8 +5,11 @@
  *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
  */
 /*
- * These session callbacks use a simple chained list
- * to store and retrieve the session information.
+ * These session callbacks store the sessions in MBEDTLS_SSL_CACHE_SHARDS
+ * shards, chosen by a hash of the session ID and locked separately. Each
+ * shard keeps its entries in a hash table on the session ID and in a list
+ * in order of use, so that lookups, insertions and the eviction of the
+ * least recently used entry take constant time.
  */
 
 #include "common.h"
@@ -21,6 +24,9 @@
 
 #include <string.h>
 
+/* Initial size of the hash table of a shard */
+#define SSL_CACHE_MIN_BUCKETS   16
+
 void mbedtls_ssl_cache_init(mbedtls_ssl_cache_context *cache)
 {
     memset(cache, 0, sizeof(mbedtls_ssl_cache_context));
@@ -29,10 +35,223 @@ void mbedtls_ssl_cache_init(mbedtls_ssl_cache_context *cache)
     cache->max_entries = MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES;
 
 #if defined(MBEDTLS_THREADING_C)
-    mbedtls_mutex_init(&cache->mutex);
+    {
+        size_t i;
+
+        for (i = 0; i < MBEDTLS_SSL_CACHE_SHARDS; i++) {
+            mbedtls_mutex_init(&cache->shards[i].mutex);
+        }
+    }
 #endif
 }
 
+/*
+ * FNV-1a with a final avalanche, so that both the high bits (the shard)
+ * and the low bits (the bucket) depend on every byte of the ID.
+ */
+static uint32_t ssl_cache_hash(const unsigned char *id, size_t id_len)
+{
+    uint32_t h = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < id_len; i++) {
+        h = (h ^ id[i]) * 16777619u;
+    }
+
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+
+    return h;
+}
+
+/*
+ * Number of shards in use: with fewer than MBEDTLS_SSL_CACHE_SHARDS
+ * entries, only the first max_entries shards hold one each, so that the
+ * cache never holds more than max_entries sessions.
+ */
+static size_t ssl_cache_shards_used(const mbedtls_ssl_cache_context *cache)
+{
+    size_t max = (size_t) cache->max_entries;
+
+    return (max != 0 && max < MBEDTLS_SSL_CACHE_SHARDS) ?
+           max : MBEDTLS_SSL_CACHE_SHARDS;
+}
+
+static mbedtls_ssl_cache_shard *ssl_cache_shard(mbedtls_ssl_cache_context *cache,
+                                                uint32_t hash)
+{
+    return &cache->shards[(hash >> 16) % ssl_cache_shards_used(cache)];
+}
+
+/*
+ * Share of max_entries of a shard: the entries are spread evenly over the
+ * shards in use, and the shares add up to max_entries.
+ */
+static size_t ssl_cache_capacity(const mbedtls_ssl_cache_context *cache,
+                                 const mbedtls_ssl_cache_shard *shard)
+{
+    size_t max = (size_t) cache->max_entries;
+    size_t used = ssl_cache_shards_used(cache);
+    size_t i = (size_t) (shard - cache->shards);
+
+    return max / used + (i < max % used ? 1 : 0);
+}
+
+#if defined(MBEDTLS_HAVE_TIME)
+static int ssl_cache_expired(const mbedtls_ssl_cache_context *cache,
+                             const mbedtls_ssl_cache_entry *entry,
+                             mbedtls_time_t t)
+{
+    return cache->timeout != 0 &&
+           (int) (t - entry->timestamp) > cache->timeout;
+}
+#endif /* MBEDTLS_HAVE_TIME */
+
+static mbedtls_ssl_cache_entry *ssl_cache_find(const mbedtls_ssl_cache_shard *shard,
+                                               uint32_t hash,
+                                               const mbedtls_ssl_session *session)
+{
+    mbedtls_ssl_cache_entry *cur;
+
+    if (shard->buckets == NULL) {
+        return NULL;
+    }
+
+    for (cur = shard->buckets[hash & (shard->bucket_count - 1)];
+         cur != NULL; cur = cur->next) {
+        if (cur->hash == hash &&
+            cur->session.id_len == session->id_len &&
+            memcmp(cur->session.id, session->id, session->id_len) == 0) {
+            return cur;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Insert an entry into the hash table and at the most recently used end of
+ * the list. The table must have room for it.
+ */
+static void ssl_cache_link(mbedtls_ssl_cache_shard *shard,
+                           mbedtls_ssl_cache_entry *entry)
+{
+    mbedtls_ssl_cache_entry **bucket =
+        &shard->buckets[entry->hash & (shard->bucket_count - 1)];
+
+    entry->next = *bucket;
+    *bucket = entry;
+
+    entry->newer = NULL;
+    entry->older = shard->newest;
+    if (shard->newest != NULL) {
+        shard->newest->newer = entry;
+    } else {
+        shard->oldest = entry;
+    }
+    shard->newest = entry;
+
+    shard->entries++;
+}
+
+static void ssl_cache_unlink(mbedtls_ssl_cache_shard *shard,
+                             mbedtls_ssl_cache_entry *entry)
+{
+    mbedtls_ssl_cache_entry **cur =
+        &shard->buckets[entry->hash & (shard->bucket_count - 1)];
+
+    while (*cur != entry) {
+        cur = &(*cur)->next;
+    }
+    *cur = entry->next;
+    entry->next = NULL;
+
+    if (entry->newer != NULL) {
+        entry->newer->older = entry->older;
+    } else {
+        shard->newest = entry->older;
+    }
+    if (entry->older != NULL) {
+        entry->older->newer = entry->newer;
+    } else {
+        shard->oldest = entry->newer;
+    }
+    entry->newer = NULL;
+    entry->older = NULL;
+
+    shard->entries--;
+}
+
+/*
+ * Move an entry to the most recently used end of the list
+ */
+static void ssl_cache_touch(mbedtls_ssl_cache_shard *shard,
+                            mbedtls_ssl_cache_entry *entry)
+{
+    if (shard->newest == entry) {
+        return;
+    }
+
+    entry->newer->older = entry->older;
+    if (entry->older != NULL) {
+        entry->older->newer = entry->newer;
+    } else {
+        shard->oldest = entry->newer;
+    }
+
+    entry->newer = NULL;
+    entry->older = shard->newest;
+    shard->newest->newer = entry;
+    shard->newest = entry;
+}
+
+/*
+ * Make room in the hash table for one more entry, keeping the load factor
+ * at most 1.
+ */
+static int ssl_cache_reserve(mbedtls_ssl_cache_shard *shard)
+{
+    mbedtls_ssl_cache_entry **buckets, *cur;
+    size_t count;
+
+    if (shard->entries < shard->bucket_count) {
+        return 0;
+    }
+
+    count = shard->bucket_count == 0 ? SSL_CACHE_MIN_BUCKETS :
+            2 * shard->bucket_count;
+    buckets = mbedtls_calloc(count, sizeof(mbedtls_ssl_cache_entry *));
+    if (buckets == NULL) {
+        return MBEDTLS_ERR_SSL_ALLOC_FAILED;
+    }
+
+    for (cur = shard->newest; cur != NULL; cur = cur->older) {
+        cur->next = buckets[cur->hash & (count - 1)];
+        buckets[cur->hash & (count - 1)] = cur;
+    }
+
+    mbedtls_free(shard->buckets);
+    shard->buckets = buckets;
+    shard->bucket_count = count;
+
+    return 0;
+}
+
+static void ssl_cache_entry_free(mbedtls_ssl_cache_entry *entry)
+{
+    mbedtls_ssl_session_free(&entry->session);
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C) && \
+    defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+    mbedtls_free(entry->peer_cert.p);
+#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
+
+    mbedtls_free(entry);
+}
+
 int mbedtls_ssl_cache_get(void *data, mbedtls_ssl_session *session)
 {
     int ret = MBEDTLS_ERR_SSL_CACHE_ENTRY_NOT_FOUND;
@@ -40,72 +259,66 @@ int mbedtls_ssl_cache_get(void *data, mbedtls_ssl_session *session)
     mbedtls_time_t t = mbedtls_time(NULL);
 #endif
     mbedtls_ssl_cache_context *cache = (mbedtls_ssl_cache_context *) data;
-    mbedtls_ssl_cache_entry *cur, *entry;
+    uint32_t hash = ssl_cache_hash(session->id, session->id_len);
+    mbedtls_ssl_cache_shard *shard = ssl_cache_shard(cache, hash);
+    mbedtls_ssl_cache_entry *entry;
 
 #if defined(MBEDTLS_THREADING_C)
-    if ((ret = mbedtls_mutex_lock(&cache->mutex)) != 0) {
-        return ret;
+    if (mbedtls_mutex_lock(&shard->mutex) != 0) {
+        return MBEDTLS_ERR_THREADING_MUTEX_ERROR;
     }
 #endif
 
-    cur = cache->chain;
-    entry = NULL;
-
-    while (cur != NULL) {
-        entry = cur;
-        cur = cur->next;
+    entry = ssl_cache_find(shard, hash, session);
+    if (entry == NULL) {
+        goto exit;
+    }
 
 #if defined(MBEDTLS_HAVE_TIME)
-        if (cache->timeout != 0 &&
-            (int) (t - entry->timestamp) > cache->timeout) {
-            continue;
-        }
+    if (ssl_cache_expired(cache, entry, t)) {
+        ssl_cache_unlink(shard, entry);
+        ssl_cache_entry_free(entry);
+        goto exit;
+    }
 #endif
 
-        if (session->id_len != entry->session.id_len ||
-            memcmp(session->id, entry->session.id,
-                   entry->session.id_len) != 0) {
-            continue;
-        }
-
-        ret = mbedtls_ssl_session_copy(session, &entry->session);
-        if (ret != 0) {
-            goto exit;
-        }
+    ret = mbedtls_ssl_session_copy(session, &entry->session);
+    if (ret != 0) {
+        goto exit;
+    }
 
 #if defined(MBEDTLS_X509_CRT_PARSE_C) && \
-        defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
-        /*
-         * Restore peer certificate (without rest of the original chain)
-         */
-        if (entry->peer_cert.p != NULL) {
-            /* `session->peer_cert` is NULL after the call to
-             * mbedtls_ssl_session_copy(), because cache entries
-             * have the `peer_cert` field set to NULL. */
+    defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+    /*
+     * Restore peer certificate (without rest of the original chain)
+     */
+    if (entry->peer_cert.p != NULL) {
+        /* `session->peer_cert` is NULL after the call to
+         * mbedtls_ssl_session_copy(), because cache entries
+         * have the `peer_cert` field set to NULL. */
 
-            if ((session->peer_cert = mbedtls_calloc(1,
-                                                     sizeof(mbedtls_x509_crt))) == NULL) {
-                ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
-                goto exit;
-            }
+        if ((session->peer_cert = mbedtls_calloc(1,
+                                                 sizeof(mbedtls_x509_crt))) == NULL) {
+            ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
+            goto exit;
+        }
 
-            mbedtls_x509_crt_init(session->peer_cert);
-            if ((ret = mbedtls_x509_crt_parse(session->peer_cert, entry->peer_cert.p,
-                                              entry->peer_cert.len)) != 0) {
-                mbedtls_free(session->peer_cert);
-                session->peer_cert = NULL;
-                goto exit;
-            }
+        mbedtls_x509_crt_init(session->peer_cert);
+        if ((ret = mbedtls_x509_crt_parse(session->peer_cert, entry->peer_cert.p,
+                                          entry->peer_cert.len)) != 0) {
+            mbedtls_free(session->peer_cert);
+            session->peer_cert = NULL;
+            goto exit;
         }
+    }
 #endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
 
-        ret = 0;
-        goto exit;
-    }
+    ssl_cache_touch(shard, entry);
+    ret = 0;
 
 exit:
 #if defined(MBEDTLS_THREADING_C)
-    if (mbedtls_mutex_unlock(&cache->mutex) != 0) {
+    if (mbedtls_mutex_unlock(&shard->mutex) != 0) {
         ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
     }
 #endif
@@ -117,102 +330,67 @@ int mbedtls_ssl_cache_set(void *data, const mbedtls_ssl_session *session)
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
 #if defined(MBEDTLS_HAVE_TIME)
-    mbedtls_time_t t = mbedtls_time(NULL), oldest = 0;
-    mbedtls_ssl_cache_entry *old = NULL;
+    mbedtls_time_t t = mbedtls_time(NULL);
 #endif
     mbedtls_ssl_cache_context *cache = (mbedtls_ssl_cache_context *) data;
-    mbedtls_ssl_cache_entry *cur, *prv;
-    int count = 0;
+    uint32_t hash = ssl_cache_hash(session->id, session->id_len);
+    mbedtls_ssl_cache_shard *shard = ssl_cache_shard(cache, hash);
+    mbedtls_ssl_cache_entry *cur;
 
 #if defined(MBEDTLS_THREADING_C)
-    if ((ret = mbedtls_mutex_lock(&cache->mutex)) != 0) {
-        return ret;
+    if (mbedtls_mutex_lock(&shard->mutex) != 0) {
+        return MBEDTLS_ERR_THREADING_MUTEX_ERROR;
     }
 #endif
 
-    cur = cache->chain;
-    prv = NULL;
-
-    while (cur != NULL) {
-        count++;
-
-#if defined(MBEDTLS_HAVE_TIME)
-        if (cache->timeout != 0 &&
-            (int) (t - cur->timestamp) > cache->timeout) {
-            cur->timestamp = t;
-            break; /* expired, reuse this slot, update timestamp */
-        }
-#endif
-
-        if (memcmp(session->id, cur->session.id, cur->session.id_len) == 0) {
-            break; /* client reconnected, keep timestamp for session id */
-
-        }
+    cur = ssl_cache_find(shard, hash, session);
+    if (cur != NULL) {
+        /* client reconnected, keep timestamp for session id */
+        ssl_cache_unlink(shard, cur);
+    } else {
 #if defined(MBEDTLS_HAVE_TIME)
-        if (oldest == 0 || cur->timestamp < oldest) {
-            oldest = cur->timestamp;
-            old = cur;
+        /*
+         * Drop the expired entries at the least recently used end
+         */
+        while (shard->oldest != NULL && ssl_cache_expired(cache, shard->oldest, t)) {
+            cur = shard->oldest;
+            ssl_cache_unlink(shard, cur);
+            ssl_cache_entry_free(cur);
         }
+        cur = NULL;
 #endif
 
-        prv = cur;
-        cur = cur->next;
-    }
-
-    if (cur == NULL) {
-#if defined(MBEDTLS_HAVE_TIME)
         /*
-         * Reuse oldest entry if max_entries reached
+         * Reuse the least recently used entry if the shard is full
          */
-        if (count >= cache->max_entries) {
-            if (old == NULL) {
+        if (shard->entries >= ssl_cache_capacity(cache, shard)) {
+            if (shard->oldest == NULL) {
                 /* This should only happen on an ill-configured cache
                  * with max_entries == 0. */
                 ret = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
                 goto exit;
             }
 
-            cur = old;
-        }
-#else /* MBEDTLS_HAVE_TIME */
-        /*
-         * Reuse first entry in chain if max_entries reached,
-         * but move to last place
-         */
-        if (count >= cache->max_entries) {
-            if (cache->chain == NULL) {
-                ret = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
-                goto exit;
-            }
-
-            cur = cache->chain;
-            cache->chain = cur->next;
-            cur->next = NULL;
-            prv->next = cur;
-        }
-#endif /* MBEDTLS_HAVE_TIME */
-        else {
-            /*
-             * max_entries not reached, create new entry
-             */
+            cur = shard->oldest;
+            ssl_cache_unlink(shard, cur);
+        } else {
             cur = mbedtls_calloc(1, sizeof(mbedtls_ssl_cache_entry));
             if (cur == NULL) {
                 ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
                 goto exit;
             }
-
-            if (prv == NULL) {
-                cache->chain = cur;
-            } else {
-                prv->next = cur;
-            }
         }
 
+        cur->hash = hash;
 #if defined(MBEDTLS_HAVE_TIME)
         cur->timestamp = t;
 #endif
     }
 
+    if ((ret = ssl_cache_reserve(shard)) != 0) {
+        goto exit;
+    }
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C) && \
     defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
     /*
@@ -256,11 +434,18 @@ int mbedtls_ssl_cache_set(void *data, const mbedtls_ssl_session *session)
     }
 #endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
 
+    ssl_cache_link(shard, cur);
+    cur = NULL;
     ret = 0;
 
 exit:
+    /* An entry that could not be filled in is not in the cache any more */
+    if (cur != NULL) {
+        ssl_cache_entry_free(cur);
+    }
+
 #if defined(MBEDTLS_THREADING_C)
-    if (mbedtls_mutex_unlock(&cache->mutex) != 0) {
+    if (mbedtls_mutex_unlock(&shard->mutex) != 0) {
         ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
     }
 #endif
@@ -290,28 +475,32 @@ void mbedtls_ssl_cache_set_max_entries(mbedtls_ssl_cache_context *cache, int max
 
 void mbedtls_ssl_cache_free(mbedtls_ssl_cache_context *cache)
 {
+    mbedtls_ssl_cache_shard *shard;
     mbedtls_ssl_cache_entry *cur, *prv;
+    size_t i;
 
-    cur = cache->chain;
+    for (i = 0; i < MBEDTLS_SSL_CACHE_SHARDS; i++) {
+        shard = &cache->shards[i];
+        cur = shard->newest;
 
-    while (cur != NULL) {
-        prv = cur;
-        cur = cur->next;
+        while (cur != NULL) {
+            prv = cur;
+            cur = cur->older;
 
-        mbedtls_ssl_session_free(&prv->session);
-
-#if defined(MBEDTLS_X509_CRT_PARSE_C) && \
-        defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
-        mbedtls_free(prv->peer_cert.p);
-#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
+            ssl_cache_entry_free(prv);
+        }
 
-        mbedtls_free(prv);
-    }
+        mbedtls_free(shard->buckets);
 
 #if defined(MBEDTLS_THREADING_C)
-    mbedtls_mutex_free(&cache->mutex);
+        mbedtls_mutex_free(&shard->mutex);
 #endif
-    cache->chain = NULL;
+        shard->buckets = NULL;
+        shard->bucket_count = 0;
+        shard->entries = 0;
+        shard->newest = NULL;
+        shard->oldest = NULL;
+    }
 }
 
 #endif /* MBEDTLS_SSL_CACHE_C */
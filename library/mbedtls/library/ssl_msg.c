@@ -2637,7 +2637,12 @@ int mbedtls_ssl_write_record(mbedtls_ssl_context *ssl, uint8_t force_flush)
         mbedtls_ssl_write_version(ssl->major_ver, ssl->minor_ver,
                                   ssl->conf->transport, ssl->out_hdr + 1);
 
-        memcpy(ssl->out_ctr, ssl->cur_out_ctr, 8);
+        /* With TLS, out_ctr is the 8 bytes before the header, which belong
+         * to the previous record when mbedtls_ssl_writev() queues several
+         * records in out_buf. */
+        if (ssl->out_left == 0 || ssl->out_ctr > ssl->out_hdr) {
+            memcpy(ssl->out_ctr, ssl->cur_out_ctr, 8);
+        }
         MBEDTLS_PUT_UINT16_BE(len, ssl->out_len, 0);
 
         if (ssl->transform_out != NULL) {
@@ -2648,7 +2653,7 @@ int mbedtls_ssl_write_record(mbedtls_ssl_context *ssl, uint8_t force_flush)
             rec.data_len    = ssl->out_msglen;
             rec.data_offset = ssl->out_msg - rec.buf;
 
-            memcpy(&rec.ctr[0], ssl->out_ctr, 8);
+            memcpy(&rec.ctr[0], ssl->cur_out_ctr, 8);
             mbedtls_ssl_write_version(ssl->major_ver, ssl->minor_ver,
                                       ssl->conf->transport, rec.ver);
             rec.type = ssl->out_msgtype;
@@ -5451,6 +5456,44 @@ int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len)
     return (int) n;
 }
 
+/*
+ * Receive application data into a scatter list: fill the buffers in turn
+ * for as long as the record being read has data left, so that no call
+ * after the first one reads from the underlying transport.
+ */
+int mbedtls_ssl_readv(mbedtls_ssl_context *ssl,
+                      const mbedtls_ssl_iovec *iov, size_t iovcnt)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i, total = 0;
+
+    if (ssl == NULL || ssl->conf == NULL || (iov == NULL && iovcnt != 0)) {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].len == 0) {
+            continue;
+        }
+
+        if (total != 0 && mbedtls_ssl_get_bytes_avail(ssl) == 0) {
+            break;
+        }
+
+        ret = mbedtls_ssl_read(ssl, iov[i].buf, iov[i].len);
+        if (ret <= 0) {
+            return total != 0 ? (int) total : ret;
+        }
+
+        total += (size_t) ret;
+        if ((size_t) ret < iov[i].len) {
+            break;
+        }
+    }
+
+    return (int) total;
+}
+
 /*
  * Send application data to be encrypted by the SSL layer, taking care of max
  * fragment length and buffer size.
@@ -5597,6 +5640,218 @@ int mbedtls_ssl_write(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t
     return ret;
 }
 
+/*
+ * Lay out the records that mbedtls_ssl_writev() builds from \p total bytes
+ * of application data in one call: \p len is the part of the data that goes
+ * into the output buffer, in records of \p max_len bytes except that the
+ * first one holds a single byte if \p split is set (1/n-1 splitting).
+ *
+ * This only depends on the state of the connection, so that a call repeated
+ * after MBEDTLS_ERR_SSL_WANT_WRITE can tell how much data was sent.
+ */
+MBEDTLS_CHECK_RETURN_CRITICAL
+static int ssl_writev_layout(mbedtls_ssl_context *ssl, size_t total,
+                             size_t *max_len, int *split, size_t *len)
+{
+    int ret = mbedtls_ssl_get_max_out_record_payload(ssl);
+    size_t expansion, room, payload;
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t out_buf_len = ssl->out_buf_len;
+#else
+    size_t out_buf_len = MBEDTLS_SSL_OUT_BUFFER_LEN;
+#endif
+
+    if (ret < 0) {
+        MBEDTLS_SSL_DEBUG_RET(1, "mbedtls_ssl_get_max_out_record_payload", ret);
+        return ret;
+    }
+    *max_len = (size_t) ret;
+    *split = 0;
+    *len = 0;
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    /* One record, in a datagram of its own */
+    if (ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM) {
+        if (total > *max_len) {
+            MBEDTLS_SSL_DEBUG_MSG(1, ("fragment larger than the (negotiated) "
+                                      "maximum fragment length: %" MBEDTLS_PRINTF_SIZET
+                                      " > %" MBEDTLS_PRINTF_SIZET,
+                                      total, *max_len));
+            return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+        }
+
+        *len = total;
+        return 0;
+    }
+#endif /* MBEDTLS_SSL_PROTO_DTLS */
+
+#if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
+    if (ssl->conf->cbc_record_splitting !=
+        MBEDTLS_SSL_CBC_RECORD_SPLITTING_DISABLED &&
+        total > 1 &&
+        ssl->minor_ver <= MBEDTLS_SSL_MINOR_VERSION_1 &&
+        mbedtls_cipher_get_cipher_mode(&ssl->transform_out->cipher_ctx_enc)
+        == MBEDTLS_MODE_CBC) {
+        *split = 1;
+    }
+#endif /* MBEDTLS_SSL_CBC_RECORD_SPLITTING */
+
+    /* Records are only queued when their size is bounded, which it is not
+     * with compression, and when they are written to out_buf, which they
+     * are not by a hardware accelerator. Otherwise, write one. */
+    ret = mbedtls_ssl_get_record_expansion(ssl);
+#if defined(MBEDTLS_SSL_HW_RECORD_ACCEL)
+    if (mbedtls_ssl_hw_record_write != NULL) {
+        ret = MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+    }
+#endif
+    if (ret < 0) {
+        *len = *split ? 1 : total < *max_len ? total : *max_len;
+        return 0;
+    }
+    expansion = (size_t) ret;
+
+    /* Queue records for as long as the next one fits in out_buf, after
+     * the 8 bytes reserved for the counter of the first one. */
+    room = out_buf_len - 8;
+    do {
+        payload = (*split && *len == 0) ? 1 : *max_len;
+        if (payload > total - *len) {
+            payload = total - *len;
+        }
+
+        if (payload + expansion > room) {
+            if (*len != 0) {
+                break;
+            }
+            room = payload + expansion;
+        }
+        room -= payload + expansion;
+        *len += payload;
+    } while (*len < total);
+
+    return 0;
+}
+
+/*
+ * Copy the next len bytes of a gather list into buf
+ */
+static void ssl_iov_gather(unsigned char *buf, size_t len,
+                           const mbedtls_ssl_iovec **iov, size_t *offset)
+{
+    size_t n;
+
+    while (len > 0) {
+        n = (*iov)->len - *offset;
+        if (n > len) {
+            n = len;
+        }
+
+        if (n > 0) {
+            memcpy(buf, (*iov)->buf + *offset, n);
+            buf += n;
+            len -= n;
+            *offset += n;
+        }
+
+        if (*offset == (*iov)->len) {
+            (*iov)++;
+            *offset = 0;
+        }
+    }
+}
+
+/*
+ * Write application data from a gather list: the data goes straight from
+ * the caller's buffers into as many records as fit in the output buffer,
+ * which are then sent together.
+ */
+int mbedtls_ssl_writev(mbedtls_ssl_context *ssl,
+                       const mbedtls_ssl_iovec *iov, size_t iovcnt)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i, total = 0, max_len, len, written, offset = 0;
+    int split;
+
+    MBEDTLS_SSL_DEBUG_MSG(2, ("=> writev"));
+
+    if (ssl == NULL || ssl->conf == NULL || (iov == NULL && iovcnt != 0)) {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].buf == NULL && iov[i].len != 0) {
+            return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+        }
+        total += iov[i].len;
+        if (total < iov[i].len) {
+            return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+        }
+    }
+
+#if defined(MBEDTLS_SSL_RENEGOTIATION)
+    if ((ret = ssl_check_ctr_renegotiate(ssl)) != 0) {
+        MBEDTLS_SSL_DEBUG_RET(1, "ssl_check_ctr_renegotiate", ret);
+        return ret;
+    }
+#endif
+
+    if (ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+        if ((ret = mbedtls_ssl_handshake(ssl)) != 0) {
+            MBEDTLS_SSL_DEBUG_RET(1, "mbedtls_ssl_handshake", ret);
+            return ret;
+        }
+    }
+
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    /* After the handshake, out_buf only holds one record of the negotiated
+     * maximum fragment length. Grow it back to its full size before the
+     * first call that needs more than one record, so that they are queued.
+     * Nothing is pending then, so a repeated call after
+     * MBEDTLS_ERR_SSL_WANT_WRITE sees the same buffer and layout. */
+    if (ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_STREAM &&
+        ssl->out_left == 0 &&
+        total > ssl->out_buf_len - (size_t) (ssl->out_msg - ssl->out_buf)) {
+        mbedtls_ssl_grow_out_buf(ssl, MBEDTLS_SSL_OUT_BUFFER_LEN);
+    }
+#endif
+
+    if ((ret = ssl_writev_layout(ssl, total, &max_len, &split, &len)) != 0) {
+        return ret;
+    }
+
+    if (ssl->out_left == 0) {
+        /*
+         * First attempt: build the records. A repeated call after
+         * MBEDTLS_ERR_SSL_WANT_WRITE only has to flush them.
+         */
+        written = 0;
+        do {
+            ssl->out_msglen = (split && written == 0) ? 1 : max_len;
+            if (ssl->out_msglen > len - written) {
+                ssl->out_msglen = len - written;
+            }
+            ssl->out_msgtype = MBEDTLS_SSL_MSG_APPLICATION_DATA;
+            ssl_iov_gather(ssl->out_msg, ssl->out_msglen, &iov, &offset);
+            written += ssl->out_msglen;
+
+            if ((ret = mbedtls_ssl_write_record(ssl, SSL_DONT_FORCE_FLUSH)) != 0) {
+                MBEDTLS_SSL_DEBUG_RET(1, "mbedtls_ssl_write_record", ret);
+                return ret;
+            }
+        } while (written < len);
+    }
+
+    if ((ret = mbedtls_ssl_flush_output(ssl)) != 0) {
+        MBEDTLS_SSL_DEBUG_RET(1, "mbedtls_ssl_flush_output", ret);
+        return ret;
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG(2, ("<= writev"));
+
+    return (int) len;
+}
+
 /*
  * Notify the peer that the connection is being closed
  */
@@ -297,6 +297,48 @@ static void handle_buffer_resizing(mbedtls_ssl_context *ssl, int downsizing,
         ssl->in_iv = ssl->in_buf + iv_offset_in;
     }
 }
+
+/*
+ * Grow the output buffer to len bytes while nothing is pending in it,
+ * keeping the record pointers at the same offsets. If memory is short,
+ * the buffer is left as it is.
+ */
+void mbedtls_ssl_grow_out_buf(mbedtls_ssl_context *ssl, size_t len)
+{
+    size_t hdr_offset, ctr_offset, len_offset, iv_offset, msg_offset;
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
+    size_t cid_offset;
+#endif
+
+    if (ssl->out_buf == NULL || ssl->out_buf_len >= len || ssl->out_left != 0) {
+        return;
+    }
+
+    hdr_offset = ssl->out_hdr - ssl->out_buf;
+    ctr_offset = ssl->out_ctr - ssl->out_buf;
+    len_offset = ssl->out_len - ssl->out_buf;
+    iv_offset = ssl->out_iv - ssl->out_buf;
+    msg_offset = ssl->out_msg - ssl->out_buf;
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
+    cid_offset = ssl->out_cid - ssl->out_buf;
+#endif
+
+    if (resize_buffer(&ssl->out_buf, len, &ssl->out_buf_len) != 0) {
+        MBEDTLS_SSL_DEBUG_MSG(1, ("output buffer resizing failed - out of memory"));
+        return;
+    }
+    MBEDTLS_SSL_DEBUG_MSG(2, ("Reallocating out_buf to %" MBEDTLS_PRINTF_SIZET,
+                              len));
+
+    ssl->out_hdr = ssl->out_buf + hdr_offset;
+    ssl->out_ctr = ssl->out_buf + ctr_offset;
+    ssl->out_len = ssl->out_buf + len_offset;
+    ssl->out_iv = ssl->out_buf + iv_offset;
+    ssl->out_msg = ssl->out_buf + msg_offset;
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
+    ssl->out_cid = ssl->out_buf + cid_offset;
+#endif
+}
 #endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
 
 /*
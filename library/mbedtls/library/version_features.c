@@ -672,6 +672,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_CTR_DRBG_C)
     "MBEDTLS_CTR_DRBG_C",
 #endif /* MBEDTLS_CTR_DRBG_C */
+#if defined(MBEDTLS_CTR_DRBG_POOL_C)
+    "MBEDTLS_CTR_DRBG_POOL_C",
+#endif /* MBEDTLS_CTR_DRBG_POOL_C */
 #if defined(MBEDTLS_DEBUG_C)
     "MBEDTLS_DEBUG_C",
 #endif /* MBEDTLS_DEBUG_C */
@@ -687,6 +690,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_ECDSA_C)
     "MBEDTLS_ECDSA_C",
 #endif /* MBEDTLS_ECDSA_C */
+#if defined(MBEDTLS_ECDSA_SCHED_C)
+    "MBEDTLS_ECDSA_SCHED_C",
+#endif /* MBEDTLS_ECDSA_SCHED_C */
 #if defined(MBEDTLS_ECJPAKE_C)
     "MBEDTLS_ECJPAKE_C",
 #endif /* MBEDTLS_ECJPAKE_C */
@@ -726,6 +732,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_MD5_C)
     "MBEDTLS_MD5_C",
 #endif /* MBEDTLS_MD5_C */
+#if defined(MBEDTLS_MEMORY_ARENA_C)
+    "MBEDTLS_MEMORY_ARENA_C",
+#endif /* MBEDTLS_MEMORY_ARENA_C */
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
     "MBEDTLS_MEMORY_BUFFER_ALLOC_C",
 #endif /* MBEDTLS_MEMORY_BUFFER_ALLOC_C */
@@ -780,6 +789,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_PSA_ITS_FILE_C)
     "MBEDTLS_PSA_ITS_FILE_C",
 #endif /* MBEDTLS_PSA_ITS_FILE_C */
+#if defined(MBEDTLS_PSA_ITS_LOG_C)
+    "MBEDTLS_PSA_ITS_LOG_C",
+#endif /* MBEDTLS_PSA_ITS_LOG_C */
 #if defined(MBEDTLS_RIPEMD160_C)
     "MBEDTLS_RIPEMD160_C",
 #endif /* MBEDTLS_RIPEMD160_C */
@@ -831,6 +843,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_X509_CRL_PARSE_C)
     "MBEDTLS_X509_CRL_PARSE_C",
 #endif /* MBEDTLS_X509_CRL_PARSE_C */
+#if defined(MBEDTLS_X509_TRUST_STORE_C)
+    "MBEDTLS_X509_TRUST_STORE_C",
+#endif /* MBEDTLS_X509_TRUST_STORE_C */
 #if defined(MBEDTLS_X509_CSR_PARSE_C)
     "MBEDTLS_X509_CSR_PARSE_C",
 #endif /* MBEDTLS_X509_CSR_PARSE_C */
@@ -208,16 +208,118 @@ static int x509_get_crl_entry_ext(unsigned char **p,
     return 0;
 }
 
+/*
+ * Order of CRL entries for mbedtls_x509_crt_is_revoked(): by length, then
+ * by value of the serial number
+ */
+static int x509_crl_serial_cmp(const mbedtls_x509_buf *a,
+                               const mbedtls_x509_buf *b)
+{
+    if (a->len != b->len) {
+        return a->len < b->len ? -1 : 1;
+    }
+
+    return memcmp(a->p, b->p, a->len);
+}
+
+/*
+ * Heapsort of the indexes idx[0..n-1] of entries by serial number
+ */
+static void x509_crl_sort_entries(const mbedtls_x509_crl_entry *entries,
+                                  size_t *idx, size_t n)
+{
+    size_t start, end, root, child, tmp;
+
+    for (start = n / 2, end = n; end > 1;) {
+        if (start > 0) {
+            root = --start;
+        } else {
+            tmp = idx[0];
+            idx[0] = idx[--end];
+            idx[end] = tmp;
+            root = 0;
+        }
+
+        while ((child = 2 * root + 1) < end) {
+            if (child + 1 < end &&
+                x509_crl_serial_cmp(&entries[idx[child]].serial,
+                                    &entries[idx[child + 1]].serial) < 0) {
+                child++;
+            }
+            if (x509_crl_serial_cmp(&entries[idx[root]].serial,
+                                    &entries[idx[child]].serial) >= 0) {
+                break;
+            }
+            tmp = idx[root];
+            idx[root] = idx[child];
+            idx[child] = tmp;
+            root = child;
+        }
+    }
+}
+
+/*
+ * Sort the n entries of crl->entries, parsed in CRL order, by serial
+ * number, and chain them in CRL order from crl->entry
+ */
+static int x509_crl_index_entries(mbedtls_x509_crl *crl, size_t n)
+{
+    mbedtls_x509_crl_entry *entries = crl->entries, tmp;
+    size_t *idx, *pos, i, j, k;
+
+    idx = mbedtls_calloc(2 * n, sizeof(size_t));
+    if (idx == NULL) {
+        return MBEDTLS_ERR_X509_ALLOC_FAILED;
+    }
+    pos = idx + n;
+
+    for (i = 0; i < n; i++) {
+        idx[i] = i;
+    }
+    x509_crl_sort_entries(entries, idx, n);
+
+    /* pos[i] is where the i-th entry in CRL order goes */
+    for (k = 0; k < n; k++) {
+        pos[idx[k]] = k;
+    }
+
+    /* Move the entries in place along the cycles of the permutation */
+    for (k = 0; k < n; k++) {
+        if (idx[k] == k) {
+            continue;
+        }
+        tmp = entries[k];
+        for (i = k; idx[i] != k; i = j) {
+            j = idx[i];
+            entries[i] = entries[j];
+            idx[i] = i;
+        }
+        entries[i] = tmp;
+        idx[i] = i;
+    }
+
+    for (i = 0; i + 1 < n; i++) {
+        entries[pos[i]].next = &entries[pos[i + 1]];
+    }
+    entries[pos[n - 1]].next = NULL;
+    crl->entry = entries[pos[0]];
+
+    mbedtls_free(idx);
+
+    return 0;
+}
+
 /*
  * X.509 CRL Entries
  */
 static int x509_get_entries(unsigned char **p,
                             const unsigned char *end,
-                            mbedtls_x509_crl_entry *entry)
+                            mbedtls_x509_crl *crl)
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    size_t entry_len;
-    mbedtls_x509_crl_entry *cur_entry = entry;
+    size_t entry_len, n, i;
+    unsigned char *q;
+    mbedtls_x509_crl_entry *cur_entry = &crl->entry;
 
     if (*p == end) {
         return 0;
@@ -234,7 +336,29 @@ static int x509_get_entries(unsigned char **p,
 
     end = *p + entry_len;
 
-    while (*p < end) {
+    /*
+     * Count the entries, plus one for trailing data that is not an entry
+     * (and which the loop below rejects), to store them in one array
+     */
+    for (n = 0, q = *p; q < end; n++) {
+        if (mbedtls_asn1_get_tag(&q, end, &entry_len,
+                                 MBEDTLS_ASN1_SEQUENCE | MBEDTLS_ASN1_CONSTRUCTED) != 0) {
+            n++;
+            break;
+        }
+        q += entry_len;
+    }
+
+    if (n > 1) {
+        crl->entries = mbedtls_calloc(n, sizeof(mbedtls_x509_crl_entry));
+        if (crl->entries == NULL) {
+            return MBEDTLS_ERR_X509_ALLOC_FAILED;
+        }
+        crl->entry_count = n;
+        cur_entry = crl->entries;
+    }
+
+    for (i = 1; *p < end; i++) {
         size_t len2;
         const unsigned char *end2;
 
@@ -263,16 +387,19 @@ static int x509_get_entries(unsigned char **p,
         }
 
         if (*p < end) {
-            cur_entry->next = mbedtls_calloc(1, sizeof(mbedtls_x509_crl_entry));
-
-            if (cur_entry->next == NULL) {
-                return MBEDTLS_ERR_X509_ALLOC_FAILED;
+            if (i >= n) {
+                return MBEDTLS_ERR_X509_INVALID_FORMAT;
             }
 
-            cur_entry = cur_entry->next;
+            cur_entry = &crl->entries[i];
         }
     }
 
+    if (crl->entries != NULL) {
+        crl->entry_count = i - 1;
+        return x509_crl_index_entries(crl, crl->entry_count);
+    }
+
     return 0;
 }
 
@@ -440,7 +567,7 @@ int mbedtls_x509_crl_parse_der(mbedtls_x509_crl *chain,
      *                                   -- if present, MUST be v2
      *                        } OPTIONAL
      */
-    if ((ret = x509_get_entries(&p, end, &crl->entry)) != 0) {
+    if ((ret = x509_get_entries(&p, end, crl)) != 0) {
         mbedtls_x509_crl_free(crl);
         return ret;
     }
@@ -678,8 +805,6 @@ void mbedtls_x509_crl_free(mbedtls_x509_crl *crl)
     mbedtls_x509_crl *crl_prv;
     mbedtls_x509_name *name_cur;
     mbedtls_x509_name *name_prv;
-    mbedtls_x509_crl_entry *entry_cur;
-    mbedtls_x509_crl_entry *entry_prv;
 
     if (crl == NULL) {
         return;
@@ -698,13 +823,11 @@ void mbedtls_x509_crl_free(mbedtls_x509_crl *crl)
             mbedtls_free(name_prv);
         }
 
-        entry_cur = crl_cur->entry.next;
-        while (entry_cur != NULL) {
-            entry_prv = entry_cur;
-            entry_cur = entry_cur->next;
-            mbedtls_platform_zeroize(entry_prv,
+        if (crl_cur->entries != NULL) {
+            mbedtls_platform_zeroize(crl_cur->entries,
+                                     crl_cur->entry_count *
                                      sizeof(mbedtls_x509_crl_entry));
-            mbedtls_free(entry_prv);
+            mbedtls_free(crl_cur->entries);
         }
 
         if (crl_cur->raw.p != NULL) {
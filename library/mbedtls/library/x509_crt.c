@@ -2333,6 +2333,35 @@ int mbedtls_x509_crt_is_revoked(const mbedtls_x509_crt *crt, const mbedtls_x509_
 {
     const mbedtls_x509_crl_entry *cur = &crl->entry;
 
+    /* Binary search on the entries sorted by length, then value of the
+     * serial number */
+    if (crl->entries != NULL) {
+        size_t lo = 0, hi = crl->entry_count, mid;
+        int cmp;
+
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            cur = &crl->entries[mid];
+
+            if (crt->serial.len != cur->serial.len) {
+                cmp = crt->serial.len < cur->serial.len ? -1 : 1;
+            } else {
+                cmp = memcmp(crt->serial.p, cur->serial.p, crt->serial.len);
+            }
+
+            if (cmp == 0) {
+                return 1;
+            }
+            if (cmp < 0) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+
+        return 0;
+    }
+
     while (cur != NULL && cur->serial.len != 0) {
         if (crt->serial.len == cur->serial.len &&
             memcmp(crt->serial.p, cur->serial.p, crt->serial.len) == 0) {
@@ -0,0 +1,435 @@
+/*
+ *  Precompiled X.509 trust stores
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+
+#include "common.h"
+
+#if defined(MBEDTLS_X509_TRUST_STORE_C)
+
+#include "mbedtls/x509_trust_store.h"
+#include "mbedtls/asn1.h"
+#include "mbedtls/error.h"
+#include "mbedtls/platform.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_FS_IO)
+#if defined(_WIN32) && !defined(EFIX64) && !defined(EFI32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif /* MBEDTLS_FS_IO */
+
+/*
+ * Layout of a trust store, all integers little-endian:
+ *
+ *     header      magic "mTS1", version, count, buckets        (4 x 32 bits)
+ *     index       first entry of each bucket, then count  (buckets + 1 x 32)
+ *     entries     subject hash (64), DER offset (32), DER length (32)
+ *     data        the DER certificates
+ *
+ * Entries are ordered by bucket, which is the low bits of the hash, so the
+ * entries of bucket b are index[b] .. index[b + 1] - 1. Offsets are from the
+ * start of the store.
+ */
+#define TRUST_STORE_MAGIC       "mTS1"
+#define TRUST_STORE_VERSION     1
+#define TRUST_STORE_HDR_LEN     16
+#define TRUST_STORE_ENTRY_LEN   16
+
+#define TRUST_STORE_INDEX(store, b)                                     \
+    MBEDTLS_GET_UINT32_LE((store)->buf, TRUST_STORE_HDR_LEN + 4 * (b))
+
+#define TRUST_STORE_ENTRY(store, i)                                     \
+    ((store)->buf + TRUST_STORE_HDR_LEN + 4 * ((size_t) (store)->buckets + 1) + \
+     TRUST_STORE_ENTRY_LEN * (i))
+
+/*
+ * FNV-1a, over a form of the name in which all names that x509_name_cmp()
+ * in x509_crt.c considers equal are identical: UTF8String and
+ * PrintableString values are one class, compared without ASCII case.
+ */
+static uint64_t x509_trust_store_hash(uint64_t h, const unsigned char *p,
+                                      size_t len, int fold)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        unsigned char c = p[i];
+
+        if (fold && c >= 'A' && c <= 'Z') {
+            c |= 0x20;
+        }
+        h = (h ^ c) * 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+static uint64_t x509_trust_store_name_hash(const mbedtls_x509_name *name)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    unsigned char hdr[6];
+
+    for (; name != NULL; name = name->next) {
+        int is_string = name->val.tag == MBEDTLS_ASN1_UTF8_STRING ||
+                        name->val.tag == MBEDTLS_ASN1_PRINTABLE_STRING;
+
+        hdr[0] = (unsigned char) name->oid.tag;
+        MBEDTLS_PUT_UINT32_LE((uint32_t) name->oid.len, hdr, 1);
+        h = x509_trust_store_hash(h, hdr, 5, 0);
+        h = x509_trust_store_hash(h, name->oid.p, name->oid.len, 0);
+
+        hdr[0] = is_string ? 0 : (unsigned char) name->val.tag;
+        MBEDTLS_PUT_UINT32_LE((uint32_t) name->val.len, hdr, 1);
+        hdr[5] = name->next_merged != 0;
+        h = x509_trust_store_hash(h, hdr, 6, 0);
+        h = x509_trust_store_hash(h, name->val.p, name->val.len, is_string);
+    }
+
+    return h;
+}
+
+void mbedtls_x509_trust_store_init(mbedtls_x509_trust_store *store)
+{
+    memset(store, 0, sizeof(mbedtls_x509_trust_store));
+}
+
+typedef struct {
+    uint64_t hash;
+    const mbedtls_x509_crt *crt;
+} x509_trust_store_item;
+
+int mbedtls_x509_trust_store_write(const mbedtls_x509_crt *chain,
+                                   unsigned char *buf, size_t size,
+                                   size_t *olen)
+{
+    int ret = 0;
+    const mbedtls_x509_crt *crt;
+    x509_trust_store_item *items = NULL, *sorted = NULL;
+    uint32_t *index = NULL;
+    size_t n = 0, count, buckets = 1, total, offset, i, j, b;
+    unsigned char *p;
+
+    for (crt = chain; crt != NULL; crt = crt->next) {
+        if (crt->raw.len != 0) {
+            n++;
+        }
+    }
+    if (n == 0 || n > 0xFFFFFFFF / TRUST_STORE_ENTRY_LEN) {
+        return MBEDTLS_ERR_X509_BAD_INPUT_DATA;
+    }
+    while (buckets < n) {
+        buckets <<= 1;
+    }
+
+    items = mbedtls_calloc(n, sizeof(x509_trust_store_item));
+    sorted = mbedtls_calloc(n, sizeof(x509_trust_store_item));
+    index = mbedtls_calloc(buckets + 1, sizeof(uint32_t));
+    if (items == NULL || sorted == NULL || index == NULL) {
+        ret = MBEDTLS_ERR_X509_ALLOC_FAILED;
+        goto exit;
+    }
+
+    /* Counting sort by bucket: index[b + 1] counts the entries of b first,
+     * then index[b] becomes the position of the next entry of b */
+    for (crt = chain, i = 0; crt != NULL; crt = crt->next) {
+        if (crt->raw.len != 0) {
+            items[i].hash = x509_trust_store_name_hash(&crt->subject);
+            items[i].crt = crt;
+            index[(items[i].hash & (buckets - 1)) + 1]++;
+            i++;
+        }
+    }
+    for (b = 0; b < buckets; b++) {
+        index[b + 1] += index[b];
+    }
+    for (i = 0; i < n; i++) {
+        sorted[index[items[i].hash & (buckets - 1)]++] = items[i];
+    }
+
+    /* index[b] is now the end of bucket b. Drop duplicate certificates,
+     * which are in the same bucket, and total up the rest. */
+    total = 0;
+    for (b = 0, i = 0, count = 0; b < buckets; b++) {
+        size_t first = count;
+
+        for (; i < index[b]; i++) {
+            for (j = first; j < count; j++) {
+                if (sorted[j].hash == sorted[i].hash &&
+                    sorted[j].crt->raw.len == sorted[i].crt->raw.len &&
+                    memcmp(sorted[j].crt->raw.p, sorted[i].crt->raw.p,
+                           sorted[i].crt->raw.len) == 0) {
+                    break;
+                }
+            }
+            if (j == count) {
+                if (sorted[i].crt->raw.len > 0xFFFFFFFF - total) {
+                    ret = MBEDTLS_ERR_X509_BAD_INPUT_DATA;
+                    goto exit;
+                }
+                total += sorted[i].crt->raw.len;
+                sorted[count++] = sorted[i];
+            }
+        }
+        index[b] = (uint32_t) count;
+    }
+
+    offset = TRUST_STORE_HDR_LEN + 4 * (buckets + 1) +
+             TRUST_STORE_ENTRY_LEN * count;
+    if (total > 0xFFFFFFFF - offset) {
+        ret = MBEDTLS_ERR_X509_BAD_INPUT_DATA;
+        goto exit;
+    }
+    total += offset;
+
+    *olen = total;
+    if (buf == NULL || size < total) {
+        ret = MBEDTLS_ERR_X509_BUFFER_TOO_SMALL;
+        goto exit;
+    }
+
+    memcpy(buf, TRUST_STORE_MAGIC, 4);
+    MBEDTLS_PUT_UINT32_LE(TRUST_STORE_VERSION, buf, 4);
+    MBEDTLS_PUT_UINT32_LE((uint32_t) count, buf, 8);
+    MBEDTLS_PUT_UINT32_LE((uint32_t) buckets, buf, 12);
+
+    /* index[b] holds the end of bucket b, i.e. the start of bucket b + 1 */
+    p = buf + TRUST_STORE_HDR_LEN;
+    MBEDTLS_PUT_UINT32_LE(0, p, 0);
+    for (b = 0; b < buckets; b++) {
+        MBEDTLS_PUT_UINT32_LE(index[b], p, 4 * (b + 1));
+    }
+
+    p += 4 * (buckets + 1);
+    for (i = 0; i < count; i++, p += TRUST_STORE_ENTRY_LEN) {
+        MBEDTLS_PUT_UINT64_LE(sorted[i].hash, p, 0);
+        MBEDTLS_PUT_UINT32_LE((uint32_t) offset, p, 8);
+        MBEDTLS_PUT_UINT32_LE((uint32_t) sorted[i].crt->raw.len, p, 12);
+        memcpy(buf + offset, sorted[i].crt->raw.p, sorted[i].crt->raw.len);
+        offset += sorted[i].crt->raw.len;
+    }
+
+exit:
+    mbedtls_free(items);
+    mbedtls_free(sorted);
+    mbedtls_free(index);
+
+    return ret;
+}
+
+int mbedtls_x509_trust_store_load(mbedtls_x509_trust_store *store,
+                                  const unsigned char *buf, size_t len)
+{
+    uint32_t count, buckets, b, i, start, end;
+    size_t data;
+
+    if (len < TRUST_STORE_HDR_LEN ||
+        memcmp(buf, TRUST_STORE_MAGIC, 4) != 0 ||
+        MBEDTLS_GET_UINT32_LE(buf, 4) != TRUST_STORE_VERSION) {
+        return MBEDTLS_ERR_X509_INVALID_FORMAT;
+    }
+
+    count = MBEDTLS_GET_UINT32_LE(buf, 8);
+    buckets = MBEDTLS_GET_UINT32_LE(buf, 12);
+    if (buckets == 0 || (buckets & (buckets - 1)) != 0 ||
+        (size_t) buckets + 1 > (len - TRUST_STORE_HDR_LEN) / 4) {
+        return MBEDTLS_ERR_X509_INVALID_FORMAT;
+    }
+    data = TRUST_STORE_HDR_LEN + 4 * ((size_t) buckets + 1);
+    if (count > (len - data) / TRUST_STORE_ENTRY_LEN) {
+        return MBEDTLS_ERR_X509_INVALID_FORMAT;
+    }
+    data += TRUST_STORE_ENTRY_LEN * (size_t) count;
+
+    store->buf = buf;
+    store->len = len;
+    store->count = count;
+    store->buckets = buckets;
+
+    /* The index must cover the entries in order, each entry must be in the
+     * bucket of its hash and its certificate in the data */
+    if (TRUST_STORE_INDEX(store, 0) != 0 ||
+        TRUST_STORE_INDEX(store, buckets) != count) {
+        goto invalid;
+    }
+    for (b = 0, end = 0; b < buckets; b++) {
+        start = end;
+        end = TRUST_STORE_INDEX(store, b + 1);
+        if (end < start || end > count) {
+            goto invalid;
+        }
+
+        for (i = start; i < end; i++) {
+            const unsigned char *e = TRUST_STORE_ENTRY(store, i);
+            uint32_t off = MBEDTLS_GET_UINT32_LE(e, 8);
+            uint32_t der_len = MBEDTLS_GET_UINT32_LE(e, 12);
+
+            if ((MBEDTLS_GET_UINT64_LE(e, 0) & (buckets - 1)) != b ||
+                off < data || off > len || der_len == 0 ||
+                der_len > len - off) {
+                goto invalid;
+            }
+        }
+    }
+
+    return 0;
+
+invalid:
+    mbedtls_x509_trust_store_init(store);
+    return MBEDTLS_ERR_X509_INVALID_FORMAT;
+}
+
+#if defined(MBEDTLS_FS_IO)
+int mbedtls_x509_trust_store_load_file(mbedtls_x509_trust_store *store,
+                                       const char *path)
+{
+    int ret;
+    void *map;
+    size_t len;
+#if defined(_WIN32) && !defined(EFIX64) && !defined(EFI32)
+    HANDLE file, mapping;
+    LARGE_INTEGER size;
+
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return MBEDTLS_ERR_X509_FILE_IO_ERROR;
+    }
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 ||
+        (unsigned long long) size.QuadPart > (size_t) -1) {
+        CloseHandle(file);
+        return MBEDTLS_ERR_X509_FILE_IO_ERROR;
+    }
+    len = (size_t) size.QuadPart;
+
+    /* The view keeps the mapping and the file open */
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        return MBEDTLS_ERR_X509_FILE_IO_ERROR;
+    }
+    map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (map == NULL) {
+        return MBEDTLS_ERR_X509_FILE_IO_ERROR;
+    }
+
+    if ((ret = mbedtls_x509_trust_store_load(store, map, len)) != 0) {
+        UnmapViewOfFile(map);
+        return ret;
+    }
+#else
+    int fd;
+    struct stat st;
+
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return MBEDTLS_ERR_X509_FILE_IO_ERROR;
+    }
+
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 ||
+        (unsigned long long) st.st_size > (size_t) -1) {
+        close(fd);
+        return MBEDTLS_ERR_X509_FILE_IO_ERROR;
+    }
+    len = (size_t) st.st_size;
+
+    map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return MBEDTLS_ERR_X509_FILE_IO_ERROR;
+    }
+
+    if ((ret = mbedtls_x509_trust_store_load(store, map, len)) != 0) {
+        munmap(map, len);
+        return ret;
+    }
+#endif /* _WIN32 */
+
+    store->mapped = 1;
+
+    return 0;
+}
+#endif /* MBEDTLS_FS_IO */
+
+void mbedtls_x509_trust_store_free(mbedtls_x509_trust_store *store)
+{
+    if (store == NULL) {
+        return;
+    }
+
+#if defined(MBEDTLS_FS_IO)
+    if (store->mapped) {
+#if defined(_WIN32) && !defined(EFIX64) && !defined(EFI32)
+        UnmapViewOfFile(store->buf);
+#else
+        munmap((void *) store->buf, store->len);
+#endif
+    }
+#endif /* MBEDTLS_FS_IO */
+
+    mbedtls_platform_zeroize(store, sizeof(mbedtls_x509_trust_store));
+}
+
+int mbedtls_x509_trust_store_ca_cb(void *p_ctx,
+                                   mbedtls_x509_crt const *child,
+                                   mbedtls_x509_crt **candidate_cas)
+{
+    int ret;
+    const mbedtls_x509_trust_store *store = p_ctx;
+    mbedtls_x509_crt *first = NULL;
+    uint64_t hash;
+    uint32_t b, i, end;
+
+    *candidate_cas = NULL;
+
+    if (store->count == 0) {
+        return 0;
+    }
+
+    hash = x509_trust_store_name_hash(&child->issuer);
+    b = (uint32_t) (hash & (store->buckets - 1));
+    end = TRUST_STORE_INDEX(store, b + 1);
+
+    for (i = TRUST_STORE_INDEX(store, b); i < end; i++) {
+        const unsigned char *e = TRUST_STORE_ENTRY(store, i);
+
+        if (MBEDTLS_GET_UINT64_LE(e, 0) != hash) {
+            continue;
+        }
+
+        if (first == NULL) {
+            first = mbedtls_calloc(1, sizeof(mbedtls_x509_crt));
+            if (first == NULL) {
+                return MBEDTLS_ERR_X509_ALLOC_FAILED;
+            }
+            mbedtls_x509_crt_init(first);
+        }
+
+        /* Appends to the list, pointing into the store */
+        ret = mbedtls_x509_crt_parse_der_nocopy(first,
+                                                store->buf +
+                                                MBEDTLS_GET_UINT32_LE(e, 8),
+                                                MBEDTLS_GET_UINT32_LE(e, 12));
+        if (ret != 0) {
+            mbedtls_x509_crt_free(first);
+            mbedtls_free(first);
+            return ret;
+        }
+    }
+
+    *candidate_cas = first;
+
+    return 0;
+}
+
+#endif /* MBEDTLS_X509_TRUST_STORE_C */
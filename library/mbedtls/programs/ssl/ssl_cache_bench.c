@@ -0,0 +1,233 @@
+/*
+ *  SSL session cache load test: session resumption lookups from many
+ *  threads against one cache.
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/platform.h"
+
+#if !defined(MBEDTLS_SSL_CACHE_C) || !defined(MBEDTLS_SSL_TLS_C) ||         \
+    !defined(MBEDTLS_TIMING_C) || !defined(MBEDTLS_THREADING_C) ||          \
+    !defined(MBEDTLS_THREADING_PTHREAD)
+int main(void)
+{
+    mbedtls_printf("MBEDTLS_SSL_CACHE_C and/or MBEDTLS_SSL_TLS_C and/or "
+                   "MBEDTLS_TIMING_C and/or MBEDTLS_THREADING_C and/or "
+                   "MBEDTLS_THREADING_PTHREAD not defined.\n");
+    mbedtls_exit(0);
+}
+#else
+
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/timing.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DFL_THREADS             8
+#define DFL_SESSIONS            10000
+#define DFL_MAX_ENTRIES         -1
+#define DFL_OPS                 200000
+
+#define MAX_THREADS             256
+
+#define USAGE \
+    "\n usage: ssl_cache_bench param=<>...\n"                               \
+    "\n acceptable parameters:\n"                                           \
+    "    threads=%%d          default: 8 (at most 256)\n"                   \
+    "    sessions=%%d         number of distinct session IDs in use\n"      \
+    "                        default: 10000\n"                              \
+    "    max_entries=%%d      cache size, default: the number of sessions\n" \
+    "    ops=%%d              lookups per thread, default: 200000\n"        \
+    "\n Each thread picks random session IDs, resumes them from the cache\n" \
+    " and stores them as after a full handshake when they are not found.\n" \
+    "\n"
+
+/*
+ * global options
+ */
+struct options {
+    int threads;                /* number of client threads             */
+    int sessions;               /* number of distinct session IDs       */
+    int max_entries;            /* maximum number of cache entries      */
+    int ops;                    /* lookups per thread                   */
+} opt;
+
+typedef struct {
+    mbedtls_ssl_cache_context *cache;
+    pthread_t thread;
+    uint32_t seed;
+    unsigned long hits;
+    unsigned long misses;
+    int ret;
+} thread_info_t;
+
+static void *bench_thread(void *data)
+{
+    thread_info_t *info = (thread_info_t *) data;
+    mbedtls_ssl_session session;
+    uint32_t x = info->seed, i;
+    int n, ret;
+
+    mbedtls_ssl_session_init(&session);
+
+    for (n = 0; n < opt.ops; n++) {
+        /* xorshift32 */
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        i = x % (uint32_t) opt.sessions;
+
+        session.id_len = sizeof(session.id);
+        memset(session.id, 0x5a, session.id_len);
+        session.id[0] = (unsigned char) (i >> 24);
+        session.id[1] = (unsigned char) (i >> 16);
+        session.id[2] = (unsigned char) (i >> 8);
+        session.id[3] = (unsigned char) i;
+
+        ret = mbedtls_ssl_cache_get(info->cache, &session);
+        if (ret == 0) {
+            info->hits++;
+            continue;
+        }
+        if (ret != MBEDTLS_ERR_SSL_CACHE_ENTRY_NOT_FOUND) {
+            info->ret = ret;
+            break;
+        }
+
+        info->misses++;
+        session.ciphersuite = (int) (i & 0xffff);
+        if ((ret = mbedtls_ssl_cache_set(info->cache, &session)) != 0) {
+            info->ret = ret;
+            break;
+        }
+    }
+
+    mbedtls_ssl_session_free(&session);
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    int exit_code = MBEDTLS_EXIT_FAILURE;
+    mbedtls_ssl_cache_context cache;
+    static thread_info_t threads[MAX_THREADS];
+    struct mbedtls_timing_hr_time timer;
+    unsigned long elapsed, hits = 0, misses = 0;
+    int i, started = 0;
+    char *p, *q;
+
+    mbedtls_ssl_cache_init(&cache);
+
+    opt.threads             = DFL_THREADS;
+    opt.sessions            = DFL_SESSIONS;
+    opt.max_entries         = DFL_MAX_ENTRIES;
+    opt.ops                 = DFL_OPS;
+
+    for (i = 1; i < argc; i++) {
+        p = argv[i];
+        if ((q = strchr(p, '=')) == NULL) {
+            goto usage;
+        }
+        *q++ = '\0';
+
+        if (strcmp(p, "threads") == 0) {
+            opt.threads = atoi(q);
+            if (opt.threads < 1 || opt.threads > MAX_THREADS) {
+                goto usage;
+            }
+        } else if (strcmp(p, "sessions") == 0) {
+            opt.sessions = atoi(q);
+            if (opt.sessions < 1) {
+                goto usage;
+            }
+        } else if (strcmp(p, "max_entries") == 0) {
+            opt.max_entries = atoi(q);
+            if (opt.max_entries < 1) {
+                goto usage;
+            }
+        } else if (strcmp(p, "ops") == 0) {
+            opt.ops = atoi(q);
+            if (opt.ops < 1) {
+                goto usage;
+            }
+        } else {
+usage:
+            mbedtls_printf(USAGE);
+            goto exit;
+        }
+    }
+
+    if (opt.max_entries == DFL_MAX_ENTRIES) {
+        opt.max_entries = opt.sessions;
+    }
+    mbedtls_ssl_cache_set_max_entries(&cache, opt.max_entries);
+
+    mbedtls_printf("\n  . %d threads, %d sessions, %d cache entries, "
+                   "%d shards, %d lookups per thread ...",
+                   opt.threads, opt.sessions, opt.max_entries,
+                   MBEDTLS_SSL_CACHE_SHARDS, opt.ops);
+    fflush(stdout);
+
+    (void) mbedtls_timing_get_timer(&timer, 1);
+
+    for (i = 0; i < opt.threads; i++) {
+        threads[i].cache = &cache;
+        threads[i].seed = 2463534242u + 0x9e3779b9u * (uint32_t) i;
+        if (pthread_create(&threads[i].thread, NULL, bench_thread,
+                           &threads[i]) != 0) {
+            mbedtls_printf(" failed\n  !  pthread_create failed\n\n");
+            break;
+        }
+        started++;
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i].thread, NULL);
+    }
+
+    elapsed = mbedtls_timing_get_timer(&timer, 0);
+
+    if (started < opt.threads) {
+        goto exit;
+    }
+
+    for (i = 0; i < opt.threads; i++) {
+        if (threads[i].ret != 0) {
+            mbedtls_printf(" failed\n  !  thread %d: cache returned -0x%x\n\n",
+                           i, (unsigned int) -threads[i].ret);
+            goto exit;
+        }
+        hits += threads[i].hits;
+        misses += threads[i].misses;
+    }
+
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+
+    mbedtls_printf(" ok\n");
+    mbedtls_printf("  . %lu lookups in %lu ms: %.0f lookups/s, %.1f%% resumed\n\n",
+                   hits + misses, elapsed,
+                   (double) (hits + misses) * 1000.0 / (double) elapsed,
+                   100.0 * (double) hits / (double) (hits + misses));
+
+    exit_code = MBEDTLS_EXIT_SUCCESS;
+
+exit:
+    mbedtls_ssl_cache_free(&cache);
+
+    mbedtls_exit(exit_code);
+}
+#endif /* MBEDTLS_SSL_CACHE_C && MBEDTLS_SSL_TLS_C && MBEDTLS_TIMING_C &&
+          MBEDTLS_THREADING_C && MBEDTLS_THREADING_PTHREAD */
@@ -1872,6 +1872,14 @@ int query_config(const char *config)
     }
 #endif /* MBEDTLS_CTR_DRBG_C */
 
+#if defined(MBEDTLS_CTR_DRBG_POOL_C)
+    if( strcmp( "MBEDTLS_CTR_DRBG_POOL_C", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_CTR_DRBG_POOL_C );
+        return( 0 );
+    }
+#endif /* MBEDTLS_CTR_DRBG_POOL_C */
+
 #if defined(MBEDTLS_DEBUG_C)
     if( strcmp( "MBEDTLS_DEBUG_C", config ) == 0 )
     {
@@ -1912,6 +1920,14 @@ int query_config(const char *config)
     }
 #endif /* MBEDTLS_ECDSA_C */
 
+#if defined(MBEDTLS_ECDSA_SCHED_C)
+    if( strcmp( "MBEDTLS_ECDSA_SCHED_C", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECDSA_SCHED_C );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECDSA_SCHED_C */
+
 #if defined(MBEDTLS_ECJPAKE_C)
     if( strcmp( "MBEDTLS_ECJPAKE_C", config ) == 0 )
     {
@@ -2016,6 +2032,14 @@ int query_config(const char *config)
     }
 #endif /* MBEDTLS_MD5_C */
 
+#if defined(MBEDTLS_MEMORY_ARENA_C)
+    if( strcmp( "MBEDTLS_MEMORY_ARENA_C", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_MEMORY_ARENA_C );
+        return( 0 );
+    }
+#endif /* MBEDTLS_MEMORY_ARENA_C */
+
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
     if( strcmp( "MBEDTLS_MEMORY_BUFFER_ALLOC_C", config ) == 0 )
     {
@@ -2160,6 +2184,14 @@ int query_config(const char *config)
     }
 #endif /* MBEDTLS_PSA_ITS_FILE_C */
 
+#if defined(MBEDTLS_PSA_ITS_LOG_C)
+    if( strcmp( "MBEDTLS_PSA_ITS_LOG_C", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_PSA_ITS_LOG_C );
+        return( 0 );
+    }
+#endif /* MBEDTLS_PSA_ITS_LOG_C */
+
 #if defined(MBEDTLS_RIPEMD160_C)
     if( strcmp( "MBEDTLS_RIPEMD160_C", config ) == 0 )
     {
@@ -2296,6 +2328,14 @@ int query_config(const char *config)
     }
 #endif /* MBEDTLS_X509_CRL_PARSE_C */
 
+#if defined(MBEDTLS_X509_TRUST_STORE_C)
+    if( strcmp( "MBEDTLS_X509_TRUST_STORE_C", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_TRUST_STORE_C );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_TRUST_STORE_C */
+
 #if defined(MBEDTLS_X509_CSR_PARSE_C)
     if( strcmp( "MBEDTLS_X509_CSR_PARSE_C", config ) == 0 )
     {
@@ -2752,6 +2792,14 @@ int query_config(const char *config)
     }
 #endif /* MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES */
 
+#if defined(MBEDTLS_SSL_CACHE_SHARDS)
+    if( strcmp( "MBEDTLS_SSL_CACHE_SHARDS", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_CACHE_SHARDS );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_CACHE_SHARDS */
+
 #if defined(MBEDTLS_SSL_MAX_CONTENT_LEN)
     if( strcmp( "MBEDTLS_SSL_MAX_CONTENT_LEN", config ) == 0 )
     {
@@ -3746,6 +3794,10 @@ void list_config(void)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_CTR_DRBG_C);
 #endif /* MBEDTLS_CTR_DRBG_C */
 
+#if defined(MBEDTLS_CTR_DRBG_POOL_C)
+    OUTPUT_MACRO_NAME_VALUE(MBEDTLS_CTR_DRBG_POOL_C);
+#endif /* MBEDTLS_CTR_DRBG_POOL_C */
+
 #if defined(MBEDTLS_DEBUG_C)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_DEBUG_C);
 #endif /* MBEDTLS_DEBUG_C */
@@ -3766,6 +3818,10 @@ void list_config(void)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_ECDSA_C);
 #endif /* MBEDTLS_ECDSA_C */
 
+#if defined(MBEDTLS_ECDSA_SCHED_C)
+    OUTPUT_MACRO_NAME_VALUE(MBEDTLS_ECDSA_SCHED_C);
+#endif /* MBEDTLS_ECDSA_SCHED_C */
+
 #if defined(MBEDTLS_ECJPAKE_C)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_ECJPAKE_C);
 #endif /* MBEDTLS_ECJPAKE_C */
@@ -3818,6 +3874,10 @@ void list_config(void)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_MD5_C);
 #endif /* MBEDTLS_MD5_C */
 
+#if defined(MBEDTLS_MEMORY_ARENA_C)
+    OUTPUT_MACRO_NAME_VALUE(MBEDTLS_MEMORY_ARENA_C);
+#endif /* MBEDTLS_MEMORY_ARENA_C */
+
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_MEMORY_BUFFER_ALLOC_C);
 #endif /* MBEDTLS_MEMORY_BUFFER_ALLOC_C */
@@ -3890,6 +3950,10 @@ void list_config(void)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_PSA_ITS_FILE_C);
 #endif /* MBEDTLS_PSA_ITS_FILE_C */
 
+#if defined(MBEDTLS_PSA_ITS_LOG_C)
+    OUTPUT_MACRO_NAME_VALUE(MBEDTLS_PSA_ITS_LOG_C);
+#endif /* MBEDTLS_PSA_ITS_LOG_C */
+
 #if defined(MBEDTLS_RIPEMD160_C)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_RIPEMD160_C);
 #endif /* MBEDTLS_RIPEMD160_C */
@@ -3958,6 +4022,10 @@ void list_config(void)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_X509_CRL_PARSE_C);
 #endif /* MBEDTLS_X509_CRL_PARSE_C */
 
+#if defined(MBEDTLS_X509_TRUST_STORE_C)
+    OUTPUT_MACRO_NAME_VALUE(MBEDTLS_X509_TRUST_STORE_C);
+#endif /* MBEDTLS_X509_TRUST_STORE_C */
+
 #if defined(MBEDTLS_X509_CSR_PARSE_C)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_X509_CSR_PARSE_C);
 #endif /* MBEDTLS_X509_CSR_PARSE_C */
@@ -4186,6 +4254,10 @@ void list_config(void)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES);
 #endif /* MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES */
 
+#if defined(MBEDTLS_SSL_CACHE_SHARDS)
+    OUTPUT_MACRO_NAME_VALUE(MBEDTLS_SSL_CACHE_SHARDS);
+#endif /* MBEDTLS_SSL_CACHE_SHARDS */
+
 #if defined(MBEDTLS_SSL_MAX_CONTENT_LEN)
     OUTPUT_MACRO_NAME_VALUE(MBEDTLS_SSL_MAX_CONTENT_LEN);
 #endif /* MBEDTLS_SSL_MAX_CONTENT_LEN */
@@ -0,0 +1,199 @@
+/*
+ *  Trust store writing application
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/platform.h"
+
+#if !defined(MBEDTLS_X509_TRUST_STORE_C) || !defined(MBEDTLS_FS_IO)
+int main(void)
+{
+    mbedtls_printf("MBEDTLS_X509_TRUST_STORE_C and/or MBEDTLS_FS_IO "
+                   "not defined.\n");
+    mbedtls_exit(0);
+}
+#else
+
+#include "mbedtls/x509_trust_store.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DFL_CA_FILE             ""
+#define DFL_CA_PATH             ""
+#define DFL_OUTPUT_FILENAME     "trust_store.bin"
+
+#define USAGE \
+    "\n usage: trust_store_write param=<>...\n"                             \
+    "\n acceptable parameters:\n"                                           \
+    "    ca_file=%%s          The CA bundle to store (PEM or DER)\n"        \
+    "                        default: \"\" (none)\n"                        \
+    "    ca_path=%%s          A directory of CA certificates to store\n"    \
+    "                        default: \"\" (none)\n"                        \
+    "    output_file=%%s      default: trust_store.bin\n"                   \
+    "\n Certificates that fail to parse are left out.\n"                    \
+    "\n"
+
+
+/*
+ * global options
+ */
+struct options {
+    const char *ca_file;        /* the CA bundle                        */
+    const char *ca_path;        /* the directory of CA certificates     */
+    const char *output_file;    /* where to store the trust store       */
+} opt;
+
+int main(int argc, char *argv[])
+{
+    int ret = 1;
+    int exit_code = MBEDTLS_EXIT_FAILURE;
+    mbedtls_x509_crt cacert;
+    mbedtls_x509_trust_store store;
+    const mbedtls_x509_crt *crt;
+    unsigned char *buf = NULL;
+    size_t len = 0, n = 0;
+    FILE *f = NULL;
+    int i, skipped = 0;
+    char *p, *q;
+
+    /*
+     * Set to sane values
+     */
+    mbedtls_x509_crt_init(&cacert);
+    mbedtls_x509_trust_store_init(&store);
+
+    if (argc < 2) {
+usage:
+        mbedtls_printf(USAGE);
+        goto exit;
+    }
+
+    opt.ca_file             = DFL_CA_FILE;
+    opt.ca_path             = DFL_CA_PATH;
+    opt.output_file         = DFL_OUTPUT_FILENAME;
+
+    for (i = 1; i < argc; i++) {
+        p = argv[i];
+        if ((q = strchr(p, '=')) == NULL) {
+            goto usage;
+        }
+        *q++ = '\0';
+
+        if (strcmp(p, "ca_file") == 0) {
+            opt.ca_file = q;
+        } else if (strcmp(p, "ca_path") == 0) {
+            opt.ca_path = q;
+        } else if (strcmp(p, "output_file") == 0) {
+            opt.output_file = q;
+        } else {
+            goto usage;
+        }
+    }
+
+    if (strlen(opt.ca_file) == 0 && strlen(opt.ca_path) == 0) {
+        goto usage;
+    }
+
+    /*
+     * 1. Load the certificates
+     */
+    mbedtls_printf("\n  . Loading the CA certificates ...");
+    fflush(stdout);
+
+    if (strlen(opt.ca_file)) {
+        ret = mbedtls_x509_crt_parse_file(&cacert, opt.ca_file);
+        if (ret < 0) {
+            mbedtls_printf(" failed\n  !  mbedtls_x509_crt_parse_file returned -0x%x\n\n",
+                           (unsigned int) -ret);
+            goto exit;
+        }
+        skipped += ret;
+    }
+
+    if (strlen(opt.ca_path)) {
+        ret = mbedtls_x509_crt_parse_path(&cacert, opt.ca_path);
+        if (ret < 0) {
+            mbedtls_printf(" failed\n  !  mbedtls_x509_crt_parse_path returned -0x%x\n\n",
+                           (unsigned int) -ret);
+            goto exit;
+        }
+        skipped += ret;
+    }
+
+    for (crt = &cacert; crt != NULL; crt = crt->next) {
+        if (crt->raw.len != 0) {
+            n++;
+        }
+    }
+
+    mbedtls_printf(" ok (%u certificates, %d skipped)\n", (unsigned) n, skipped);
+
+    /*
+     * 2. Serialize them
+     */
+    mbedtls_printf("  . Writing the trust store ...");
+    fflush(stdout);
+
+    ret = mbedtls_x509_trust_store_write(&cacert, NULL, 0, &len);
+    if (ret == MBEDTLS_ERR_X509_BUFFER_TOO_SMALL) {
+        if ((buf = mbedtls_calloc(1, len)) == NULL) {
+            mbedtls_printf(" failed\n  !  out of memory\n\n");
+            goto exit;
+        }
+        ret = mbedtls_x509_trust_store_write(&cacert, buf, len, &len);
+    }
+    if (ret != 0) {
+        mbedtls_printf(" failed\n  !  mbedtls_x509_trust_store_write returned -0x%x\n\n",
+                       (unsigned int) -ret);
+        goto exit;
+    }
+
+    if ((f = fopen(opt.output_file, "wb")) == NULL ||
+        fwrite(buf, 1, len, f) != len) {
+        mbedtls_printf(" failed\n  !  cannot write %s\n\n", opt.output_file);
+        goto exit;
+    }
+    fclose(f);
+    f = NULL;
+
+    /*
+     * 3. Check that it loads back
+     */
+    ret = mbedtls_x509_trust_store_load_file(&store, opt.output_file);
+    if (ret != 0) {
+        mbedtls_printf(" failed\n  !  mbedtls_x509_trust_store_load_file returned -0x%x\n\n",
+                       (unsigned int) -ret);
+        goto exit;
+    }
+
+    mbedtls_printf(" ok (%u unique certificates, %u bytes)\n",
+                   (unsigned) store.count, (unsigned) len);
+
+    exit_code = MBEDTLS_EXIT_SUCCESS;
+
+exit:
+    if (f != NULL) {
+        fclose(f);
+    }
+    mbedtls_free(buf);
+    mbedtls_x509_trust_store_free(&store);
+    mbedtls_x509_crt_free(&cacert);
+
+#if defined(_WIN32)
+    mbedtls_printf("  + Press Enter to exit this program.\n");
+    fflush(stdout); getchar();
+#endif
+
+    mbedtls_exit(exit_code);
+}
+#endif /* MBEDTLS_X509_TRUST_STORE_C && MBEDTLS_FS_IO */
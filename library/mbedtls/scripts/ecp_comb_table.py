@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+
+"""Generate the static comb tables of library/ecp_curves.c.
+
+ecp_mul_comb() in library/ecp.c needs a table of precomputed multiples of
+the point to multiply. For the generator G of a curve the table used to be
+computed on first use and kept in the group; with static tables the group
+starts with it, so fixed-point multiplication needs no heap and no
+precomputation.
+
+For a window size w and d = ceil(nbits / w), the table holds for each
+i = i_{w-1} ... i_1 (in binary) the point
+    T[i] = i_{w-1} 2^((w-1)d) G + ... + i_1 2^d G + G
+in affine coordinates (see ecp_precompute_comb()). The window size must be
+the one chosen by ecp_pick_window_size() for G: 5 for curves below 384
+bits, 6 otherwise.
+
+Usage:
+    scripts/ecp_comb_table.py             print the tables to stdout
+    scripts/ecp_comb_table.py --update    rewrite the tables in place in
+                                          library/ecp_curves.c, between the
+                                          "BEGIN/END ecp_comb_table.py" lines
+"""
+
+# Copyright The Mbed TLS Contributors
+# SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+
+import argparse
+import os
+import re
+import sys
+
+def H(digits):
+    return int(digits, 16)
+
+
+# Short Weierstrass curves y^2 = x^3 + a x + b: p, a, b, Gx, Gy, n
+CURVES = {
+    'secp256r1': (
+        H('FFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF'),
+        -3,
+        H('5AC635D8AA3A93E7B3EBBD55769886BC651D06B0CC53B0F63BCE3C3E27D2604B'),
+        H('6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296'),
+        H('4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5'),
+        H('FFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551'),
+    ),
+    'secp384r1': (
+        H('FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFE'
+          'FFFFFFFF0000000000000000FFFFFFFF'),
+        -3,
+        H('B3312FA7E23EE7E4988E056BE3F82D19181D9C6EFE8141120314088F5013875A'
+          'C656398D8A2ED19D2A85C8EDD3EC2AEF'),
+        H('AA87CA22BE8B05378EB1C71EF320AD746E1D3B628BA79B9859F741E082542A38'
+          '5502F25DBF55296C3A545E3872760AB7'),
+        H('3617DE4A96262C6F5D9E98BF9292DC29F8F41DBD289A147CE9DA3113B5F0B8C0'
+          '0A60B1CE1D7E819D7A431D7C90EA0E5F'),
+        H('FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFC7634D81F4372DDF'
+          '581A0DB248B0A77AECEC196ACCC52973'),
+    ),
+    'secp521r1': (
+        (1 << 521) - 1,
+        -3,
+        H('0051953EB9618E1C9A1F929A21A0B68540EEA2DA725B99B315F3B8B489918EF1'
+          '09E156193951EC7E937B1652C0BD3BB1BF073573DF883D2C34F1EF451FD46B50'
+          '3F00'),
+        H('00C6858E06B70404E9CD9E3ECB662395B4429C648139053FB521F828AF606B4D'
+          '3DBAA14B5E77EFE75928FE1DC127A2FFA8DE3348B3C1856A429BF97E7E31C2E5'
+          'BD66'),
+        H('011839296A789A3BC0045C8A5FB42C7D1BD998F54449579B446817AFBD17273E'
+          '662C97EE72995EF42640C550B9013FAD0761353C7086A272C24088BE94769FD1'
+          '6650'),
+        H('01FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF'
+          'FFFA51868783BF2F966B7FCC0148F709A5D03BB5C9B8899C47AEBB6FB71E9138'
+          '6409'),
+    ),
+}
+
+
+def point_add(curve, P, Q):
+    """Add two affine points, None being the point at infinity."""
+    p, a = curve[0], curve[1]
+    if P is None:
+        return Q
+    if Q is None:
+        return P
+    if P[0] == Q[0]:
+        if (P[1] + Q[1]) % p == 0:
+            return None
+        lam = (3 * P[0] * P[0] + a) * pow(2 * P[1], -1, p) % p
+    else:
+        lam = (Q[1] - P[1]) * pow(Q[0] - P[0], -1, p) % p
+    x = (lam * lam - P[0] - Q[0]) % p
+    return (x, (lam * (P[0] - x) - P[1]) % p)
+
+
+def point_double_n(curve, P, n):
+    for _ in range(n):
+        P = point_add(curve, P, P)
+    return P
+
+
+def comb_table(curve):
+    """Return the window size and the list of table points for G."""
+    nbits = curve[5].bit_length()
+    w = (5 if nbits >= 384 else 4) + 1
+    d = (nbits + w - 1) // w
+    G = (curve[3], curve[4])
+
+    # powers[k] = 2^(k d) G
+    powers = [G]
+    for _ in range(1, w):
+        powers.append(point_double_n(curve, powers[-1], d))
+
+    table = []
+    for i in range(1 << (w - 1)):
+        T = G
+        for k in range(1, w):
+            if (i >> (k - 1)) & 1:
+                T = point_add(curve, T, powers[k])
+        table.append(T)
+    return w, table
+
+
+def mpi_lines(value, nbytes):
+    """Format an integer as MBEDTLS_BYTES_TO_T_UINT_x lines, little-endian."""
+    data = value.to_bytes(nbytes, 'little')
+    lines = []
+    for i in range(0, len(data), 8):
+        chunk = data[i:i + 8]
+        lines.append('    MBEDTLS_BYTES_TO_T_UINT_%d(%s),' %
+                     (len(chunk), ', '.join('0x%02X' % b for b in chunk)))
+    return lines
+
+
+def gen_curve(name):
+    curve = CURVES[name]
+    # Same number of bytes as the other constants of the curve
+    nbytes = (curve[0].bit_length() + 7) // 8
+    if nbytes % 8 not in (0, 2):
+        nbytes += 8 - nbytes % 8
+    w, table = comb_table(curve)
+
+    out = ['#if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1',
+           '/* Static comb table for G, w = %d */' % w]
+    for i, (x, y) in enumerate(table):
+        for coord, value in (('X', x), ('Y', y)):
+            out.append('static const mbedtls_mpi_uint %s_T_%d_%s[] = {' %
+                       (name, i, coord))
+            out += mpi_lines(value, nbytes)
+            out.append('};')
+    out.append('static const mbedtls_ecp_point %s_T[%d] = {' %
+               (name, len(table)))
+    for i in range(len(table)):
+        out.append('    ECP_POINT_INIT_XY_Z%d(%s_T_%d_X, %s_T_%d_Y),' %
+                   (1 if i == 0 else 0, name, i, name, i))
+    out.append('};')
+    out.append('#else')
+    out.append('#define %s_T NULL' % name)
+    out.append('#endif')
+    return '\n'.join(out) + '\n'
+
+
+def update_file(path):
+    with open(path) as f:
+        content = f.read()
+    for name in CURVES:
+        begin = '/* BEGIN ecp_comb_table.py %s */\n' % name
+        end = '/* END ecp_comb_table.py %s */\n' % name
+        pattern = re.compile(re.escape(begin) + '.*?' + re.escape(end),
+                             re.DOTALL)
+        if not pattern.search(content):
+            sys.exit('%s: no block for %s' % (path, name))
+        content = pattern.sub(lambda m, n=name: begin + gen_curve(n) + end,
+                              content)
+    with open(path, 'w') as f:
+        f.write(content)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--update', action='store_true',
+                        help='rewrite the tables in library/ecp_curves.c')
+    args = parser.parse_args()
+
+    if args.update:
+        root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        update_file(os.path.join(root, 'library', 'ecp_curves.c'))
+    else:
+        for name in CURVES:
+            sys.stdout.write(gen_curve(name))
+
+
+if __name__ == '__main__':
+    main()
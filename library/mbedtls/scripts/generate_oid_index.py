@@ -0,0 +1,283 @@
+#!/usr/bin/env python3
+
+"""Generate library/oid_index.h, the perfect hash indexes of the OID tables
+of library/oid.c.
+
+For each table that oid.c searches with FN_OID_TYPED_FROM_ASN1(), this script
+finds a hash of the length and the last two bytes of an OID that maps every
+OID of the table to a different slot, in the smallest power-of-two number of
+slots it can. The slots hold the position of the OID in the table. Since
+entries of the tables are conditionally compiled, positions are enum
+constants that count the entries enabled before each one.
+
+An argument passed to this script will modify the output file:
+* by default (no arguments passed): writes to library/oid_index.h
+* OUTPUT_FILE passed: writes to OUTPUT_FILE
+"""
+
+# Copyright The Mbed TLS Contributors
+# SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+
+import os
+import re
+import sys
+
+OID_C = 'library/oid.c'
+OID_H = 'include/mbedtls/oid.h'
+OUTPUT_FILE = 'library/oid_index.h'
+
+# The outermost condition of oid.c, in which oid_index.h is included
+FILE_CONDITION = 'defined(MBEDTLS_OID_C)'
+
+# Multipliers tried for the length and the last two bytes of an OID
+MULTIPLIERS = range(64)
+
+HEADER = '''\
+/**
+ * \\file oid_index.h
+ *
+ * \\brief Perfect hash indexes of the OID tables of oid.c
+ *
+ * Automatically generated by scripts/generate_oid_index.py from
+ * library/oid.c and include/mbedtls/oid.h. DO NOT EDIT.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0 OR GPL-2.0-or-later
+ */
+#ifndef MBEDTLS_OID_INDEX_H
+#define MBEDTLS_OID_INDEX_H
+'''
+
+FOOTER = '''
+#endif /* MBEDTLS_OID_INDEX_H */
+'''
+
+
+def c_string_bytes(literal):
+    """Decode the body of a C string literal made of escapes and ASCII."""
+    out = bytearray()
+    i = 0
+    while i < len(literal):
+        if literal[i] != '\\':
+            out.append(ord(literal[i]))
+            i += 1
+        elif literal[i + 1] == 'x':
+            m = re.match(r'[0-9a-fA-F]+', literal[i + 2:])
+            out.append(int(m.group(0), 16))
+            i += 2 + len(m.group(0))
+        else:
+            m = re.match(r'[0-7]{1,3}', literal[i + 1:])
+            out.append(int(m.group(0), 8))
+            i += 1 + len(m.group(0))
+    return bytes(out)
+
+
+def read_oid_values(path):
+    """Return a dictionary of the values of the MBEDTLS_OID_xxx string
+    macros of oid.h."""
+    with open(path) as f:
+        text = f.read()
+    text = re.sub(r'\\\n', ' ', text)
+    text = re.sub(r'/\*.*?\*/', ' ', text, flags=re.S)
+    definitions = {}
+    for m in re.finditer(r'^\s*#define\s+(MBEDTLS_OID_\w+)\s+(.*)$',
+                         text, re.M):
+        definitions[m.group(1)] = m.group(2).strip()
+
+    values = {}
+
+    def value(name):
+        if name not in values:
+            body = definitions[name]
+            tokens = re.findall(r'"(?:[^"\\]|\\.)*"|\w+|\S', body)
+            result = b''
+            for token in tokens:
+                if token.startswith('"'):
+                    result += c_string_bytes(token[1:-1])
+                elif token in definitions:
+                    result += value(token)
+                else:
+                    raise ValueError('{}: cannot evaluate {}'
+                                     .format(name, body))
+            values[name] = result
+        return values[name]
+
+    return value
+
+
+class Table:
+    """An OID table of oid.c."""
+
+    def __init__(self, name, condition):
+        self.name = name
+        self.condition = condition
+        # (OID macro, condition) in table order
+        self.entries = []
+        self.mask = 0
+        self.multipliers = (0, 0, 0)
+
+
+def read_tables(path):
+    """Return the tables of oid.c that are searched by OID, in order."""
+    with open(path) as f:
+        lines = f.read().split('\n')
+    stack = []
+    tables = {}
+    order = []
+    current = None
+    searched = set()
+    for line in lines:
+        m = re.match(r'\s*#\s*if\s+(.*?)\s*$', line)
+        if m:
+            stack.append(m.group(1))
+            continue
+        if re.match(r'\s*#\s*(else|elif)\b', line):
+            raise ValueError('#else and #elif are not supported: ' + line)
+        if re.match(r'\s*#\s*endif\b', line):
+            stack.pop()
+            continue
+        m = re.match(r'static const \w+ (oid_\w+)\[\] =', line)
+        if m:
+            current = Table(m.group(1), stack[1:])
+            tables[current.name] = current
+            order.append(current.name)
+            continue
+        if current is not None:
+            m = re.search(r'ADD_LEN\((MBEDTLS_OID_\w+)\)', line)
+            if m:
+                condition = stack[1 + len(current.condition):]
+                current.entries.append((m.group(1), condition))
+            elif line.startswith('};'):
+                current = None
+            continue
+        m = re.match(r'FN_OID_TYPED_FROM_ASN1\(\w+, \w+, (oid_\w+)\)', line)
+        if m:
+            searched.add(m.group(1))
+    if stack and stack != [FILE_CONDITION]:
+        raise ValueError('Unbalanced conditionals in ' + path)
+    return [tables[name] for name in order if name in searched]
+
+
+def slot_of(oid, mask, multipliers):
+    c, a, b = multipliers
+    return (len(oid) * c + oid[-1] * a + oid[-2] * b) & mask
+
+
+def find_hash(table, oids):
+    """Find the smallest perfect hash of the OIDs of the table."""
+    if len(set(oids)) != len(oids):
+        raise ValueError('{}: duplicate OID'.format(table.name))
+    if min(len(oid) for oid in oids) < 2:
+        raise ValueError('{}: OID shorter than 2 bytes'.format(table.name))
+    size = 1
+    while size < len(oids):
+        size *= 2
+    while size <= 256:
+        for c in MULTIPLIERS:
+            for a in MULTIPLIERS:
+                for b in MULTIPLIERS:
+                    slots = set(slot_of(oid, size - 1, (c, a, b))
+                                for oid in oids)
+                    if len(slots) == len(oids):
+                        table.mask = size - 1
+                        table.multipliers = (c, a, b)
+                        return
+        size *= 2
+    raise ValueError('{}: no perfect hash found'.format(table.name))
+
+
+def conjunction(conditions):
+    return ' && '.join(conditions)
+
+
+def write_table(out, table, oids):
+    prefix = table.name.upper()
+    slots = [None] * (table.mask + 1)
+    for i, oid in enumerate(oids):
+        slots[slot_of(oid, table.mask, table.multipliers)] = i
+
+    out.append('')
+    out.append('/*')
+    out.append(' * {}'.format(table.name))
+    out.append(' */')
+    if table.condition:
+        out.append('#if {}'.format(conjunction(table.condition)))
+
+    # {prefix}_i is the position of entry i if it is enabled, and
+    # {prefix}_COUNT the number of entries enabled
+    out.append('enum {')
+    out.append('    {}_0 = 0,'.format(prefix))
+    for i, (_, condition) in enumerate(table.entries):
+        if i + 1 < len(table.entries):
+            nxt = '    {}_{} = {}_{}'.format(prefix, i + 1, prefix, i)
+            end = ','
+        else:
+            nxt = '    {}_COUNT = {}_{}'.format(prefix, prefix, i)
+            end = ''
+        if condition:
+            out.append('#if {}'.format(conjunction(condition)))
+            out.append(nxt + ' + 1' + end)
+            out.append('#else')
+            out.append(nxt + end)
+            out.append('#endif')
+        else:
+            out.append(nxt + ' + 1' + end)
+    out.append('};')
+    out.append('')
+
+    out.append('static const unsigned char {}_slot[{}] ='
+               .format(table.name, table.mask + 1))
+    out.append('{')
+    for i in slots:
+        if i is None:
+            out.append('    OID_INDEX_NONE,')
+            continue
+        macro, condition = table.entries[i]
+        entry = '    {}_{},'.format(prefix, i)
+        entry += ' ' * max(1, 40 - len(entry)) + '/* {} */'.format(macro)
+        if condition:
+            out.append('#if {}'.format(conjunction(condition)))
+            out.append(entry)
+            out.append('#else')
+            out.append('    OID_INDEX_NONE,')
+            out.append('#endif')
+        else:
+            out.append(entry)
+    out.append('};')
+    out.append('')
+
+    out.append('static const oid_index_t {}_index ='.format(table.name))
+    out.append('{')
+    out.append('    {{ {}, {}, {} }}, {}, {}_slot'
+               .format(*table.multipliers, table.mask, table.name))
+    out.append('};')
+    if table.condition:
+        out.append('#endif /* {} */'.format(conjunction(table.condition)))
+
+
+def generate(output_file):
+    value = read_oid_values(OID_H)
+    out = [HEADER.rstrip('\n')]
+    for table in read_tables(OID_C):
+        oids = [value(macro) for macro, _ in table.entries]
+        find_hash(table, oids)
+        write_table(out, table, oids)
+    out.append(FOOTER.rstrip('\n'))
+    content = '\n'.join(out) + '\n'
+    with open(output_file, 'w') as f:
+        f.write(content)
+
+
+def main():
+    if len(sys.argv) > 1:
+        output_file = os.path.abspath(sys.argv[1])
+    else:
+        output_file = OUTPUT_FILE
+    if not os.path.isdir('library') and os.path.isdir('../library'):
+        os.chdir('..')
+    generate(output_file)
+
+
+if __name__ == '__main__':
+    main()
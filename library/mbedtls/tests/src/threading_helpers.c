@@ -84,6 +84,12 @@ static mutex_functions_t mutex_functions;
  */
 static int live_mutexes;
 
+/** Protects live_mutexes and the state transitions below, so that mutexes
+ * shared by several threads of a test are checked correctly. It is used
+ * through the original functions and is not itself checked.
+ */
+static mbedtls_threading_mutex_t mutex_usage_mutex;
+
 static void mbedtls_test_mutex_usage_error(mbedtls_threading_mutex_t *mutex,
                                            const char *msg)
 {
@@ -101,13 +107,16 @@ static void mbedtls_test_mutex_usage_error(mbedtls_threading_mutex_t *mutex,
 static void mbedtls_test_wrap_mutex_init(mbedtls_threading_mutex_t *mutex)
 {
     mutex_functions.init(mutex);
+    mutex_functions.lock(&mutex_usage_mutex);
     if (mutex->is_valid) {
         ++live_mutexes;
     }
+    mutex_functions.unlock(&mutex_usage_mutex);
 }
 
 static void mbedtls_test_wrap_mutex_free(mbedtls_threading_mutex_t *mutex)
 {
+    mutex_functions.lock(&mutex_usage_mutex);
     switch (mutex->is_valid) {
         case MUTEX_FREED:
             mbedtls_test_mutex_usage_error(mutex, "free without init or double free");
@@ -126,12 +135,14 @@ static void mbedtls_test_wrap_mutex_free(mbedtls_threading_mutex_t *mutex)
     if (mutex->is_valid) {
         --live_mutexes;
     }
+    mutex_functions.unlock(&mutex_usage_mutex);
     mutex_functions.free(mutex);
 }
 
 static int mbedtls_test_wrap_mutex_lock(mbedtls_threading_mutex_t *mutex)
 {
     int ret = mutex_functions.lock(mutex);
+    mutex_functions.lock(&mutex_usage_mutex);
     switch (mutex->is_valid) {
         case MUTEX_FREED:
             mbedtls_test_mutex_usage_error(mutex, "lock without init");
@@ -148,12 +159,18 @@ static int mbedtls_test_wrap_mutex_lock(mbedtls_threading_mutex_t *mutex)
             mbedtls_test_mutex_usage_error(mutex, "corrupted state");
             break;
     }
+    mutex_functions.unlock(&mutex_usage_mutex);
     return ret;
 }
 
 static int mbedtls_test_wrap_mutex_unlock(mbedtls_threading_mutex_t *mutex)
 {
-    int ret = mutex_functions.unlock(mutex);
+    int ret;
+    int locked = 0;
+
+    /* Update the state before releasing the mutex: once it is released,
+     * another thread may lock it and set the state itself. */
+    mutex_functions.lock(&mutex_usage_mutex);
     switch (mutex->is_valid) {
         case MUTEX_FREED:
             mbedtls_test_mutex_usage_error(mutex, "unlock without init");
@@ -162,14 +179,21 @@ static int mbedtls_test_wrap_mutex_unlock(mbedtls_threading_mutex_t *mutex)
             mbedtls_test_mutex_usage_error(mutex, "unlock without lock");
             break;
         case MUTEX_LOCKED:
-            if (ret == 0) {
-                mutex->is_valid = MUTEX_IDLE;
-            }
+            mutex->is_valid = MUTEX_IDLE;
+            locked = 1;
             break;
         default:
             mbedtls_test_mutex_usage_error(mutex, "corrupted state");
             break;
     }
+    mutex_functions.unlock(&mutex_usage_mutex);
+
+    ret = mutex_functions.unlock(mutex);
+    if (ret != 0 && locked) {
+        mutex_functions.lock(&mutex_usage_mutex);
+        mutex->is_valid = MUTEX_LOCKED;
+        mutex_functions.unlock(&mutex_usage_mutex);
+    }
     return ret;
 }
 
@@ -179,6 +203,7 @@ void mbedtls_test_mutex_usage_init(void)
     mutex_functions.free = mbedtls_mutex_free;
     mutex_functions.lock = mbedtls_mutex_lock;
     mutex_functions.unlock = mbedtls_mutex_unlock;
+    mutex_functions.init(&mutex_usage_mutex);
     mbedtls_mutex_init = &mbedtls_test_wrap_mutex_init;
     mbedtls_mutex_free = &mbedtls_test_wrap_mutex_free;
     mbedtls_mutex_lock = &mbedtls_test_wrap_mutex_lock;
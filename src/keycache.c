@@ -0,0 +1,379 @@
+/**************************************************************************
+*  Copyright (c) 2021-2024 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without 
+*  modification, are permitted provided that the following conditions 
+*  are met:
+*  
+*  1. Redistributions of source code must retain the above copyright 
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the 
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may 
+*     be used to endorse or promote products derived from this software 
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL 
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS 
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF 
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+*  SUCH DAMAGE.
+*
+**************************************************************************/
+#define __KEYCACHE_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <windows.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <io.h>
+#include <share.h>
+#include "stdint.h"
+#include "keycache.h"
+
+#include "mbedtls/platform.h"
+#include "mbedtls/ecp.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/platform_util.h"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define GOTO_END(_a)    { rc = _a; goto end; }
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static int nEnabled = 0;
+
+/*=======================================================================*/
+/*  Definition of prototypes                                             */
+/*=======================================================================*/
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  CreateOwnerOnlyFile                                                  */
+/*                                                                       */
+/*  Create a new file that only the current user can access. The DACL    */
+/*  holds one entry for the user of the process token, and is protected  */
+/*  against the inheritable entries of the folder.                       */
+/*                                                                       */
+/*  In    : pFilename                                                    */
+/*  Out   : none                                                         */
+/*  Return: file handle / INVALID_HANDLE_VALUE                           */
+/*************************************************************************/
+static HANDLE CreateOwnerOnlyFile (const char *pFilename)
+{
+   HANDLE               hFile  = INVALID_HANDLE_VALUE;
+   HANDLE               hToken = NULL;
+   DWORD                dSize  = 0;
+   DWORD                dAclSize;
+   TOKEN_USER         *pUser  = NULL;
+   ACL                *pAcl   = NULL;
+   SECURITY_DESCRIPTOR  SD;
+   SECURITY_ATTRIBUTES  SA;
+   
+   if (0 == OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &hToken)) goto end;
+   
+   /* The first call returns the size of the user information */
+   GetTokenInformation(hToken, TokenUser, NULL, 0, &dSize);
+   if (0 == dSize) goto end;
+   
+   pUser = (TOKEN_USER*)LocalAlloc(LPTR, dSize);
+   if (NULL == pUser) goto end;
+   if (0 == GetTokenInformation(hToken, TokenUser, pUser, dSize, &dSize)) goto end;
+   
+   dAclSize = sizeof(ACL) + sizeof(ACCESS_ALLOWED_ACE) - sizeof(DWORD) + GetLengthSid(pUser->User.Sid);
+   pAcl = (ACL*)LocalAlloc(LPTR, dAclSize);
+   if (NULL == pAcl) goto end;
+   
+   if (0 == InitializeAcl(pAcl, dAclSize, ACL_REVISION)) goto end;
+   if (0 == AddAccessAllowedAce(pAcl, ACL_REVISION, FILE_ALL_ACCESS, pUser->User.Sid)) goto end;
+   
+   if (0 == InitializeSecurityDescriptor(&SD, SECURITY_DESCRIPTOR_REVISION)) goto end;
+   if (0 == SetSecurityDescriptorDacl(&SD, TRUE, pAcl, FALSE)) goto end;
+   if (0 == SetSecurityDescriptorControl(&SD, SE_DACL_PROTECTED, SE_DACL_PROTECTED)) goto end;
+   
+   SA.nLength              = sizeof(SA);
+   SA.lpSecurityDescriptor = &SD;
+   SA.bInheritHandle       = FALSE;
+   
+   /* The security attributes are only used for a new file */
+   hFile = CreateFile(pFilename, GENERIC_WRITE, 0, &SA, CREATE_NEW, 
+                      FILE_ATTRIBUTE_NORMAL, NULL);
+
+end:
+
+   if (pAcl  != NULL) LocalFree(pAcl);
+   if (pUser != NULL) LocalFree(pUser);
+   if (hToken != NULL) CloseHandle(hToken);
+   
+   return(hFile);
+} /* CreateOwnerOnlyFile */
+
+/*************************************************************************/
+/*  ReadCache                                                            */
+/*                                                                       */
+/*  Load the key from the cache file, if the cache is undamaged and was  */
+/*  created from the current key file, identified by the SHA-256 of its  */
+/*  contents. The key is checked as the PEM parser checks it: d must be  */
+/*  in range and Q must be on the curve.                                 */
+/*                                                                       */
+/*  In    : pPK, pCacheFilename, pSrcHash                                */
+/*  Out   : pPK                                                          */
+/*  Return: 0 = OK / error cause                                         */
+/*************************************************************************/
+static int ReadCache (mbedtls_pk_context *pPK, const char *pCacheFilename, 
+                      const uint8_t *pSrcHash)
+{
+   int                   rc;
+   int                   hFile;
+   int                   nReadCnt;
+   KEY_CACHE             Cache;
+   uint8_t               Hash[KEYCACHE_HASH_SIZE];
+   mbedtls_ecp_keypair *pKey;
+   
+   /* Unbuffered, the file is read with one call */
+   if (_sopen_s(&hFile, pCacheFilename, _O_RDONLY | _O_BINARY, _SH_DENYWR, 0) != 0)
+   {
+      /* No cache available */
+      return(-1);
+   }
+   
+   nReadCnt = _read(hFile, &Cache, sizeof(KEY_CACHE));
+   _close(hFile);
+   if (nReadCnt != sizeof(KEY_CACHE)) GOTO_END(-2);
+   
+   /* Check if the cache belongs to the current key file */
+   if ((Cache.dMagic   != KEYCACHE_MAGIC)             ||
+       (Cache.wVersion != KEYCACHE_VERSION)           ||
+       (Cache.wGroup   != MBEDTLS_ECP_DP_SECP256R1)   ||
+       (memcmp(Cache.bSrcHash, pSrcHash, KEYCACHE_HASH_SIZE) != 0))
+   {
+      GOTO_END(-3);
+   }
+   
+   /* Detect a damaged file, this does not protect against a modified one */
+   rc = mbedtls_sha256_ret((uint8_t*)&Cache, offsetof(KEY_CACHE, bHash), Hash, 0);
+   if (rc != 0) GOTO_END(-4);
+   if (memcmp(Hash, Cache.bHash, KEYCACHE_HASH_SIZE) != 0) GOTO_END(-5);
+   
+   /* Set up the key */
+   rc = mbedtls_pk_setup(pPK, mbedtls_pk_info_from_type(MBEDTLS_PK_ECKEY));
+   if (rc != 0) GOTO_END(-6);
+   
+   pKey = mbedtls_pk_ec(*pPK);
+   
+   rc = mbedtls_ecp_group_load(&pKey->grp, MBEDTLS_ECP_DP_SECP256R1);
+   if (rc != 0) GOTO_END(-7);
+   
+   rc = mbedtls_mpi_read_binary(&pKey->d, Cache.bPriv, KEYCACHE_PRIV_SIZE);
+   if (rc != 0) GOTO_END(-8);
+   
+   rc = mbedtls_ecp_point_read_binary(&pKey->grp, &pKey->Q, Cache.bPub, KEYCACHE_PUB_SIZE);
+   if (rc != 0) GOTO_END(-9);
+   
+   rc = mbedtls_ecp_check_privkey(&pKey->grp, &pKey->d);
+   if (rc != 0) GOTO_END(-10);
+   
+   rc = mbedtls_ecp_check_pubkey(&pKey->grp, &pKey->Q);
+   if (rc != 0) GOTO_END(-11);
+   
+   rc = 0;
+
+end:
+
+   if (rc != 0)
+   {
+      /* Back to an empty context for the PEM parser */
+      mbedtls_pk_free(pPK);
+      mbedtls_pk_init(pPK);
+   }
+   mbedtls_platform_zeroize(&Cache, sizeof(Cache));
+
+   return(rc);
+} /* ReadCache */
+
+/*************************************************************************/
+/*  WriteCache                                                           */
+/*                                                                       */
+/*  Write the cache file for a P-256 key, other keys are not cached.     */
+/*  The file is only accessible by the current user, whatever the ACL    */
+/*  of the folder is. It is replaced in one step so that a reader never  */
+/*  sees a partial file. A file moved on the same volume keeps its ACL.  */
+/*                                                                       */
+/*  The cache is a second unencrypted copy of the private key, next to   */
+/*  the key file. It must be protected like the key file, and deleted    */
+/*  together with it.                                                    */
+/*                                                                       */
+/*  In    : pPK, pCacheFilename, pSrcHash                                */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / error cause                                         */
+/*************************************************************************/
+static int WriteCache (mbedtls_pk_context *pPK, const char *pCacheFilename, 
+                       const uint8_t *pSrcHash)
+{
+   int                   rc;
+   HANDLE                hFile;
+   DWORD                 dWriteCnt;
+   BOOL                  bWriteOk;
+   size_t                Len;
+   KEY_CACHE             Cache;
+   char                  TmpFilename[_MAX_PATH];
+   mbedtls_ecp_keypair *pKey;
+   
+   memset(&Cache, 0x00, sizeof(Cache));
+   memset(TmpFilename, 0x00, sizeof(TmpFilename));
+   
+   if (mbedtls_pk_get_type(pPK) != MBEDTLS_PK_ECKEY) GOTO_END(-1);
+   
+   pKey = mbedtls_pk_ec(*pPK);
+   if (pKey->grp.id != MBEDTLS_ECP_DP_SECP256R1) GOTO_END(-1);
+   
+   Cache.dMagic   = KEYCACHE_MAGIC;
+   Cache.wVersion = KEYCACHE_VERSION;
+   Cache.wGroup   = MBEDTLS_ECP_DP_SECP256R1;
+   memcpy(Cache.bSrcHash, pSrcHash, KEYCACHE_HASH_SIZE);
+   
+   rc = mbedtls_mpi_write_binary(&pKey->d, Cache.bPriv, KEYCACHE_PRIV_SIZE);
+   if (rc != 0) GOTO_END(-2);
+   
+   rc = mbedtls_ecp_point_write_binary(&pKey->grp, &pKey->Q, MBEDTLS_ECP_PF_UNCOMPRESSED,
+                                       &Len, Cache.bPub, KEYCACHE_PUB_SIZE);
+   if ((rc != 0) || (Len != KEYCACHE_PUB_SIZE)) GOTO_END(-3);
+   
+   rc = mbedtls_sha256_ret((uint8_t*)&Cache, offsetof(KEY_CACHE, bHash), Cache.bHash, 0);
+   if (rc != 0) GOTO_END(-4);
+   
+   /* Write a temporary file first */
+   _snprintf(TmpFilename, sizeof(TmpFilename)-1, "%s.tmp", pCacheFilename);
+   
+   /* A left over file would keep its ACL, it is removed first */
+   DeleteFile(TmpFilename);
+   hFile = CreateOwnerOnlyFile(TmpFilename);
+   if (INVALID_HANDLE_VALUE == hFile) GOTO_END(-5);
+   
+   bWriteOk = WriteFile(hFile, &Cache, sizeof(KEY_CACHE), &dWriteCnt, NULL);
+   CloseHandle(hFile);
+   if ((0 == bWriteOk) || (dWriteCnt != sizeof(KEY_CACHE)))
+   {
+      DeleteFile(TmpFilename);
+      GOTO_END(-6);
+   }
+   
+   /* Replace the old cache */
+   if (0 == MoveFileEx(TmpFilename, pCacheFilename, MOVEFILE_REPLACE_EXISTING))
+   {
+      DeleteFile(TmpFilename);
+      GOTO_END(-7);
+   }
+   
+   rc = 0;
+
+end:
+
+   mbedtls_platform_zeroize(&Cache, sizeof(Cache));
+
+   return(rc);
+} /* WriteCache */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  keycache_Enable                                                      */
+/*                                                                       */
+/*  Use the key cache for the following calls of keycache_Load. The      */
+/*  cache is an unencrypted copy of the private key, it is only written  */
+/*  if the user asks for it.                                             */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void keycache_Enable (void)
+{
+   nEnabled = 1;
+} /* keycache_Enable */
+
+/*************************************************************************/
+/*  keycache_Load                                                        */
+/*                                                                       */
+/*  Load the private key. Without keycache_Enable the key file is only   */
+/*  parsed. Otherwise the key file is read once and hashed. The key is   */
+/*  taken from the binary cache next to the key file if the cache was    */
+/*  made from the same contents. Otherwise the PEM data is parsed and    */
+/*  the cache is created again for the next call.                        */
+/*                                                                       */
+/*  In    : pPK, pKeyFilename                                            */
+/*  Out   : pPK                                                          */
+/*  Return: 0 = OK / mbedtls error code of the PEM parser                */
+/*************************************************************************/
+int keycache_Load (mbedtls_pk_context *pPK, const char *pKeyFilename)
+{
+   int       rc;
+   int       HashRc;
+   size_t    Len;
+   uint8_t *pKeyData;
+   uint8_t   SrcHash[KEYCACHE_HASH_SIZE];
+   char      CacheFilename[_MAX_PATH];
+   
+   /* Cache not enabled, or a path too long for the cache */
+   if ((0 == nEnabled) ||
+       ((strlen(pKeyFilename) + sizeof(KEYCACHE_EXT ".tmp")) > sizeof(CacheFilename)))
+   {
+      return(mbedtls_pk_parse_keyfile(pPK, pKeyFilename, NULL));
+   }
+   
+   /* Without the key file the cache is not valid */
+   rc = mbedtls_pk_load_file(pKeyFilename, &pKeyData, &Len);
+   if (rc != 0)
+   {
+      return(rc);
+   }
+   
+   memset(CacheFilename, 0x00, sizeof(CacheFilename));
+   _snprintf(CacheFilename, sizeof(CacheFilename)-1, "%s%s", pKeyFilename, KEYCACHE_EXT);
+   
+   HashRc = mbedtls_sha256_ret(pKeyData, Len, SrcHash, 0);
+   if ((0 == HashRc) && (0 == ReadCache(pPK, CacheFilename, SrcHash)))
+   {
+      rc = 0;
+   }
+   else
+   {
+      rc = mbedtls_pk_parse_key(pPK, pKeyData, Len, NULL, 0);
+      if ((0 == rc) && (0 == HashRc))
+      {
+         /* The cache is optional, errors are ignored here */
+         WriteCache(pPK, CacheFilename, SrcHash);
+      }
+   }
+   
+   mbedtls_platform_zeroize(pKeyData, Len);
+   mbedtls_free(pKeyData);
+   
+   return(rc);
+} /* keycache_Load */
+
+/*** EOF ***/
@@ -0,0 +1,197 @@
+/**************************************************************************
+*  Copyright (c) 2021-2024 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without 
+*  modification, are permitted provided that the following conditions 
+*  are met:
+*  
+*  1. Redistributions of source code must retain the above copyright 
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the 
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may 
+*     be used to endorse or promote products derived from this software 
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL 
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS 
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF 
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+*  SUCH DAMAGE.
+*
+**************************************************************************/
+#define __PROF_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <windows.h>
+#include <stdio.h>
+#include "prof.h"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+typedef struct _phase_
+{
+   char    Name[PROF_NAME_LEN];
+   double dTimeMs;
+} PHASE;
+
+static int           nEnabled = 0;
+
+static LARGE_INTEGER Frequency;
+static LARGE_INTEGER LastMark;
+
+static int           nPhaseCount;
+static PHASE          PhaseList[PROF_MAX_PHASES];
+
+/*=======================================================================*/
+/*  Definition of prototypes                                             */
+/*=======================================================================*/
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  AddPhase                                                             */
+/*                                                                       */
+/*  In    : pName, dTimeMs                                               */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void AddPhase (const char *pName, double dTimeMs)
+{
+   if (nPhaseCount < PROF_MAX_PHASES)
+   {
+      _snprintf(PhaseList[nPhaseCount].Name, PROF_NAME_LEN-1, "%s", pName);
+      PhaseList[nPhaseCount].dTimeMs = dTimeMs;
+      nPhaseCount++;
+   }
+   
+} /* AddPhase */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  prof_Enable                                                          */
+/*                                                                       */
+/*  Start the phase timing. The time from the process creation up to     */
+/*  here is taken as the first phase.                                    */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void prof_Enable (void)
+{
+   FILETIME       ftCreation;
+   FILETIME       ftExit;
+   FILETIME       ftKernel;
+   FILETIME       ftUser;
+   FILETIME       ftNow;
+   ULARGE_INTEGER Start;
+   ULARGE_INTEGER Now;
+
+   memset(PhaseList, 0x00, sizeof(PhaseList));
+   nPhaseCount = 0;
+
+   QueryPerformanceFrequency(&Frequency);
+   QueryPerformanceCounter(&LastMark);
+   nEnabled = 1;
+
+   /* Process start, FILETIME is in units of 100ns */
+   if (GetProcessTimes(GetCurrentProcess(), &ftCreation, &ftExit, &ftKernel, &ftUser))
+   {
+      GetSystemTimeAsFileTime(&ftNow);
+      
+      Start.LowPart  = ftCreation.dwLowDateTime;
+      Start.HighPart = ftCreation.dwHighDateTime;
+      Now.LowPart    = ftNow.dwLowDateTime;
+      Now.HighPart   = ftNow.dwHighDateTime;
+      
+      if (Now.QuadPart > Start.QuadPart)
+      {
+         AddPhase("Process start", (double)(Now.QuadPart - Start.QuadPart) / 10000.0);
+      }
+   }
+   
+} /* prof_Enable */
+
+/*************************************************************************/
+/*  prof_Mark                                                            */
+/*                                                                       */
+/*  End the current phase and give it a name. Does nothing if the        */
+/*  phase timing was not enabled.                                        */
+/*                                                                       */
+/*  In    : pName                                                        */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void prof_Mark (const char *pName)
+{
+   LARGE_INTEGER Now;
+
+   if (1 == nEnabled)
+   {
+      QueryPerformanceCounter(&Now);
+      AddPhase(pName, (double)(Now.QuadPart - LastMark.QuadPart) * 1000.0 / (double)Frequency.QuadPart);
+      
+      /* The time to store the phase is not counted */
+      QueryPerformanceCounter(&LastMark);
+   }
+   
+} /* prof_Mark */
+
+/*************************************************************************/
+/*  prof_Output                                                          */
+/*                                                                       */
+/*  Output the startup breakdown, if the phase timing was enabled.       */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void prof_Output (void)
+{
+   int     nIndex;
+   double dTotal = 0.0;
+
+   if (1 == nEnabled)
+   {
+      printf("\n");
+      printf("Phase timing\n");
+      printf("=======================================\n");
+      
+      for (nIndex = 0; nIndex < nPhaseCount; nIndex++)
+      {
+         printf("%-*s %10.3f ms\n", PROF_NAME_LEN, PhaseList[nIndex].Name, PhaseList[nIndex].dTimeMs);
+         dTotal += PhaseList[nIndex].dTimeMs;
+      }
+      
+      printf("---------------------------------------\n");
+      printf("%-*s %10.3f ms\n", PROF_NAME_LEN, "Total", dTotal);
+   }
+   
+} /* prof_Output */
+
+/*** EOF ***/
@@ -46,6 +46,7 @@
 #include <stdio.h>
 #include "stdint.h"
 #include "tnp.h"
+#include "prof.h"
 
 /*=======================================================================*/
 /*  All Structures and Common Constants                                  */
@@ -188,6 +189,7 @@ int tnp_Start (void)
       exit(-1);
    }
    nWSAInitDone = 1;
+   prof_Mark("WSAStartup");
 
    /* 
     * Get interface list 
@@ -198,6 +200,7 @@ int tnp_Start (void)
       printf("Error, could not find any ethernet interfaces.\r\n");
       GOTO_END(-1);
    }
+   prof_Mark("GetInterfaceList");
    
    /* 
     * Bind to interface 
@@ -219,6 +222,7 @@ int tnp_Start (void)
       }
    }
 
+   prof_Mark("Socket bind");
    rc = 0;   
 
 end:
@@ -349,6 +353,8 @@ int tnp_ES3Search (void)
       }
    }
    
+   prof_Mark("Discovery");
+   
    if (0 == nServerCount)
    {
       /* Error, no server found */